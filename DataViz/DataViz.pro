@@ -1,6 +1,6 @@
 QT       += core gui
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport # Choosing modules (group of classes) needed for the app
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport concurrent # Choosing modules (group of classes) needed for the app
 
 CONFIG += c++11 # Setting the standard of C++
 
@@ -10,6 +10,7 @@ CONFIG += c++11 # Setting the standard of C++
 
 SOURCES += \
     aboutdialog.cpp \
+    batchexport.cpp \
     dataset.cpp \
     datasetwindow.cpp \
     functiondialog.cpp \
@@ -22,6 +23,7 @@ SOURCES += \
 HEADERS += \
     aboutdialog.h \
     atmsp.h \
+    batchexport.h \
     dataset.h \
     datasetwindow.h \
     functiondialog.h \
@@ -43,23 +45,7 @@ qnx: target.path = /tmp/$${TARGET}/bin
 else: unix:!android: target.path = /opt/$${TARGET}/bin
 !isEmpty(target.path): INSTALLS += target
 
-win32: LIBS += -L$$PWD/GSLlib/ -lgsl
-
-INCLUDEPATH += $$PWD/GSLinclude
-DEPENDPATH += $$PWD/GSLlib
-
-win32:!win32-g++: PRE_TARGETDEPS += $$PWD/GSLlib/gsl.lib
-else:win32-g++: PRE_TARGETDEPS += $$PWD/GSLlib/libgsl.a
-
-
-
-win32: LIBS += -L$$PWD/GSLlib/ -lgslcblas
-
-INCLUDEPATH += $$PWD/GSLinclude
-DEPENDPATH += $$PWD/GSLlib
-
-win32:!win32-g++: PRE_TARGETDEPS += $$PWD/GSLlib/gslcblas.lib
-else:win32-g++: PRE_TARGETDEPS += $$PWD/GSLlib/libgslcblas.a
+include(gsl.pri) # GNU Scientific Library, used by DataSet
 
 RESOURCES += \
     resources.qrc
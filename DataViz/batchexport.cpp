@@ -0,0 +1,245 @@
+#include "batchexport.h"
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QTextStream>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QThread>
+#include <QThreadPool>
+#include <QFuture>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+
+// Method to read the job list from a JSON file (see batchexport.h for the format)
+bool BatchExport::loadJobs(const QString &jobFileName) {
+    QFile file(jobFileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        lastError = "Can't open the job list " + jobFileName;
+        return false;
+    }
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (document.isNull()) {
+        lastError = jobFileName + ": " + parseError.errorString();
+        return false;
+    }
+    const QJsonObject root = document.object();
+    const QJsonArray jobArray = document.isArray() ? document.array() : root.value("jobs").toArray(); // A plain array of jobs is accepted, too
+    threadCount = root.value("threads").toInt(QThread::idealThreadCount());
+
+    QMap<QString, Qt::PenStyle> penStyles;
+    penStyles["solid"] = Qt::SolidLine;
+    penStyles["dash"] = Qt::DashLine;
+    penStyles["dot"] = Qt::DotLine;
+    penStyles["dashdot"] = Qt::DashDotLine;
+    penStyles["dashdotdot"] = Qt::DashDotDotLine;
+    penStyles["scatter"] = Qt::NoPen;
+
+    const QDir baseDir = QFileInfo(jobFileName).absoluteDir();
+    jobs.clear();
+    for (const QJsonValue &jobValue : jobArray) {
+        const QJsonObject object = jobValue.toObject();
+        Job job;
+        if (!object.contains("output")) {
+            lastError = "Job " + QString::number(jobs.size() + 1) + " has no output file";
+            return false;
+        }
+        job.output = baseDir.absoluteFilePath(object.value("output").toString());
+        job.width = object.value("width").toInt(job.width);
+        job.height = object.value("height").toInt(job.height);
+        job.scale = object.value("scale").toDouble(job.scale);
+        job.title = object.value("title").toString();
+        job.xLabel = object.value("xLabel").toString(job.xLabel);
+        job.yLabel = object.value("yLabel").toString(job.yLabel);
+        const QJsonArray xRange = object.value("xRange").toArray();
+        if (xRange.size() == 2) {
+            job.xRange = QCPRange(xRange.at(0).toDouble(), xRange.at(1).toDouble());
+            job.fixedXRange = true;
+        }
+        const QJsonArray yRange = object.value("yRange").toArray();
+        if (yRange.size() == 2) {
+            job.yRange = QCPRange(yRange.at(0).toDouble(), yRange.at(1).toDouble());
+            job.fixedYRange = true;
+        }
+        for (const QJsonValue &seriesValue : object.value("datasets").toArray()) {
+            const QJsonObject seriesObject = seriesValue.toObject();
+            Series series;
+            series.file = baseDir.absoluteFilePath(seriesObject.value("file").toString());
+            series.name = seriesObject.value("name").toString(QFileInfo(series.file).baseName());
+            const QString style = seriesObject.value("style").toString("solid");
+            if (!penStyles.contains(style)) {
+                lastError = "Unknown style \"" + style + "\" in job " + QString::number(jobs.size() + 1);
+                return false;
+            }
+            series.pen = QPen(QColor(seriesObject.value("color").toString("#0000ff")), seriesObject.value("width").toDouble(1));
+            series.scatter = penStyles.value(style) == Qt::NoPen;
+            if (!series.scatter)
+                series.pen.setStyle(penStyles.value(style));
+            job.series.append(series);
+        }
+        jobs.append(job);
+    }
+    return true;
+}
+
+// Method to render all jobs in order. While the GUI thread draws one figure, the worker threads read the datasets of
+// the next figures and encode the images of the previous ones, so the throughput grows with the number of cores
+int BatchExport::run() {
+    QThreadPool pool;
+    pool.setMaxThreadCount(qMax(1, threadCount));
+    const int lookAhead = 2 * pool.maxThreadCount(); // Figures read ahead or waiting to be written, bounds the memory use
+
+    QCustomPlot plot; // Never shown, only draws into images
+    plot.setPlottingHint(QCP::phParallelPreparation); // The graphs of each figure are prepared concurrently, too
+
+    QVector<QFuture<FigureData> > loading(jobs.size());
+    QList<QPair<QFuture<bool>, QString> > saving;
+    int nextToLoad = 0;
+    int failed = 0;
+    for (int i = 0; i < jobs.size(); ++i) {
+        while (nextToLoad < jobs.size() && nextToLoad < i + lookAhead) {
+            loading[nextToLoad] = QtConcurrent::run(&pool, &BatchExport::loadFigureData, jobs.at(nextToLoad));
+            ++nextToLoad;
+        }
+        const Job &job = jobs.at(i);
+        const FigureData data = loading[i].result();
+        loading[i] = QFuture<FigureData>(); // Release the data once the figure is drawn
+        if (data.contains(QSharedPointer<QCPGraphDataContainer>())) {
+            qWarning() << "Skipping" << job.output << "because a dataset couldn't be read";
+            ++failed;
+            continue;
+        }
+
+        setUpFigure(&plot, job, data);
+        if (job.output.endsWith(".pdf", Qt::CaseInsensitive)) {
+            // Vector output is written while drawing
+            if (plot.savePdf(job.output, job.width, job.height))
+                qInfo() << "Wrote" << job.output;
+            else {
+                qWarning() << "Couldn't write" << job.output;
+                ++failed;
+            }
+        } else {
+            saving.append(qMakePair(QtConcurrent::run(&pool, &BatchExport::saveImage, plot.toImage(job.width, job.height, job.scale), job.output), job.output));
+        }
+
+        // Collect the images that are written, waiting for the oldest if too many are pending
+        while (!saving.isEmpty() && (saving.first().first.isFinished() || saving.size() > lookAhead)) {
+            const QPair<QFuture<bool>, QString> pending = saving.takeFirst();
+            if (pending.first.result())
+                qInfo() << "Wrote" << pending.second;
+            else {
+                qWarning() << "Couldn't write" << pending.second;
+                ++failed;
+            }
+        }
+    }
+    for (const auto &pending : saving) {
+        if (pending.first.result())
+            qInfo() << "Wrote" << pending.second;
+        else {
+            qWarning() << "Couldn't write" << pending.second;
+            ++failed;
+        }
+    }
+    return failed;
+}
+
+// Method to run the batch export of "--export". The exit code is 0 if all figures were written, 1 otherwise
+int BatchExport::exec(const QString &jobFileName) {
+    BatchExport batchExport;
+    if (!batchExport.loadJobs(jobFileName)) {
+        qCritical() << batchExport.errorString();
+        return 1;
+    }
+    const int failed = batchExport.run();
+    if (failed > 0)
+        qCritical() << failed << "of" << batchExport.jobs.size() << "figures couldn't be written";
+    return failed > 0 ? 1 : 0;
+}
+
+// Method to read all datasets of a figure. An entry is null if its file couldn't be read
+BatchExport::FigureData BatchExport::loadFigureData(const Job &job) {
+    FigureData data;
+    for (const Series &series : job.series)
+        data.append(loadDataFile(series.file));
+    return data;
+}
+
+// Method to read a dataset file with one "x y" pair per line, like DataSet does. DataSet itself can't be used on
+// worker threads, since it reports invalid files with a message box and numbers its datasets in a shared counter
+QSharedPointer<QCPGraphDataContainer> BatchExport::loadDataFile(const QString &fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Can't open" << fileName;
+        return QSharedPointer<QCPGraphDataContainer>();
+    }
+    QVector<QCPGraphData> points;
+    QTextStream in(&file);
+    int lineNumber = 0;
+    while (!in.atEnd()) {
+        // Each line is parsed on its own, so a line with a missing value is rejected instead of taking its y from
+        // the next line or keeping the previous one
+        const QStringList fields = in.readLine().simplified().split(' ');
+        ++lineNumber;
+        if (fields.first().isEmpty())
+            continue; // Empty line, e.g. at the end of the file
+        bool xValid = false, yValid = false;
+        if (fields.size() == 2)
+            points.append(QCPGraphData(fields.at(0).toDouble(&xValid), fields.at(1).toDouble(&yValid)));
+        if (!xValid || !yValid) {
+            qWarning() << fileName << "doesn't contain one numeric x and y value in line" << lineNumber;
+            return QSharedPointer<QCPGraphDataContainer>();
+        }
+    }
+    QSharedPointer<QCPGraphDataContainer> data(new QCPGraphDataContainer);
+    data->set(points); // Sorts by x if necessary
+    return data;
+}
+
+// Method to write an image in the format given by the file extension
+bool BatchExport::saveImage(const QImage &image, const QString &fileName) {
+    return !image.isNull() && image.save(fileName);
+}
+
+// Method to replace the contents of the hidden plot with the figure of a job. Uses the same figure layout as GraphWindow
+void BatchExport::setUpFigure(QCustomPlot *plot, const Job &job, const FigureData &data) {
+    plot->clearGraphs();
+    if (plot->plotLayout()->rowCount() > 1) { // Remove the title of the previous figure
+        plot->plotLayout()->removeAt(0);
+        plot->plotLayout()->simplify();
+    }
+    if (!job.title.isEmpty()) {
+        plot->plotLayout()->insertRow(0);
+        plot->plotLayout()->addElement(0, 0, new QCPTextElement(plot, job.title, QFont("sans", 12, QFont::Bold)));
+    }
+    plot->legend->setVisible(true);
+    plot->xAxis2->setVisible(true);
+    plot->xAxis2->setTickLabels(false);
+    plot->yAxis2->setVisible(true);
+    plot->yAxis2->setTickLabels(false);
+    plot->xAxis->setLabel(job.xLabel);
+    plot->yAxis->setLabel(job.yLabel);
+
+    for (int i = 0; i < job.series.size(); ++i) {
+        const Series &series = job.series.at(i);
+        QCPGraph *graph = plot->addGraph();
+        graph->setData(data.at(i));
+        graph->setName(series.name);
+        graph->setPen(series.pen);
+        if (series.scatter) {
+            graph->setLineStyle(QCPGraph::lsNone);
+            graph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, series.pen.color(), series.pen.color(), 4));
+            graph->setDensityScatter(true);
+        }
+    }
+    plot->rescaleAxes();
+    if (job.fixedXRange)
+        plot->xAxis->setRange(job.xRange);
+    if (job.fixedYRange)
+        plot->yAxis->setRange(job.yRange);
+    plot->xAxis2->setRange(plot->xAxis->range());
+    plot->yAxis2->setRange(plot->yAxis->range());
+}
@@ -0,0 +1,77 @@
+#ifndef BATCHEXPORT_H
+#define BATCHEXPORT_H
+
+/********************************
+ *
+ *  The BatchExport class renders figures into image or PDF files without showing any window, e.g. for
+ *  nightly reports. It is started with "DataViz --export jobs.json" and reads a job list of the form:
+ *
+ *  { "threads": 8,
+ *    "jobs": [ { "output": "figure1.png",
+ *                "width": 800, "height": 600, "scale": 1,
+ *                "title": "Run 42", "xLabel": "t", "yLabel": "U",
+ *                "xRange": [0, 10], "yRange": [-1, 1],
+ *                "datasets": [ { "file": "run42.txt", "name": "U1", "color": "#1f77b4", "width": 2, "style": "solid" } ] } ] }
+ *
+ *  The output format follows the file extension (png, jpg, bmp or pdf). The ranges are optional, without them the
+ *  axes are fitted to the data. "style" is one of solid, dash, dot, dashdot, dashdotdot or scatter. Relative file
+ *  names are resolved against the directory of the job file. "threads" defaults to the number of cores.
+ *
+ *  Reading the datasets and encoding the images runs on worker threads, ahead of and behind the drawing. The figures
+ *  themselves are drawn into QImages by one hidden QCustomPlot, since widgets can only be used in the GUI thread.
+ *
+ **********************************/
+
+#include <QString>
+#include <QList>
+#include <QPen>
+#include <QImage>
+#include <QSharedPointer>
+#include "qcustomplot.h"
+
+class BatchExport
+{
+public:
+    // A dataset of a figure and how it is drawn
+    struct Series {
+        QString file;
+        QString name;
+        QPen pen;
+        bool scatter = false;
+    };
+
+    // A figure that is rendered into the file "output"
+    struct Job {
+        QString output;
+        int width = 800;
+        int height = 600;
+        double scale = 1.0;
+        QString title;
+        QString xLabel = "x";
+        QString yLabel = "y";
+        QCPRange xRange, yRange;
+        bool fixedXRange = false;
+        bool fixedYRange = false;
+        QList<Series> series;
+    };
+
+    bool loadJobs(const QString &jobFileName);   // Reads the job list, returns false if it can't be used
+    int run();   // Renders all jobs and returns the number of figures that couldn't be written
+    QString errorString() const { return lastError; }   // Describes why loadJobs failed
+
+    static int exec(const QString &jobFileName);   // Entry point of "--export", returns the exit code of the application
+
+private:
+    typedef QList<QSharedPointer<QCPGraphDataContainer> > FigureData;
+
+    static FigureData loadFigureData(const Job &job);   // Reads the datasets of a figure, runs on a worker thread
+    static QSharedPointer<QCPGraphDataContainer> loadDataFile(const QString &fileName);   // Reads "x y" lines, null if the file is invalid
+    static bool saveImage(const QImage &image, const QString &fileName);   // Encodes and writes an image, runs on a worker thread
+    static void setUpFigure(QCustomPlot *plot, const Job &job, const FigureData &data);   // Fills the hidden plot with the datasets of a job
+
+    QList<Job> jobs;
+    int threadCount = 0;
+    QString lastError;
+};
+
+#endif // BATCHEXPORT_H
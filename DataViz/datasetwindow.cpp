@@ -59,9 +59,11 @@ DataSetWindow::DataSetWindow(DataSet* DataSet,QWidget *parent) :
     // Setting icons for actions:
     const QIcon XYPlot_icon=QIcon(":/icons/graph.svg");
     XYPlot->setIcon(XYPlot_icon);
+    DensityMap->setIcon(XYPlot_icon);
 
     // connecting actions to responses via signal-slot mechanism:
     connect(XYPlot,SIGNAL(triggered()),this,SLOT(DataSetToBePlotted()));
+    connect(DensityMap,SIGNAL(triggered()),this,SLOT(DataSetToBeAggregated()));
 
 }
 
@@ -82,6 +84,7 @@ void DataSetWindow::contextMenuEvent(QContextMenuEvent *event)
 void DataSetWindow::ConstructContextMenu(QMenu *)
 {// This function is called in the constructor to build the context menu so that it does not need to be built everytime from scratch
     PlotSubMenu->addAction(XYPlot); // Add the action to the menu
+    PlotSubMenu->addAction(DensityMap);
     ContextMenu->addMenu(PlotSubMenu); // Add the submenus to the main menu
 }
 
@@ -94,6 +97,14 @@ void DataSetWindow::DataSetToBePlotted()
 
 }
 
+void DataSetWindow::DataSetToBeAggregated()
+{// A signal to tell the parent window that the dataset must be plotted as a density map when the user choses
+    // Density Map from the context Menu of the DataSetWindow
+
+    emit Plot_DensityMap_SIGNAL(DisplayedDataSet);
+
+}
+
 void DataSetWindow::onSaveButtonClicked()
 {
     //Get user-entered comments
@@ -34,11 +34,13 @@ public:
 public slots:
 
     void DataSetToBePlotted();   //Slot to handle the action to plot the dataset
+    void DataSetToBeAggregated();   //Slot to handle the action to plot the dataset as a density map
     void onSaveButtonClicked();   //Slot for save button click action
 
 signals:
 
     void Plot_XYPlot_SIGNAL(DataSet *ptr);   //Signal to notify parent window to plot the dataset
+    void Plot_DensityMap_SIGNAL(DataSet *ptr);   //Signal to notify parent window to plot the dataset as a density map
 
 private:
     Ui::DataSetWindow *ui;
@@ -48,6 +50,7 @@ private:
 
 
     QAction* XYPlot = new QAction("XY Plot", this);   // Action for plotting XY graph
+    QAction* DensityMap = new QAction("Density Map", this);   // Action for plotting the point density of large datasets
 
     // Context menu and its sub-menu for plotting
     QMenu *ContextMenu = new QMenu(this);
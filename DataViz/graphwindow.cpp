@@ -1,5 +1,7 @@
 #include "graphwindow.h"
 #include "ui_graphwindow.h"
+#include <QDir>
+#include <QFileInfo>
 
 // Initialize the static variable to track the number of figures created
 int GraphWindow::FigureCounter = 0;
@@ -12,8 +14,9 @@ GraphWindow::GraphWindow(DataSet *DataSet, QWidget *parent) :
 
     FigureCounter++; // Increment the counter for each new figure
 
-    // Set up graph settings for the provided dataset
-    SetGraphSetting(DataSet);
+    // Set up graph settings for the provided dataset. Streaming figures start without one
+    if (DataSet)
+        SetGraphSetting(DataSet);
     SetFigureSetting(); // Set up figure properties
 
     // Set the window title with the figure number
@@ -38,6 +41,18 @@ GraphWindow::GraphWindow(DataSet *DataSet, QWidget *parent) :
     connect(ui->comboBoxLineStyle, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &GraphWindow::changeLineStyle);
     connect(ui->spinBoxLineWidth, QOverload<int>::of(&QSpinBox::valueChanged), this, &GraphWindow::changeLineWidth);
     connect(ui->pushButtonSelectColor, &QPushButton::clicked, this, &GraphWindow::selectColor);
+    connect(ui->checkBoxDensityScatter, &QCheckBox::toggled, this, &GraphWindow::setDensityScatter);
+    connect(ui->comboBoxDataSets, &QComboBox::currentTextChanged, this, [this](const QString &dataSetName) {
+        QSignalBlocker blocker(ui->checkBoxDensityScatter); // Only show the setting of the newly selected dataset
+        ui->checkBoxDensityScatter->setChecked(densityScatterDataSets.contains(dataSetName));
+    });
+    connect(&streamRefreshTimer, &QTimer::timeout, this, &GraphWindow::refreshStream);
+    connect(&streamSourceTimer, &QTimer::timeout, this, &GraphWindow::readStreamFile);
+    connect(ui->checkBoxRenderProfile, &QCheckBox::toggled, this, &GraphWindow::setRenderProfiling);
+    connect(ui->customPlot, &QCustomPlot::frameProfiled, this, &GraphWindow::showRenderProfile);
+    connect(ui->checkBoxCrosshair, &QCheckBox::toggled, this, &GraphWindow::setCrosshair);
+    connect(ui->customPlot, &QCustomPlot::mouseMove, this, &GraphWindow::updateCrosshair);
+    connect(ui->spinBoxFrameBudget, QOverload<int>::of(&QSpinBox::valueChanged), this, &GraphWindow::setFrameTimeBudget);
 }
 
 // Destructor for GraphWindow. Cleans up the UI
@@ -57,6 +72,294 @@ void GraphWindow::addDataSet(DataSet *dataSet) {
     }
 }
 
+// Method to show the point density of a dataset instead of its curve. The points are counted per pixel
+// in the background and re-counted whenever the view is dragged or zoomed, so this stays fast for huge datasets
+void GraphWindow::addDensityMap(DataSet *dataSet) {
+    if (dataSet && dataSet->IsDataSetValid) {
+        ui->customPlot->clearGraphs(); // The density map is shown on its own
+        // The line style settings apply to graphs only, the density map is colored by its own gradient
+        ui->pushButtonSelectColor->hide();
+        ui->spinBoxLineWidth->hide();
+        ui->comboBoxLineStyle->hide();
+        ui->comboBoxDataSets->hide();
+        ui->checkBoxDensityScatter->hide();
+        QCPAggregateMap *densityMap = new QCPAggregateMap(ui->customPlot->xAxis, ui->customPlot->yAxis);
+        densityMap->setName(dataSet->getName());
+        densityMap->setAggregation(QCPAggregateMap::agCount);
+        densityMap->setDataScaleType(QCPAxis::stLogarithmic); // Counts usually span several orders of magnitude
+        densityMap->setSourceData(dataSet);
+        ui->customPlot->rescaleAxes();
+        ui->customPlot->replot();
+    }
+}
+
+// Method to switch the figure to live monitoring of "channelCount" channels. Each channel keeps only its latest
+// "pointsPerChannel" points in a fixed amount of memory, and the figure is redrawn at most "refreshRate" times per second
+// no matter how often data is appended, so the CPU load stays constant while streaming
+void GraphWindow::startStreaming(int channelCount, double timeWindow, int pointsPerChannel, int refreshRate) {
+    ui->customPlot->clearGraphs();
+    for (int channel = 0; channel < channelCount; ++channel) {
+        QCPGraph *graph = ui->customPlot->addGraph();
+        graph->data()->setCapacity(pointsPerChannel); // Oldest points are dropped in constant time per point
+        graph->data()->setRangeIndex(true); // Keeps the value axis rescaling in refreshStream cheap
+        graph->setName("Channel " + QString::number(channel + 1));
+        graph->setPen(QPen(QColor::fromHsv(channel * 360 / qMax(1, channelCount), 255, 200), 1));
+    }
+    streamTimeWindow = timeWindow;
+    streamLatestKey = -std::numeric_limits<double>::infinity(); // The first received key moves the x axis, whatever its sign
+    streamDataPending = false;
+    streamRefreshTimer.start(1000 / qMax(1, refreshRate));
+}
+
+// Method to append data to a streaming channel. Only stores the data, the figure is redrawn by refreshStream
+void GraphWindow::appendStreamData(int channel, const QVector<double> &keys, const QVector<double> &values) {
+    if (channel < 0 || channel >= ui->customPlot->graphCount() || keys.isEmpty())
+        return;
+    ui->customPlot->graph(channel)->addData(keys, values, true);
+    streamLatestKey = qMax(streamLatestKey, keys.last());
+    streamDataPending = true;
+}
+
+// Method to follow a text file that another program appends to. Every line holds an x value followed by one y value
+// per channel; the number of values in the first line sets the number of channels. Returns false if the file can't be read
+bool GraphWindow::streamFile(const QString &fileName, double timeWindow) {
+    streamSourceTimer.stop();
+    streamSource.close();
+    streamSource.setFileName(fileName);
+    if (!streamSource.open(QIODevice::ReadOnly | QIODevice::Unbuffered))
+        return false;
+    streamSourceLine.clear();
+    streamTimeWindow = timeWindow;
+    ui->customPlot->clearGraphs(); // The channels are created by startStreaming once the first line is read
+    setWindowTitle(windowTitle() + " - " + QFileInfo(fileName).fileName());
+    readStreamFile(); // Show what the file already contains right away
+    streamSourceTimer.start(20);
+    return true;
+}
+
+// Slot called by the file timer. Reads everything appended since the last call, splits it into lines and appends
+// the values of all complete lines to their channels in one call per channel
+void GraphWindow::readStreamFile() {
+    if (streamSource.size() < streamSource.pos()) { // The file was truncated or replaced, start over from its beginning
+        streamSource.seek(0);
+        streamSourceLine.clear();
+        // Drop the old channels and the latest key, the first line of the new content sets up the channels again
+        // (see below), so its x values are accepted even if they are smaller than the old ones
+        ui->customPlot->clearGraphs();
+        streamLatestKey = -std::numeric_limits<double>::infinity();
+        streamDataPending = false;
+        ui->customPlot->replot(QCustomPlot::rpQueuedReplot);
+    }
+    const QByteArray chunk = streamSource.readAll();
+    if (chunk.isEmpty())
+        return;
+    streamSourceLine += chunk;
+    const int lastNewline = streamSourceLine.lastIndexOf('\n');
+    if (lastNewline < 0)
+        return; // No complete line yet
+    const QList<QByteArray> lines = streamSourceLine.left(lastNewline).split('\n');
+    streamSourceLine.remove(0, lastNewline + 1);
+
+    QVector<double> keys;
+    QVector<QVector<double>> values(ui->customPlot->graphCount());
+    for (const QByteArray &line : lines) {
+        const QList<QByteArray> fields = QByteArray(line).replace(',', ' ').simplified().split(' ');
+        if (fields.size() < 2 || fields.first().isEmpty())
+            continue; // Empty line or x value only
+        if (ui->customPlot->graphCount() == 0) { // First line: one channel per y column
+            startStreaming(fields.size() - 1, streamTimeWindow, qMax(100000, 4000000 / (fields.size() - 1)));
+            values.resize(fields.size() - 1);
+        }
+        if (fields.size() - 1 != values.size())
+            continue; // Line doesn't match the channels
+        QVector<double> row(fields.size());
+        bool valid = true;
+        for (int i = 0; i < fields.size() && valid; ++i)
+            row[i] = fields.at(i).toDouble(&valid);
+        if (!valid || row.first() < (keys.isEmpty() ? streamLatestKey : keys.last()))
+            continue; // Not numeric, or not in ascending x order
+        keys.append(row.first());
+        for (int channel = 0; channel < values.size(); ++channel)
+            values[channel].append(row.at(channel + 1));
+    }
+    for (int channel = 0; channel < values.size() && !keys.isEmpty(); ++channel)
+        appendStreamData(channel, keys, values.at(channel));
+}
+
+// Slot called by the refresh timer. Lets the x axis follow the newest data and redraws once for all data received
+void GraphWindow::refreshStream() {
+    if (!streamDataPending || !isVisible())
+        return;
+    streamDataPending = false;
+    ui->customPlot->xAxis->setRange(streamLatestKey - streamTimeWindow, streamLatestKey);
+    // Fit the y axis to the data within the visible x range only
+    QCPRange visibleValues;
+    bool haveValues = false;
+    for (int i = 0; i < ui->customPlot->graphCount(); ++i) {
+        bool found = false;
+        QCPRange graphValues = ui->customPlot->graph(i)->getValueRange(found, QCP::sdBoth, ui->customPlot->xAxis->range());
+        if (found) {
+            if (haveValues)
+                visibleValues.expand(graphValues);
+            else
+                visibleValues = graphValues;
+            haveValues = true;
+        }
+    }
+    if (haveValues)
+        ui->customPlot->yAxis->setRange(visibleValues);
+    ui->customPlot->replot(QCustomPlot::rpQueuedReplot);
+}
+
+// Slot to switch the render statistics on or off. While on, the time spent per layer and per dataset on finding,
+// sampling, converting and painting the visible points is shown on top of the plot after every frame, and each
+// frame is appended as one JSON line to "<window title>-render.jsonl" in the temporary directory
+void GraphWindow::setRenderProfiling(bool enabled) {
+    ui->customPlot->setRenderProfiling(enabled);
+    if (enabled) {
+        if (!renderProfileOverlay) {
+            renderProfileOverlay = new QLabel(ui->customPlot);
+            renderProfileOverlay->setAttribute(Qt::WA_TransparentForMouseEvents); // Dragging and zooming still reach the plot
+            renderProfileOverlay->setStyleSheet("QLabel { background-color: rgba(255, 255, 255, 200); color: black; padding: 4px; }");
+            renderProfileOverlay->move(8, 8);
+        }
+        renderProfileOverlay->show();
+        renderProfileLog.setFileName(QDir::temp().filePath(windowTitle().replace(' ', '_') + "-render.jsonl"));
+        renderProfileLog.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+        ui->customPlot->replot(QCustomPlot::rpQueuedReplot); // Produce a first frame to show
+    } else {
+        if (renderProfileOverlay)
+            renderProfileOverlay->hide();
+        renderProfileLog.close();
+    }
+}
+
+// Slot called after every frame while the render statistics are on
+void GraphWindow::showRenderProfile() {
+    QCPRenderProfiler *profiler = ui->customPlot->renderProfiler();
+    if (!profiler)
+        return;
+    if (renderProfileOverlay) {
+        renderProfileOverlay->setText(profiler->summary());
+        renderProfileOverlay->adjustSize();
+    }
+    if (renderProfileLog.isOpen()) {
+        renderProfileLog.write(profiler->toJson().toUtf8());
+        renderProfileLog.write("\n");
+        renderProfileLog.flush(); // Keep the log complete if the application is closed
+    }
+}
+
+// Slot to switch the crosshair readout on or off. The crosshair items live on the buffered "overlay" layer, so
+// following the mouse only redraws that layer and never the (possibly huge) datasets below
+void GraphWindow::setCrosshair(bool enabled) {
+    QCustomPlot *plot = ui->customPlot;
+    if (enabled && !crosshairLine) {
+        crosshairLine = new QCPItemStraightLine(plot);
+        crosshairLine->setLayer("overlay");
+        crosshairLine->setSelectable(false);
+        crosshairLine->setPen(QPen(Qt::gray, 1, Qt::DashLine));
+        crosshairLine->point1->setTypeY(QCPItemPosition::ptAxisRectRatio); // Spans the axis rect vertically at a plot x value
+        crosshairLine->point2->setTypeY(QCPItemPosition::ptAxisRectRatio);
+        crosshairReadout = new QCPItemText(plot);
+        crosshairReadout->setLayer("overlay");
+        crosshairReadout->setSelectable(false);
+        crosshairReadout->position->setType(QCPItemPosition::ptAxisRectRatio);
+        crosshairReadout->position->setCoords(0.99, 0.01); // Top right, the render statistics are shown top left
+        crosshairReadout->setPositionAlignment(Qt::AlignRight | Qt::AlignTop);
+        crosshairReadout->setTextAlignment(Qt::AlignLeft);
+        crosshairReadout->setBrush(QColor(255, 255, 255, 200));
+        crosshairReadout->setPadding(QMargins(4, 4, 4, 4));
+        crosshairLine->setVisible(false);
+        crosshairReadout->setVisible(false);
+    } else if (!enabled && crosshairLine) {
+        for (auto *tracer : crosshairTracers)
+            plot->removeItem(tracer);
+        crosshairTracers.clear();
+        plot->removeItem(crosshairLine);
+        plot->removeItem(crosshairReadout);
+        crosshairLine = nullptr;
+        crosshairReadout = nullptr;
+        plot->layer("overlay")->replot();
+    }
+}
+
+// Slot called on every mouse move over the plot. Per graph, the closest data point is found with a binary search
+// (or directly for evenly spaced x values), so the cost doesn't depend on the size of the datasets
+void GraphWindow::updateCrosshair(QMouseEvent *event) {
+    if (!crosshairLine)
+        return;
+    QCustomPlot *plot = ui->customPlot;
+    const bool inside = plot->axisRect()->rect().contains(event->pos());
+    // Keep one tracer per graph, the graphs may have been replaced since the last move
+    while (crosshairTracers.size() > plot->graphCount())
+        plot->removeItem(crosshairTracers.takeLast());
+    while (crosshairTracers.size() < plot->graphCount()) {
+        QCPItemTracer *tracer = new QCPItemTracer(plot);
+        tracer->setLayer("overlay");
+        tracer->setSelectable(false);
+        tracer->setStyle(QCPItemTracer::tsCircle);
+        tracer->setSize(7);
+        crosshairTracers.append(tracer);
+    }
+
+    const double x = plot->xAxis->pixelToCoord(event->pos().x());
+    QString readout = "x = " + QString::number(x, 'g', 10);
+    for (int i = 0; i < plot->graphCount(); ++i) {
+        QCPGraph *graph = plot->graph(i);
+        QCPItemTracer *tracer = crosshairTracers.at(i);
+        const int index = inside && graph->visible() ? nearestSampleIndex(graph, graph->keyAxis()->pixelToCoord(event->pos().x())) : -1;
+        tracer->setVisible(index >= 0);
+        if (index < 0)
+            continue;
+        const QCPGraphData &sample = *graph->data()->at(index);
+        tracer->position->setAxes(graph->keyAxis(), graph->valueAxis());
+        tracer->position->setCoords(sample.key, sample.value);
+        tracer->setPen(QPen(graph->pen().color()));
+        readout += "\n" + graph->name() + ": (" + QString::number(sample.key, 'g', 10) + ", " + QString::number(sample.value, 'g', 10) + ")";
+    }
+    crosshairLine->point1->setCoords(x, 0);
+    crosshairLine->point2->setCoords(x, 1);
+    crosshairReadout->setText(readout);
+    crosshairLine->setVisible(inside);
+    crosshairReadout->setVisible(inside);
+    plot->layer("overlay")->replot();
+}
+
+// Slot for the "max interactive frame time" setting. Frames drawn while dragging, zooming or streaming that take longer
+// drop antialiasing, fills, scatter shapes and finally data resolution one step at a time, until the plot is idle again
+void GraphWindow::setFrameTimeBudget(int msec) {
+    ui->customPlot->setFrameTimeBudget(msec);
+}
+
+// Method to find the index of the data point whose key is closest to "key", or -1 if the graph has no data. If the
+// keys are evenly spaced, the index is computed directly and only verified against the neighbouring points,
+// otherwise it is found with a binary search
+int GraphWindow::nearestSampleIndex(QCPGraph *graph, double key) const {
+    const QSharedPointer<QCPGraphDataContainer> data = graph->data();
+    const int count = data->size();
+    if (count == 0)
+        return -1;
+    const double firstKey = data->constBegin()->key;
+    const double lastKey = (data->constEnd() - 1)->key;
+    if (count > 2 && lastKey > firstKey) {
+        const double step = (lastKey - firstKey) / (count - 1);
+        const int guess = qBound(1, qRound((key - firstKey) / step), count - 2);
+        // The guess is the closest point if it and its neighbours sit exactly on the even spacing, since the keys are sorted
+        bool even = true;
+        for (int i = guess - 1; i <= guess + 1 && even; ++i)
+            even = qAbs(data->at(i)->key - (firstKey + i * step)) <= step * 1e-6;
+        if (even && qAbs(key - data->at(guess)->key) <= step / 2)
+            return guess;
+    }
+    QCPGraphDataContainer::const_iterator above = data->findBegin(key, false); // First point with a key not below "key"
+    if (above == data->constEnd())
+        return count - 1;
+    if (above != data->constBegin() && key - (above - 1)->key < above->key - key)
+        --above;
+    return int(above - data->constBegin());
+}
+
 // Method to update the dataset combo box with current datasets
 void GraphWindow::updateDataSetComboBox() {
     ui->comboBoxDataSets->clear();
@@ -68,6 +371,7 @@ void GraphWindow::updateDataSetComboBox() {
 // Method to set graph settings for a single dataset
 void GraphWindow::SetGraphSetting(DataSet *DataSet) {
     ui->customPlot->addGraph();
+    ui->customPlot->graph(0)->data()->setRangeIndex(true);
     ui->customPlot->graph(0)->addData(DataSet);
     ui->customPlot->graph(0)->setPen(QPen(Qt::blue));
     ui->customPlot->graph(0)->setName(DataSet->getName());
@@ -89,6 +393,17 @@ void GraphWindow::SetFigureSetting()
     connect(ui->customPlot->xAxis, SIGNAL(rangeChanged(QCPRange)), ui->customPlot->xAxis2, SLOT(setRange(QCPRange)));
     connect(ui->customPlot->yAxis, SIGNAL(rangeChanged(QCPRange)), ui->customPlot->yAxis2, SLOT(setRange(QCPRange)));
     ui->customPlot->setInteractions(QCP::iRangeDrag | QCP::iRangeZoom | QCP::iSelectPlottables);
+    // prepare the line data of all datasets on the thread pool, only painting them stays on the GUI thread
+    ui->customPlot->setPlottingHint(QCP::phParallelPreparation);
+    // render at most once per display frame: bursts of style changes, wheel steps and drags are merged into one replot
+    ui->customPlot->setPlottingHint(QCP::phFrameScheduling);
+    // thin lines without antialiasing are written straight into the image buffers
+    ui->customPlot->setPlottingHint(QCP::phRasterLines);
+    // the largest datasets get their own buffered layers, so restyling or selecting one doesn't redraw the others
+    ui->customPlot->setGraphLayerLimit(8);
+    // keep interactive frames within the budget set in the window, dropping antialiasing (so the lines above take the
+    // raster path), fills, scatter shapes and data resolution only while frames are too slow
+    ui->customPlot->setFrameTimeBudget(ui->spinBoxFrameBudget->value());
 
 }
 
@@ -98,7 +413,7 @@ void GraphWindow::selectColor() {
     QColor color = QColorDialog::getColor(dataSetPens[selectedDataSetName].color(), this, "Select Line Color");
     if (color.isValid()) {
         dataSetPens[selectedDataSetName].setColor(color);
-        plotAllDataSets(); // Redraw the graph with new color settings
+        restyleDataSet(selectedDataSetName); // Redraw the dataset with new color settings
     }
 }
 
@@ -107,14 +422,25 @@ void GraphWindow::changeLineStyle(int index) {
     QString selectedDataSetName = ui->comboBoxDataSets->currentText();
     Qt::PenStyle style = static_cast<Qt::PenStyle>(ui->comboBoxLineStyle->itemData(index).toInt());
     dataSetPens[selectedDataSetName].setStyle(style);
-    plotAllDataSets(); // Redraw the graph with new line style settings
+    restyleDataSet(selectedDataSetName); // Redraw the dataset with new line style settings
 }
 
 // Slot for changing line width. Updates the pen width for the selected dataset
 void GraphWindow::changeLineWidth(int width) {
     QString selectedDataSetName = ui->comboBoxDataSets->currentText();
     dataSetPens[selectedDataSetName].setWidth(width);
-    plotAllDataSets(); // Redraw the graph with new line width settings
+    restyleDataSet(selectedDataSetName); // Redraw the dataset with new line width settings
+}
+
+// Slot function to switch the selected dataset between a density scatter, where its points are binned per pixel
+// (fast for very large datasets), and its normal line
+void GraphWindow::setDensityScatter(bool enabled) {
+    QString selectedDataSetName = ui->comboBoxDataSets->currentText();
+    if (enabled)
+        densityScatterDataSets.insert(selectedDataSetName);
+    else
+        densityScatterDataSets.remove(selectedDataSetName);
+    restyleDataSet(selectedDataSetName); // Redraw the dataset as a density scatter or a line
 }
 
 // Method to plot all datasets in the graph
@@ -123,10 +449,47 @@ void GraphWindow::plotAllDataSets() {
     for (auto *dataSet : dataSets) {
         ui->customPlot->addGraph();
         int graphIndex = ui->customPlot->graphCount() - 1;
+        ui->customPlot->graph(graphIndex)->data()->setRangeIndex(true); // Keeps value axis rescaling fast for large datasets
         ui->customPlot->graph(graphIndex)->addData(dataSet);
         ui->customPlot->graph(graphIndex)->setName(dataSet->getName());
-        ui->customPlot->graph(graphIndex)->setPen(dataSetPens[dataSet->getName()]); // Set custom pen for each dataset
-        ui->customPlot->graph(graphIndex)->rescaleAxes();
+        applyDataSetStyle(ui->customPlot->graph(graphIndex), dataSet->getName()); // Set custom pen for each dataset
+    }
+    ui->customPlot->rescaleAxes(); // Rescale once so that all datasets are visible
+    ui->customPlot->replot(QCustomPlot::rpQueuedReplot); // Redraw the graph with all datasets, merged with other pending redraws
+}
+
+// Method to find the graph that displays the dataset with the given name
+QCPGraph *GraphWindow::graphForDataSet(const QString &dataSetName) {
+    for (int i = 0; i < ui->customPlot->graphCount(); ++i) {
+        if (ui->customPlot->graph(i)->name() == dataSetName)
+            return ui->customPlot->graph(i);
+    }
+    return nullptr;
+}
+
+// Method to apply the pen settings of a dataset to its graph
+void GraphWindow::applyDataSetStyle(QCPGraph *graph, const QString &dataSetName) {
+    QPen pen = dataSetPens[dataSetName];
+    graph->setPen(pen);
+    if (densityScatterDataSets.contains(dataSetName)) {
+        // Density scatter: draw the points as a per-pixel density image instead of connecting them
+        graph->setLineStyle(QCPGraph::lsNone);
+        graph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, pen.color(), pen.color(), 4));
+        graph->setDensityScatter(true);
+    } else {
+        graph->setLineStyle(QCPGraph::lsLine);
+        graph->setScatterStyle(QCPScatterStyle());
+        graph->setDensityScatter(false);
+    }
+}
+
+// Method to apply changed pen settings of a dataset. Only that dataset is redrawn, the other datasets keep their drawing
+void GraphWindow::restyleDataSet(const QString &dataSetName) {
+    QCPGraph *graph = graphForDataSet(dataSetName);
+    if (!graph) {
+        plotAllDataSets();
+        return;
     }
-    ui->customPlot->replot(); // Redraw the graph with all datasets
+    applyDataSetStyle(graph, dataSetName);
+    ui->customPlot->replotGraph(graph);
 }
@@ -16,11 +16,21 @@
 #include "dataset.h"
 #include <QColorDialog>
 #include <QMap>
+#include <QSet>
+#include <QTimer>
+#include <QLabel>
+#include <QFile>
+#include <limits>
 
 namespace Ui {
 class GraphWindow;
 }
 
+class QCPGraph;
+class QCPItemStraightLine;
+class QCPItemTracer;
+class QCPItemText;
+
 class GraphWindow : public QDialog
 {
     Q_OBJECT
@@ -30,6 +40,12 @@ public:
     ~GraphWindow();
 
     void addDataSet(DataSet *dataSet);   // Adds a new dataset to the graph window
+    void addDensityMap(DataSet *dataSet);   // Shows the point density of a dataset, aggregated per pixel
+
+    // Live monitoring: the figure shows the latest "timeWindow" of each channel and follows new data
+    void startStreaming(int channelCount, double timeWindow, int pointsPerChannel, int refreshRate = 30);
+    void appendStreamData(int channel, const QVector<double> &keys, const QVector<double> &values);   // Keys must be ascending
+    bool streamFile(const QString &fileName, double timeWindow);   // Streams the lines another program appends to a text file
 
     bool hasDataSets() const { return !dataSets.isEmpty(); }   // Checks if the graph window contains any datasets
 
@@ -44,12 +60,27 @@ public slots:
     // Slot functions for changing line style and width
     void changeLineStyle(int index);
     void changeLineWidth(int width);
+    void setDensityScatter(bool enabled);   // Draws the selected dataset as a per-pixel point density, or as a line again
+
+private slots:
+
+    void refreshStream();   // Moves the x axis to the newest data and redraws, called at the refresh rate
+    void readStreamFile();   // Appends the lines added to the streamed file since the last call
+    void setRenderProfiling(bool enabled);   // Shows and logs the render statistics of every frame, or stops doing so
+    void showRenderProfile();   // Updates the overlay and the log with the statistics of the frame just drawn
+    void setCrosshair(bool enabled);   // Shows or removes the crosshair that reads out the data under the mouse
+    void updateCrosshair(QMouseEvent *event);   // Moves the crosshair to the mouse and redraws only the overlay layer
+    void setFrameTimeBudget(int msec);   // Sets the longest interactive frame time before the drawing quality is reduced, 0 for never
 
 private:
 
     void SetGraphSetting();  // Internal function to update graph settings
     void updateDataSetComboBox();   // Updates the dataset combo box with available datasets
     void plotAllDataSets();   // Plots all datasets added to the graph window
+    QCPGraph *graphForDataSet(const QString &dataSetName);   // Finds the graph displaying a dataset
+    void applyDataSetStyle(QCPGraph *graph, const QString &dataSetName);   // Applies the pen settings of a dataset to its graph
+    void restyleDataSet(const QString &dataSetName);   // Applies new pen settings and redraws only that dataset
+    int nearestSampleIndex(QCPGraph *graph, double key) const;   // Finds the data point of a graph with the key closest to "key"
 
     Ui::GraphWindow *ui;
     QList<DataSet*> dataSets; // List to hold multiple datasets
@@ -57,6 +88,22 @@ private:
 
     QPen currentPen; // Current pen for graph line settings
     QMap<QString, QPen> dataSetPens; // Maps dataset names to their respective QPen settings
+    QSet<QString> densityScatterDataSets; // Names of the datasets drawn as a point density instead of a line
+
+    QTimer streamRefreshTimer; // Redraws streaming data at a fixed rate, independent of how often data arrives
+    double streamTimeWindow = 0; // Width of the visible x range while streaming
+    double streamLatestKey = -std::numeric_limits<double>::infinity(); // Largest x value received so far
+    bool streamDataPending = false; // Whether data arrived since the last redraw
+    QFile streamSource; // Text file being streamed, open while the figure follows it
+    QTimer streamSourceTimer; // Checks the streamed file for new lines
+    QByteArray streamSourceLine; // Incomplete last line of the streamed file, completed by the next read
+
+    QLabel *renderProfileOverlay = nullptr; // Shows the render statistics on top of the plot, created when first enabled
+    QFile renderProfileLog; // Receives the render statistics of each frame as one JSON object per line
+
+    QCPItemStraightLine *crosshairLine = nullptr; // Vertical line at the mouse position, exists while the crosshair is on
+    QCPItemText *crosshairReadout = nullptr; // Lists the x value and the closest data point of each dataset
+    QList<QCPItemTracer*> crosshairTracers; // Marks the closest data point, one per graph
 };
 
 #endif // GRAPHWINDOW_H
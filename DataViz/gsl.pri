@@ -0,0 +1,10 @@
+# GNU Scientific Library, used by DataSet. Shared by the application and the projects under tests/
+
+INCLUDEPATH += $$PWD/GSLinclude
+DEPENDPATH += $$PWD/GSLlib
+
+win32: LIBS += -L$$PWD/GSLlib/ -lgsl -lgslcblas
+else: LIBS += -lgsl -lgslcblas # system installation
+
+win32:!win32-g++: PRE_TARGETDEPS += $$PWD/GSLlib/gsl.lib $$PWD/GSLlib/gslcblas.lib
+else:win32-g++: PRE_TARGETDEPS += $$PWD/GSLlib/libgsl.a $$PWD/GSLlib/libgslcblas.a
@@ -1,4 +1,5 @@
 #include "parentwindow.h"
+#include "batchexport.h"
 
 #include <QApplication>
 #include <QSplashScreen>
@@ -6,6 +7,20 @@
 
 int main(int argc, char *argv[])
 {
+    // Headless batch export: "DataViz --export jobs.json" renders the figures of a job list without any window
+    for (int i = 1; i < argc; ++i) {
+        if (qstrcmp(argv[i], "--export") == 0) {
+            if (i + 1 == argc) { // Starting the GUI instead would hang a script waiting for the export
+                qCritical("Missing job file. Usage: %s --export <jobs.json>", argv[0]);
+                return 1;
+            }
+            if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM"))
+                qputenv("QT_QPA_PLATFORM", "offscreen"); // Works without a display, e.g. on a build server
+            QApplication a(argc, argv);
+            return BatchExport::exec(QString::fromLocal8Bit(argv[i + 1]));
+        }
+    }
+
     QApplication a(argc, argv);
 
     // Adding the startup image
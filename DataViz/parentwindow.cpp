@@ -3,6 +3,7 @@
 #include <QActionGroup>
 #include "functiondialog.h"
 #include <QMessageBox>
+#include <QInputDialog>
 #include <QVector>
 
 
@@ -60,6 +61,7 @@ void ParentWindow::on_actionLoad_Dataset_triggered()
         // To enable the ParentWindow to plot the dataset when the user clicks on XYPlot option in the context menu
         // of an already displayed DataSetWidnow
         connect(AddedDataSetWindow,SIGNAL(Plot_XYPlot_SIGNAL(DataSet*)),this,SLOT(GraphWindowToBePlotted(DataSet*)));
+        connect(AddedDataSetWindow,SIGNAL(Plot_DensityMap_SIGNAL(DataSet*)),this,SLOT(DensityMapToBePlotted(DataSet*)));
 
     }
 
@@ -145,6 +147,30 @@ void ParentWindow::on_actionDrawMultipleCharts_2_triggered() {
 }
 
 
+// Slot function to follow a text file that another program (e.g. a data logger) keeps appending to. Each line holds
+// an x value followed by one y value per channel, and the new graph window shows the latest part of every channel
+void ParentWindow::on_actionMonitor_a_live_file_triggered() {
+    QString curPath=QDir::currentPath();
+    QString FileName=QFileDialog::getOpenFileName(this,tr("Monitor file"),curPath,tr("Text files (*.txt);;All files(*.*)"));
+    if (FileName.isEmpty())
+        return;
+
+    bool ok = false;
+    double timeWindow = QInputDialog::getDouble(this, tr("Monitor file"), tr("Visible x range:"), 10, 1e-9, 1e12, 3, &ok);
+    if (!ok)
+        return;
+
+    GraphWindow *streamGraphWindow = new GraphWindow(nullptr, this); // Starts without a dataset, the channels come from the file
+    if (!streamGraphWindow->streamFile(FileName, timeWindow)) {
+        QMessageBox::critical(this, tr("Error"), tr("The file could not be opened."));
+        delete streamGraphWindow;
+        return;
+    }
+    subWindow = ui->WindowsManager->addSubWindow(streamGraphWindow);
+    streamGraphWindow->show();
+}
+
+
 // Slot function to plot a dataset in a new graph window
 void ParentWindow::GraphWindowToBePlotted(DataSet *ptr) {
       // Display a message and return if no datasets are loaded
@@ -161,6 +187,17 @@ void ParentWindow::GraphWindowToBePlotted(DataSet *ptr) {
 }
 
 
+// Slot function to plot the point density of a dataset in a new graph window
+void ParentWindow::DensityMapToBePlotted(DataSet *ptr) {
+    // Create a new graph window showing the density map of the selected dataset. It starts without a dataset, so
+    // no graph of the (possibly huge) dataset is built only to be replaced by the density map
+    GraphWindow *addedGraphWindow = new GraphWindow(nullptr, this);
+    addedGraphWindow->addDensityMap(ptr);
+    subWindow = ui->WindowsManager->addSubWindow(addedGraphWindow);
+    addedGraphWindow->show();
+}
+
+
 // Slot function to handle the 'Function' action
 void ParentWindow::on_actionFunction_triggered() {
       // Display a message and return if no datasets are loaded
@@ -43,6 +43,7 @@ private slots:
 
     void on_actionLoad_Dataset_triggered();   // Slot for loading a new dataset
     void GraphWindowToBePlotted(DataSet *ptr);   // Slot to create and display a new graph window
+    void DensityMapToBePlotted(DataSet *ptr);   // Slot to create and display a new graph window with a density map
 
     // Slots for triggering About and Help dialogs
     void on_actionAbout_triggered();
@@ -51,6 +52,7 @@ private slots:
 
     void on_actionSelect_a_dataset_triggered();   // Slot for selecting a specific dataset
     void on_actionDrawMultipleCharts_2_triggered();   // Slot for drawing multiple charts
+    void on_actionMonitor_a_live_file_triggered();   // Slot for plotting a file live while another program writes to it
     void on_actionFunction_triggered();   // Slot for invoking the function dialog
 
 private:
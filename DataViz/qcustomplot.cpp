@@ -24,6 +24,45 @@
 ****************************************************************************/
 
 #include "qcustomplot.h"
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QtCore/QThread>
+#include <QtCore/QBitArray>
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#  define QCP_AVX2_DISPATCH // AVX2 code paths are compiled with target attributes and selected at runtime
+#  include <immintrin.h>
+#endif
+
+#ifdef QCP_AVX2_DISPATCH
+/*! \internal
+
+  Returns the natural logarithms of the four values in \a x, which must be positive, finite and
+  normal. The result agrees with qLn to about 1e-13 relative error. May only be called if the CPU
+  supports AVX2, see e.g. \ref QCPAxis::transformCoordsAvx2.
+*/
+__attribute__((target("avx2")))
+static inline __m256d qcpLnAvx2(__m256d x)
+{
+  // coefficients of ln(m) = 2s*(1 + s^2/3 + s^4/5 + ...) with s = (m-1)/(m+1), highest order first:
+  static const double lnSeries[] = {1.0/21.0, 1.0/19.0, 1.0/17.0, 1.0/15.0, 1.0/13.0, 1.0/11.0, 1.0/9.0, 1.0/7.0, 1.0/5.0, 1.0/3.0, 1.0};
+  const __m256d one = _mm256_set1_pd(1.0);
+  // split x into 2^exponent*mantissa with mantissa in [sqrt(0.5), sqrt(2)) and sum ln(2)*exponent+ln(mantissa):
+  const __m256i bits = _mm256_castpd_si256(x);
+  __m256d mantissa = _mm256_castsi256_pd(_mm256_or_si256(_mm256_and_si256(bits, _mm256_set1_epi64x(0x000FFFFFFFFFFFFFLL)), _mm256_set1_epi64x(0x3FF0000000000000LL)));
+  __m256d exponent = _mm256_sub_pd(_mm256_castsi256_pd(_mm256_or_si256(_mm256_srli_epi64(bits, 52), _mm256_set1_epi64x(0x4330000000000000LL))), _mm256_set1_pd(4503599627370496.0+1023.0));
+  const __m256d large = _mm256_cmp_pd(mantissa, _mm256_set1_pd(1.41421356237309504880), _CMP_GT_OQ);
+  mantissa = _mm256_blendv_pd(mantissa, _mm256_mul_pd(mantissa, _mm256_set1_pd(0.5)), large);
+  exponent = _mm256_add_pd(exponent, _mm256_and_pd(large, one));
+  const __m256d s = _mm256_div_pd(_mm256_sub_pd(mantissa, one), _mm256_add_pd(mantissa, one));
+  const __m256d s2 = _mm256_mul_pd(s, s);
+  __m256d series = _mm256_set1_pd(lnSeries[0]);
+  for (int k=1; k<int(sizeof(lnSeries)/sizeof(lnSeries[0])); ++k)
+    series = _mm256_add_pd(_mm256_mul_pd(series, s2), _mm256_set1_pd(lnSeries[k]));
+  const __m256d lnMantissa = _mm256_mul_pd(_mm256_add_pd(s, s), series);
+  return _mm256_add_pd(_mm256_mul_pd(exponent, _mm256_set1_pd(0.693147180369123816490)), // ln(2) split into a high part exact in 32 bits ...
+                       _mm256_add_pd(_mm256_mul_pd(exponent, _mm256_set1_pd(1.90821492927058770002e-10)), lnMantissa)); // ... and the remainder
+}
+#endif
 
 
 /* including file 'src/vector2d.cpp'       */
@@ -485,6 +524,295 @@ void QCPPainter::makeNonCosmetic()
     QPainter::setPen(p);
   }
 }
+
+/*!
+  Draws the polyline \a lineData by writing the pixels directly into the image the painter is
+  active on, bypassing the paint engine. NaN and infinite points create gaps in the line, like in
+  \ref QCPAbstractPlottable1D::drawPolyline.
+
+  This is only possible for the common case of a thin line: The painter must be active on a 32 bit
+  QImage with an unrotated transform and a rectangular clip (or none), it must not be antialiased or
+  in \ref pmVectorized mode, and the pen must be a solid, opaque color of 1 pixel width, drawn with
+  opacity 1 in the default composition mode. Segments within one pixel column, which dominate dense
+  data, are merged into vertical spans and written per column, all other segments are drawn with
+  Bresenham's algorithm after being clipped.
+
+  Returns false without drawing anything if any of the conditions isn't met, the caller must then
+  draw the line with the regular QPainter methods.
+
+  \see QCP::phRasterLines
+*/
+bool QCPPainter::drawRasterPolyline(const QVector<QPointF> &lineData)
+{
+  if (!isActive() || !device() || device()->devType() != QInternal::Image || mModes.testFlag(pmVectorized) ||
+      testRenderHint(QPainter::Antialiasing) || !qFuzzyCompare(opacity(), 1.0) || compositionMode() != QPainter::CompositionMode_SourceOver)
+    return false;
+  QImage *image = static_cast<QImage*>(device());
+  if (image->format() != QImage::Format_RGB32 && image->format() != QImage::Format_ARGB32 && image->format() != QImage::Format_ARGB32_Premultiplied)
+    return false;
+  const QPen linePen = pen();
+  const QTransform transform = deviceTransform();
+  if (linePen.style() != Qt::SolidLine || linePen.brush().style() != Qt::SolidPattern || linePen.color().alpha() != 255 ||
+      transform.type() > QTransform::TxScale)
+    return false;
+  if (linePen.isCosmetic() ? linePen.widthF() > 1.0 : (transform.type() > QTransform::TxTranslate || !qFuzzyCompare(linePen.widthF(), 1.0)))
+    return false;
+  
+  // pixel bounds the line is clipped to, inclusive:
+  QRect bounds = image->rect();
+  if (hasClipping())
+  {
+    const QRegion clip = transform.map(clipRegion());
+    if (clip.rectCount() > 1)
+      return false;
+    bounds &= clip.boundingRect();
+  }
+  if (bounds.isEmpty() || lineData.size() < 2)
+    return true;
+  const int left = bounds.left(), right = bounds.right(), top = bounds.top(), bottom = bounds.bottom();
+  
+  // a point at (x, y) is drawn into the pixel whose top left corner is closest, like aliased QPainter lines:
+  const uint color = 0xff000000 | linePen.color().rgb(); // opaque, so also valid premultiplied
+  uchar *bits = image->bits();
+  const int stride = int(image->bytesPerLine())/4;
+  uint *firstPixel = reinterpret_cast<uint*>(bits);
+  
+  // clips the segment p0-p1 to the area of the pixels within bounds, returns false if nothing remains:
+  const QRectF pixelArea(left-0.5, top-0.5, right-left+1, bottom-top+1);
+  auto clipSegment = [&](QPointF &p0, QPointF &p1) -> bool
+  {
+    double t0, t1;
+    if (!clipLineParameters(p0, p1, pixelArea, t0, t1))
+      return false;
+    const QPointF start = p0;
+    p0 = start + t0*(p1-start);
+    p1 = start + t1*(p1-start);
+    return true;
+  };
+  auto drawSpan = [&](int x, int y0, int y1)
+  {
+    uint *pixel = firstPixel + y0*stride + x;
+    for (int y=y0; y<=y1; ++y, pixel += stride)
+      *pixel = color;
+  };
+  auto drawSegment = [&](int x0, int y0, int x1, int y1)
+  {
+    const int dx = qAbs(x1-x0), dy = -qAbs(y1-y0);
+    const int sx = x0 < x1 ? 1 : -1;
+    const int sy = y0 < y1 ? stride : -stride;
+    uint *pixel = firstPixel + y0*stride + x0;
+    uint *lastPixel = firstPixel + y1*stride + x1;
+    int error = dx+dy;
+    while (true)
+    {
+      *pixel = color;
+      if (pixel == lastPixel)
+        break;
+      const int error2 = 2*error;
+      if (error2 >= dy)
+      {
+        error += dy;
+        pixel += sx;
+      }
+      if (error2 <= dx)
+      {
+        error += dx;
+        pixel += sy;
+      }
+    }
+  };
+  
+  // vertical span collected from consecutive segments within the same pixel column:
+  int spanColumn = -1, spanTop = 0, spanBottom = 0;
+  QPointF previous = transform.map(lineData.first());
+  bool previousValid = qIsFinite(previous.x()) && qIsFinite(previous.y());
+  for (int i=1; i<lineData.size(); ++i)
+  {
+    const QPointF current = transform.map(lineData.at(i));
+    const bool currentValid = qIsFinite(current.x()) && qIsFinite(current.y());
+    QPointF p0 = previous, p1 = current;
+    previous = current;
+    if (!previousValid || !currentValid)
+    {
+      previousValid = currentValid;
+      continue;
+    }
+    if (!clipSegment(p0, p1))
+      continue;
+    const int x0 = qBound(left, qFloor(p0.x()+0.5), right), y0 = qBound(top, qFloor(p0.y()+0.5), bottom);
+    const int x1 = qBound(left, qFloor(p1.x()+0.5), right), y1 = qBound(top, qFloor(p1.y()+0.5), bottom);
+    if (x0 == x1)
+    {
+      if (x0 != spanColumn)
+      {
+        if (spanColumn >= 0)
+          drawSpan(spanColumn, spanTop, spanBottom);
+        spanColumn = x0;
+        spanTop = spanBottom = y0;
+      }
+      spanTop = qMin(spanTop, qMin(y0, y1));
+      spanBottom = qMax(spanBottom, qMax(y0, y1));
+    } else
+    {
+      if (spanColumn >= 0)
+        drawSpan(spanColumn, spanTop, spanBottom);
+      spanColumn = -1;
+      drawSegment(x0, y0, x1, y1);
+    }
+  }
+  if (spanColumn >= 0)
+    drawSpan(spanColumn, spanTop, spanBottom);
+  return true;
+}
+
+/*!
+  Splits the polyline \a lineData into the dashes of the dash pattern of \a pen, and returns them
+  as one polyline where the dashes are separated by NaN points, ready to be drawn with a solid
+  version of \a pen. This is much faster than letting QPainter dash long polylines.
+
+  Like with QPainter, the dash pattern and offset are given in units of the pen width (at least 1
+  pixel). The dash phase continues across the vertices, NaN gaps and parts outside \a clipRect, but
+  dashes are only generated inside \a clipRect, so the result stays bounded by its size even if
+  the line is much longer. If the pen has no usable dash pattern, \a lineData is returned
+  unchanged.
+
+  \see QCPAbstractPlottable1D::drawPolyline
+*/
+QVector<QPointF> QCPPainter::dashPolyline(const QVector<QPointF> &lineData, const QPen &pen, const QRectF &clipRect)
+{
+  const double unit = qMax(1.0, pen.widthF());
+  QVector<double> pattern;
+  double period = 0;
+  foreach (qreal length, pen.dashPattern())
+  {
+    pattern.append(qMax(0.0, double(length)*unit));
+    period += pattern.last();
+  }
+  if (pattern.size() < 2 || pattern.size() % 2 != 0 || period <= 0)
+    return lineData;
+  
+  // current position in the pattern, even entries are dashes and odd ones gaps:
+  int entry = 0;
+  double entryLeft = pattern.first();
+  auto advance = [&](double distance)
+  {
+    distance = std::fmod(distance, period);
+    while (distance > entryLeft)
+    {
+      distance -= entryLeft;
+      entry = (entry+1) % pattern.size();
+      entryLeft = pattern.at(entry);
+    }
+    entryLeft -= distance;
+  };
+  advance(pen.dashOffset()*unit);
+  
+  QVector<QPointF> result;
+  result.reserve(lineData.size());
+  const QPointF gap(qQNaN(), qQNaN());
+  bool inDash = false;
+  auto endDash = [&]()
+  {
+    if (inDash)
+    {
+      result.append(gap);
+      inDash = false;
+    }
+  };
+  for (int i=1; i<lineData.size(); ++i)
+  {
+    const QPointF start = lineData.at(i-1);
+    const QPointF delta = lineData.at(i)-start;
+    const double length = qSqrt(delta.x()*delta.x()+delta.y()*delta.y());
+    if (!qIsFinite(length)) // NaN or infinite vertex, creates a gap in the line
+    {
+      endDash();
+      continue;
+    }
+    double t0, t1;
+    if (length == 0 || !clipLineParameters(start, lineData.at(i), clipRect, t0, t1))
+    {
+      endDash();
+      advance(length);
+      continue;
+    }
+    if (t0 > 0)
+    {
+      endDash();
+      advance(t0*length);
+    }
+    double position = t0*length;
+    const double visibleEnd = t1*length;
+    while (true)
+    {
+      const bool dash = entry % 2 == 0;
+      if (dash && !inDash)
+      {
+        result.append(start + delta*(position/length));
+        inDash = true;
+      }
+      if (position+entryLeft > visibleEnd)
+      {
+        entryLeft -= visibleEnd-position;
+        break;
+      }
+      position += entryLeft;
+      if (dash)
+      {
+        result.append(start + delta*(position/length));
+        endDash();
+      }
+      entry = (entry+1) % pattern.size();
+      entryLeft = pattern.at(entry);
+    }
+    if (inDash)
+      result.append(start + delta*t1);
+    if (t1 < 1)
+    {
+      endDash();
+      advance((1-t1)*length);
+    }
+  }
+  return result;
+}
+
+/*! \internal
+
+  Clips the line from \a start to \a end to \a rect (Liang-Barsky). The visible part is returned as
+  the line parameters \a t0 and \a t1, where 0 is \a start and 1 is \a end. Returns false if the
+  line doesn't touch \a rect.
+*/
+bool QCPPainter::clipLineParameters(const QPointF &start, const QPointF &end, const QRectF &rect, double &t0, double &t1)
+{
+  const double dx = end.x()-start.x(), dy = end.y()-start.y();
+  const double p[4] = {-dx, dx, -dy, dy};
+  const double q[4] = {start.x()-rect.left(), rect.right()-start.x(), start.y()-rect.top(), rect.bottom()-start.y()};
+  t0 = 0;
+  t1 = 1;
+  for (int k=0; k<4; ++k)
+  {
+    if (p[k] == 0)
+    {
+      if (q[k] < 0)
+        return false;
+    } else
+    {
+      const double t = q[k]/p[k];
+      if (p[k] < 0)
+      {
+        if (t > t1)
+          return false;
+        t0 = qMax(t0, t);
+      } else
+      {
+        if (t < t0)
+          return false;
+        t1 = qMin(t1, t);
+      }
+    }
+  }
+  return true;
+}
 /* end of 'src/painter.cpp' */
 
 
@@ -719,6 +1047,78 @@ void QCPPaintBufferPixmap::reallocateBuffer()
   }
 }
 
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPPaintBufferImage
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPPaintBufferImage
+  \brief A paint buffer based on QImage, using software raster rendering
+
+  This paint buffer renders like \ref QCPPaintBufferPixmap, but keeps its pixels in a QImage that
+  is accessible to the application. This allows \ref QCPPainter::drawRasterPolyline to write thin
+  lines directly into the buffer. It is used instead of the pixmap paint buffer if the plotting
+  hint \ref QCP::phRasterLines is set and \ref QCustomPlot::setOpenGl is false.
+*/
+
+/*!
+  Creates an image paint buffer instance with the specified \a size and \a devicePixelRatio, if
+  applicable.
+*/
+QCPPaintBufferImage::QCPPaintBufferImage(const QSize &size, double devicePixelRatio) :
+  QCPAbstractPaintBuffer(size, devicePixelRatio)
+{
+  QCPPaintBufferImage::reallocateBuffer();
+}
+
+QCPPaintBufferImage::~QCPPaintBufferImage()
+{
+}
+
+/* inherits documentation from base class */
+QCPPainter *QCPPaintBufferImage::startPainting()
+{
+  QCPPainter *result = new QCPPainter(&mBuffer);
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+  result->setRenderHint(QPainter::HighQualityAntialiasing);
+#endif
+  return result;
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::draw(QCPPainter *painter) const
+{
+  if (painter && painter->isActive())
+    painter->drawImage(0, 0, mBuffer);
+  else
+    qDebug() << Q_FUNC_INFO << "invalid or inactive painter passed";
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::clear(const QColor &color)
+{
+  mBuffer.fill(color);
+}
+
+/* inherits documentation from base class */
+void QCPPaintBufferImage::reallocateBuffer()
+{
+  setInvalidated();
+  if (!qFuzzyCompare(1.0, mDevicePixelRatio))
+  {
+#ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
+    mBuffer = QImage(mSize*mDevicePixelRatio, QImage::Format_ARGB32_Premultiplied);
+    mBuffer.setDevicePixelRatio(mDevicePixelRatio);
+#else
+    qDebug() << Q_FUNC_INFO << "Device pixel ratios not supported for Qt versions before 5.4";
+    mDevicePixelRatio = 1.0;
+    mBuffer = QImage(mSize, QImage::Format_ARGB32_Premultiplied);
+#endif
+  } else
+  {
+    mBuffer = QImage(mSize, QImage::Format_ARGB32_Premultiplied);
+  }
+}
+
 
 #ifdef QCP_OPENGL_PBUFFER
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1594,11 +1994,17 @@ bool QCPLayerable::moveToLayer(QCPLayer *layer, bool prepend)
   localAntialiased value as well as the overrides \ref QCustomPlot::setAntialiasedElements and \ref
   QCustomPlot::setNotAntialiasedElements. Which override enum this function takes into account is
   controlled via \a overrideElement.
+
+  While the parent plot reduces the quality of interactive replots (see \ref
+  QCustomPlot::setFrameTimeBudget), plottables, scatters, fills and error bars aren't antialiased.
 */
 void QCPLayerable::applyAntialiasingHint(QCPPainter *painter, bool localAntialiased, QCP::AntialiasedElement overrideElement) const
 {
+  const QCP::AntialiasedElements reducibleElements = QCP::aePlottables|QCP::aeScatters|QCP::aeFills|QCP::aeErrorBars;
   if (mParentPlot && mParentPlot->notAntialiasedElements().testFlag(overrideElement))
     painter->setAntialiasing(false);
+  else if (mParentPlot && mParentPlot->qualityLevel() >= QCustomPlot::qlNoAntialiasing && reducibleElements.testFlag(overrideElement))
+    painter->setAntialiasing(false);
   else if (mParentPlot && mParentPlot->antialiasedElements().testFlag(overrideElement))
     painter->setAntialiasing(true);
   else
@@ -5454,6 +5860,181 @@ void QCPLineEnding::draw(QCPPainter *painter, const QCPVector2D &pos, double ang
 /* end of 'src/lineending.cpp' */
 
 
+/* including file 'src/labelcache.cpp'     */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPLabelCache
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPLabelCache
+  \brief A process-wide cache of rendered tick labels
+
+  Drawing text is among the most expensive parts of a replot. When \ref QCP::phCacheLabels is set,
+  the axes therefore render each tick label into a pixmap once and afterwards only draw the pixmap.
+  These pixmaps are kept in the single instance of this class, which is shared by all axes of all
+  QCustomPlot instances. Plots with linked axes, or many windows showing similar data, thus render
+  each label text only once.
+
+  Labels are looked up by a key that contains everything that affects their appearance, i.e. the
+  text, font, color, rotation, device pixel ratio and number formatting of the axis, so labels
+  never need to be invalidated. When the memory of all pixmaps exceeds \ref memoryLimit, the least
+  recently used labels are discarded.
+
+  \ref hits and \ref misses count the lookups since the start of the application. The lookups of a
+  single frame are reported by the \ref QCPRenderProfiler. All methods are thread-safe.
+*/
+
+/*!
+  Returns the label cache shared by all plots of the application. It is emptied when the
+  QCoreApplication is destroyed, since pixmaps can't outlive it.
+*/
+QCPLabelCache *QCPLabelCache::instance()
+{
+  // created on first use (thread-safe since C++11). The cache object itself is never deleted, only
+  // its pixmaps are released together with the application:
+  static QCPLabelCache *cache = []() -> QCPLabelCache*
+  {
+    qAddPostRoutine([]() { QCPLabelCache::instance()->clear(); });
+    return new QCPLabelCache;
+  }();
+  return cache;
+}
+
+/*! \internal
+
+  Creates an empty label cache with a memory limit of 16 MB, which holds several thousand typical
+  tick labels. Use \ref instance to access the cache.
+*/
+QCPLabelCache::QCPLabelCache() :
+  mLabels(16*1024*1024),
+  mHits(0),
+  mMisses(0)
+{
+}
+
+/*!
+  Returns the maximum memory in bytes that the pixmaps of the cached labels may occupy.
+
+  \see setMemoryLimit, memoryUsage
+*/
+qint64 QCPLabelCache::memoryLimit() const
+{
+  QMutexLocker locker(&mMutex);
+  return mLabels.maxCost();
+}
+
+/*!
+  Returns the memory in bytes that the pixmaps of the cached labels currently occupy.
+
+  \see memoryLimit
+*/
+qint64 QCPLabelCache::memoryUsage() const
+{
+  QMutexLocker locker(&mMutex);
+  return mLabels.totalCost();
+}
+
+/*!
+  Returns the number of cached labels.
+*/
+int QCPLabelCache::count() const
+{
+  QMutexLocker locker(&mMutex);
+  return int(mLabels.count());
+}
+
+/*!
+  Returns the number of successful calls to \ref find since the start of the application.
+
+  \see misses, hitRate
+*/
+qint64 QCPLabelCache::hits() const
+{
+  QMutexLocker locker(&mMutex);
+  return mHits;
+}
+
+/*!
+  Returns the number of calls to \ref find since the start of the application that didn't find a
+  label, so it had to be rendered anew.
+
+  \see hits, hitRate
+*/
+qint64 QCPLabelCache::misses() const
+{
+  QMutexLocker locker(&mMutex);
+  return mMisses;
+}
+
+/*!
+  Returns the fraction of calls to \ref find that found a label, between 0 and 1. If there were no
+  lookups yet, returns 0.
+
+  \see hits, misses
+*/
+double QCPLabelCache::hitRate() const
+{
+  QMutexLocker locker(&mMutex);
+  return mHits+mMisses > 0 ? mHits/double(mHits+mMisses) : 0.0;
+}
+
+/*!
+  Sets the maximum memory in \a bytes that the pixmaps of the cached labels may occupy. If the
+  cache currently holds more, the least recently used labels are discarded immediately. A limit of
+  0 effectively disables the cache.
+
+  \see memoryUsage
+*/
+void QCPLabelCache::setMemoryLimit(qint64 bytes)
+{
+  QMutexLocker locker(&mMutex);
+  mLabels.setMaxCost(int(qBound(qint64(0), bytes, qint64((std::numeric_limits<int>::max)()))));
+}
+
+/*!
+  Looks up the label with the given \a key and copies it to \a label. Returns false if no such
+  label is cached. A found label becomes the most recently used one.
+
+  The key must contain every parameter that affects the rendered pixmap, see \ref
+  QCPAxisPainterPrivate::generateLabelParameterHash.
+*/
+bool QCPLabelCache::find(const QByteArray &key, Label *label)
+{
+  QMutexLocker locker(&mMutex);
+  if (const Label *cached = mLabels.object(key))
+  {
+    *label = *cached; // the pixmap is implicitly shared, so this doesn't copy pixels
+    ++mHits;
+    return true;
+  }
+  ++mMisses;
+  return false;
+}
+
+/*!
+  Adds \a label under the given \a key, replacing a label with the same key. Labels that are larger
+  than \ref memoryLimit are not cached.
+*/
+void QCPLabelCache::insert(const QByteArray &key, const Label &label)
+{
+  const QSize size = label.pixmap.size();
+  const int cost = qMax(1, size.width()*size.height()*qMax(1, label.pixmap.depth())/8);
+  QMutexLocker locker(&mMutex);
+  mLabels.insert(key, new Label(label), cost);
+}
+
+/*!
+  Removes all labels from the cache. The hit counters are kept.
+*/
+void QCPLabelCache::clear()
+{
+  QMutexLocker locker(&mMutex);
+  mLabels.clear();
+}
+
+/* end of 'src/labelcache.cpp' */
+
+
 /* including file 'src/axis/labelpainter.cpp' */
 /* modified 2021-03-29T02:30:44, size 27296   */
 
@@ -5491,8 +6072,7 @@ QCPLabelPainterPrivate::QCPLabelPainterPrivate(QCustomPlot *parentPlot) :
   mSubstituteExponent(true),
   mMultiplicationSymbol(QChar(215)),
   mAbbreviateDecimalPowers(false),
-  mParentPlot(parentPlot),
-  mLabelCache(16)
+  mParentPlot(parentPlot)
 {
   analyzeFontMetrics();
 }
@@ -5560,16 +6140,6 @@ void QCPLabelPainterPrivate::setAbbreviateDecimalPowers(bool enabled)
   mAbbreviateDecimalPowers = enabled;
 }
 
-void QCPLabelPainterPrivate::setCacheSize(int labelCount)
-{
-  mLabelCache.setMaxCost(labelCount);
-}
-
-int QCPLabelPainterPrivate::cacheSize() const
-{
-  return mLabelCache.maxCost();
-}
-
 void QCPLabelPainterPrivate::drawTickLabel(QCPPainter *painter, const QPointF &tickPos, const QString &text)
 {
   double realRotation = mRotation;
@@ -5632,38 +6202,35 @@ int QCPLabelPainterPrivate::size() const
 
 /*! \internal
   
-  Clears the internal label cache. Upon the next \ref draw, all labels will be created new. This
-  method is called automatically if any parameters have changed that invalidate the cached labels,
-  such as font, color, etc. Usually you won't need to call this method manually.
+  Clears the shared \ref QCPLabelCache, so all labels will be created new. Since the cache keys
+  contain all parameters that affect a label (see \ref generateLabelParameterHash and \ref
+  cacheKey), this is never necessary for correct labels, it only frees memory.
 */
 void QCPLabelPainterPrivate::clearCache()
 {
-  mLabelCache.clear();
+  QCPLabelCache::instance()->clear();
 }
 
 /*! \internal
   
-  Returns a hash that allows uniquely identifying whether the label parameters have changed such
-  that the cached labels must be refreshed (\ref clearCache). It is used in \ref draw. If the
-  return value of this method hasn't changed since the last redraw, the respective label parameters
-  haven't changed and cached labels may be used.
+  Returns a hash of the label parameters that are the same for all labels of this painter, such as
+  font and number formatting. Together with \ref cacheKey, it forms the key of a label in the
+  shared \ref QCPLabelCache, so painters with equal parameters share their labels.
 */
 QByteArray QCPLabelPainterPrivate::generateLabelParameterHash() const
 {
-  QByteArray result;
-  result.append(QByteArray::number(mParentPlot->bufferDevicePixelRatio()));
-  result.append(QByteArray::number(mRotation));
-  //result.append(QByteArray::number((int)tickLabelSide)); TODO: check whether this is really a cache-invalidating property
-  result.append(QByteArray::number((int)mSubstituteExponent));
-  result.append(QString(mMultiplicationSymbol).toUtf8());
-  result.append(mColor.name().toLatin1()+QByteArray::number(mColor.alpha(), 16));
-  result.append(mFont.toString().toLatin1());
+  QByteArray result("labels;"); // distinguishes the keys from those of QCPAxisPainterPrivate
+  result.append(QByteArray::number(mParentPlot->bufferDevicePixelRatio())+';');
+  result.append(QByteArray::number((int)mSubstituteExponent)+';');
+  result.append(QByteArray::number((int)mAbbreviateDecimalPowers)+';');
+  result.append(QString(mMultiplicationSymbol).toUtf8()+';');
+  result.append(mFont.toString().toLatin1()+';');
   return result;
 }
 
 /*! \internal
   
-  Draws a single tick label with the provided \a painter, utilizing the internal label cache to
+  Draws a single tick label with the provided \a painter, utilizing the shared \ref QCPLabelCache to
   significantly speed up drawing of labels that were drawn in previous calls. The tick label is
   always bound to an axis, the distance to the axis is controllable via \a distanceToAxis in
   pixels. The pixel position in the axis direction is passed in the \a position parameter. Hence
@@ -5688,12 +6255,16 @@ void QCPLabelPainterPrivate::drawLabelMaybeCached(QCPPainter *painter, const QFo
 
   if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && !painter->modes().testFlag(QCPPainter::pmNoCaching)) // label caching enabled
   {
-    QByteArray key = cacheKey(text, color, rotation, side);
-    CachedLabel *cachedLabel = mLabelCache.take(QString::fromUtf8(key)); // attempt to take label from cache (don't use object() because we want ownership/prevent deletion during our operations, we re-insert it afterwards)
-    if (!cachedLabel)  // no cached label existed, create it
+    const QByteArray key = generateLabelParameterHash()+cacheKey(text, color, rotation, side);
+    QCPLabelCache::Label cachedLabel;
+    const bool cached = QCPLabelCache::instance()->find(key, &cachedLabel); // attempt to get label from the shared cache
+    if (QCPRenderProfiler *profiler = mParentPlot->renderProfiler())
+      profiler->addLabelCacheAccess(cached);
+    if (!cached)  // no cached label existed, create it
     {
       LabelData labelData = getTickLabelData(font, color, rotation, side, text);
       cachedLabel = createCachedLabel(labelData);
+      QCPLabelCache::instance()->insert(key, cachedLabel);
     }
     // if label would be partly clipped by widget border on sides, don't draw it (only for outside tick labels):
     bool labelClippedByBorder = false;
@@ -5708,10 +6279,9 @@ void QCPLabelPainterPrivate::drawLabelMaybeCached(QCPPainter *painter, const QFo
     */
     if (!labelClippedByBorder)
     {
-      painter->drawPixmap(pos+cachedLabel->offset, cachedLabel->pixmap);
-      finalSize = cachedLabel->pixmap.size()/mParentPlot->bufferDevicePixelRatio(); // TODO: collect this in a member rect list?
+      painter->drawPixmap(pos+cachedLabel.offset, cachedLabel.pixmap);
+      finalSize = cachedLabel.pixmap.size()/mParentPlot->bufferDevicePixelRatio(); // TODO: collect this in a member rect list?
     }
-    mLabelCache.insert(QString::fromUtf8(key), cachedLabel);
   } else // label caching disabled, draw text directly on surface:
   {
     LabelData labelData = getTickLabelData(font, color, rotation, side, text);
@@ -5954,31 +6524,33 @@ void QCPLabelPainterPrivate::getMaxTickLabelSize(const QFont &font, const QStrin
 }
 */
 
-QCPLabelPainterPrivate::CachedLabel *QCPLabelPainterPrivate::createCachedLabel(const LabelData &labelData) const
+QCPLabelCache::Label QCPLabelPainterPrivate::createCachedLabel(const LabelData &labelData) const
 {
-  CachedLabel *result = new CachedLabel;
+  QCPLabelCache::Label result;
   
   // allocate pixmap with the correct size and pixel ratio:
   if (!qFuzzyCompare(1.0, mParentPlot->bufferDevicePixelRatio()))
   {
-    result->pixmap = QPixmap(labelData.rotatedTotalBounds.size()*mParentPlot->bufferDevicePixelRatio());
+    result.pixmap = QPixmap(labelData.rotatedTotalBounds.size()*mParentPlot->bufferDevicePixelRatio());
 #ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
 #  ifdef QCP_DEVICEPIXELRATIO_FLOAT
-    result->pixmap.setDevicePixelRatio(mParentPlot->devicePixelRatioF());
+    result.pixmap.setDevicePixelRatio(mParentPlot->devicePixelRatioF());
 #  else
-    result->pixmap.setDevicePixelRatio(mParentPlot->devicePixelRatio());
+    result.pixmap.setDevicePixelRatio(mParentPlot->devicePixelRatio());
 #  endif
 #endif
   } else
-    result->pixmap = QPixmap(labelData.rotatedTotalBounds.size());
-  result->pixmap.fill(Qt::transparent);
+    result.pixmap = QPixmap(labelData.rotatedTotalBounds.size());
+  result.pixmap.fill(Qt::transparent);
   
   // draw the label into the pixmap
   // offset is between label anchor and topleft of cache pixmap, so pixmap can be drawn at pos+offset to make the label anchor appear at pos.
   // We use rotatedTotalBounds.topLeft() because rotatedTotalBounds is in a coordinate system where the label anchor is at (0, 0)
-  result->offset = labelData.rotatedTotalBounds.topLeft();
-  QCPPainter cachePainter(&result->pixmap);
-  drawText(&cachePainter, -result->offset, labelData);
+  result.offset = labelData.rotatedTotalBounds.topLeft();
+  {
+    QCPPainter cachePainter(&result.pixmap);
+    drawText(&cachePainter, -result.offset, labelData);
+  } // the painter must be finished before the pixmap is copied into the cache
   return result;
 }
 
@@ -9346,6 +9918,158 @@ double QCPAxis::coordToPixel(double value) const
   }
 }
 
+/*!
+  Transforms \a count values in \a coords, in coordinates of the axis, to pixel coordinates of the
+  QCustomPlot widget and writes them to \a pixels. The result is the same as calling \ref
+  coordToPixel for each value, but the scale type, range and axis rect are evaluated only once.
+
+  \a coordStride and \a pixelStride are the distances between consecutive values in \a coords and
+  \a pixels, in numbers of doubles (or floats, respectively). This allows converting the keys or
+  values of interleaved data directly into the x or y members of a QPointF array, e.g.:
+  \code
+  keyAxis->coordsToPixels(&data.constData()->key, &points.data()->rx(), data.size(), 2, 2);
+  \endcode
+  \a coords and \a pixels may refer to the same memory.
+
+  On x86 processors with AVX2, linear and logarithmic axes are transformed four values at a time if
+  both strides are 1 or both are 2. The instruction set is detected at runtime, other processors
+  and compilers use a portable loop.
+*/
+void QCPAxis::coordsToPixels(const double *coords, double *pixels, int count, int coordStride, int pixelStride) const
+{
+  if (count <= 0)
+    return;
+  const PixelTransform transform = pixelTransform();
+  int transformed = 0;
+#ifdef QCP_AVX2_DISPATCH
+  static const bool haveAvx2 = __builtin_cpu_supports("avx2");
+  if (haveAvx2)
+    transformed = transformCoordsAvx2(transform, coords, pixels, count, coordStride, pixelStride);
+#endif
+  transformCoords(transform, coords+transformed*coordStride, pixels+transformed*pixelStride, count-transformed, coordStride, pixelStride);
+}
+
+/*! \overload
+
+  This overload writes single precision \a pixels, e.g. for QPointF on platforms where qreal is
+  float. It always uses the portable loop.
+*/
+void QCPAxis::coordsToPixels(const double *coords, float *pixels, int count, int coordStride, int pixelStride) const
+{
+  if (count > 0)
+    transformCoords(pixelTransform(), coords, pixels, count, coordStride, pixelStride);
+}
+
+/*! \internal
+
+  Returns the current mapping from axis coordinates to pixels in the form used by \ref
+  coordsToPixels. It reproduces \ref coordToPixel, including the placement of values that are
+  invalid on a logarithmic axis outside the axis rect.
+*/
+QCPAxis::PixelTransform QCPAxis::pixelTransform() const
+{
+  PixelTransform transform;
+  const bool horizontal = orientation() == Qt::Horizontal;
+  const double extent = horizontal ? mAxisRect->width() : -mAxisRect->height(); // vertical pixel coordinates grow downwards
+  transform.logarithmic = mScaleType == stLogarithmic;
+  transform.negativeRange = mRange.upper < 0.0;
+  transform.origin = mRangeReversed ? mRange.upper : mRange.lower;
+  transform.scale = (mRangeReversed ? -extent : extent)/(transform.logarithmic ? qLn(mRange.upper/mRange.lower) : mRange.size());
+  transform.offset = horizontal ? mAxisRect->left() : mAxisRect->bottom();
+  if (horizontal)
+    transform.invalidPixel = transform.negativeRange != mRangeReversed ? mAxisRect->right()+200 : mAxisRect->left()-200;
+  else
+    transform.invalidPixel = transform.negativeRange != mRangeReversed ? mAxisRect->top()-200 : mAxisRect->bottom()+200;
+  return transform;
+}
+
+/*! \internal
+
+  Applies \a transform to \a count coordinates. This is the portable implementation of \ref
+  coordsToPixels and also handles the points the vectorized implementation leaves over.
+*/
+template <typename PixelType>
+void QCPAxis::transformCoords(const PixelTransform &transform, const double *coords, PixelType *pixels, int count, int coordStride, int pixelStride)
+{
+  if (!transform.logarithmic)
+  {
+    for (int i=0; i<count; ++i)
+      pixels[i*pixelStride] = PixelType((coords[i*coordStride]-transform.origin)*transform.scale+transform.offset);
+  } else
+  {
+    for (int i=0; i<count; ++i)
+    {
+      const double coord = coords[i*coordStride];
+      if (transform.negativeRange ? coord >= 0.0 : coord <= 0.0) // invalid value for logarithmic scale, just draw it outside visible range
+        pixels[i*pixelStride] = PixelType(transform.invalidPixel);
+      else
+        pixels[i*pixelStride] = PixelType(qLn(coord/transform.origin)*transform.scale+transform.offset);
+    }
+  }
+}
+
+#ifdef QCP_AVX2_DISPATCH
+/*! \internal
+
+  Applies \a transform to groups of four coordinates with AVX2 instructions. Only contiguous
+  arrays and arrays of coordinate pairs (stride 2 for both \a coords and \a pixels) are supported.
+  Natural logarithms are evaluated with a series that agrees with qLn to about 1e-13 relative
+  error (see \c qcpLnAvx2), so the pixels match \ref coordToPixel far below the resolution of any
+  paint device.
+
+  Returns the number of coordinates that were transformed, the remaining ones must be passed to
+  \ref transformCoords. This method may only be called if the CPU supports AVX2.
+*/
+__attribute__((target("avx2")))
+int QCPAxis::transformCoordsAvx2(const PixelTransform &transform, const double *coords, double *pixels, int count, int coordStride, int pixelStride)
+{
+  const bool interleaved = coordStride == 2 && pixelStride == 2; // e.g. keys of QCPGraphData to x of QPointF
+  if (!interleaved && (coordStride != 1 || pixelStride != 1))
+    return 0;
+  const __m256d origin = _mm256_set1_pd(transform.origin);
+  const __m256d scale = _mm256_set1_pd(transform.scale);
+  const __m256d offset = _mm256_set1_pd(transform.offset);
+  const __m256d invalidPixel = _mm256_set1_pd(transform.invalidPixel);
+  const __m256d zero = _mm256_setzero_pd();
+  const int end = interleaved ? count-4 : count-3; // interleaved loads and stores reach one element past the fourth point
+  int i = 0;
+  for (; i<end; i+=4)
+  {
+    __m256d coord;
+    if (interleaved)
+      coord = _mm256_unpacklo_pd(_mm256_loadu_pd(coords+2*i), _mm256_loadu_pd(coords+2*i+4)); // points in order 0, 2, 1, 3
+    else
+      coord = _mm256_loadu_pd(coords+i);
+    
+    __m256d pixel;
+    if (!transform.logarithmic)
+      pixel = _mm256_add_pd(_mm256_mul_pd(_mm256_sub_pd(coord, origin), scale), offset);
+    else
+    {
+      const __m256d ratio = _mm256_div_pd(coord, origin);
+      const __m256d invalid = transform.negativeRange ? _mm256_cmp_pd(coord, zero, _CMP_GE_OQ) : _mm256_cmp_pd(coord, zero, _CMP_LE_OQ);
+      const __m256d normal = _mm256_and_pd(_mm256_cmp_pd(ratio, _mm256_set1_pd(std::numeric_limits<double>::min()), _CMP_GE_OQ),
+                                           _mm256_cmp_pd(ratio, _mm256_set1_pd(std::numeric_limits<double>::max()), _CMP_LE_OQ));
+      if (_mm256_movemask_pd(_mm256_or_pd(invalid, normal)) != 0xF) // NaN, infinite or denormal ratios are left to qLn
+      {
+        transformCoords(transform, coords+i*coordStride, pixels+i*pixelStride, 4, coordStride, pixelStride);
+        continue;
+      }
+      pixel = _mm256_blendv_pd(_mm256_add_pd(_mm256_mul_pd(qcpLnAvx2(ratio), scale), offset), invalidPixel, invalid);
+    }
+    
+    if (interleaved)
+    {
+      double *target = pixels+2*i;
+      _mm256_storeu_pd(target, _mm256_blend_pd(_mm256_loadu_pd(target), _mm256_unpacklo_pd(pixel, pixel), 0x5));
+      _mm256_storeu_pd(target+4, _mm256_blend_pd(_mm256_loadu_pd(target+4), _mm256_unpackhi_pd(pixel, pixel), 0x5));
+    } else
+      _mm256_storeu_pd(pixels+i, pixel);
+  }
+  return i;
+}
+#endif
+
 /*!
   Returns the part of the axis that is hit by \a pos (in pixels). The return value of this function
   is independent of the user-selectable parts defined with \ref setSelectableParts. Further, this
@@ -9912,8 +10636,7 @@ QCPAxisPainterPrivate::QCPAxisPainterPrivate(QCustomPlot *parentPlot) :
   offset(0),
   abbreviateDecimalPowers(false),
   reversedEndings(false),
-  mParentPlot(parentPlot),
-  mLabelCache(16) // cache at most 16 (tick) labels
+  mParentPlot(parentPlot)
 {
 }
 
@@ -9930,12 +10653,7 @@ QCPAxisPainterPrivate::~QCPAxisPainterPrivate()
 */
 void QCPAxisPainterPrivate::draw(QCPPainter *painter)
 {
-  QByteArray newHash = generateLabelParameterHash();
-  if (newHash != mLabelParameterHash)
-  {
-    mLabelCache.clear();
-    mLabelParameterHash = newHash;
-  }
+  mLabelParameterHash = generateLabelParameterHash();
   
   QPoint origin;
   switch (type)
@@ -10125,12 +10843,7 @@ int QCPAxisPainterPrivate::size()
 {
   int result = 0;
 
-  QByteArray newHash = generateLabelParameterHash();
-  if (newHash != mLabelParameterHash)
-  {
-    mLabelCache.clear();
-    mLabelParameterHash = newHash;
-  }
+  mLabelParameterHash = generateLabelParameterHash();
   
   // get length of tick marks pointing outwards:
   if (!tickPositions.isEmpty())
@@ -10163,39 +10876,41 @@ int QCPAxisPainterPrivate::size()
 
 /*! \internal
   
-  Clears the internal label cache. Upon the next \ref draw, all labels will be created new. This
-  method is called automatically in \ref draw, if any parameters have changed that invalidate the
-  cached labels, such as font, color, etc.
+  Clears the shared \ref QCPLabelCache, so upon the next \ref draw, all labels will be created
+  new. Since the cache keys contain all parameters that affect a label (see \ref
+  generateLabelParameterHash), this is never necessary for correct labels, it only frees memory.
 */
 void QCPAxisPainterPrivate::clearCache()
 {
-  mLabelCache.clear();
+  QCPLabelCache::instance()->clear();
 }
 
 /*! \internal
   
-  Returns a hash that allows uniquely identifying whether the label parameters have changed such
-  that the cached labels must be refreshed (\ref clearCache). It is used in \ref draw. If the
-  return value of this method hasn't changed since the last redraw, the respective label parameters
-  haven't changed and cached labels may be used.
+  Returns a hash of all parameters besides the text that affect the appearance of a tick label. It
+  is computed once in \ref draw and \ref size and prefixed to the label texts to form their keys in
+  the shared \ref QCPLabelCache. Axes with equal parameters thus share their labels, also across
+  different QCustomPlot instances.
 */
 QByteArray QCPAxisPainterPrivate::generateLabelParameterHash() const
 {
-  QByteArray result;
-  result.append(QByteArray::number(mParentPlot->bufferDevicePixelRatio()));
-  result.append(QByteArray::number(tickLabelRotation));
-  result.append(QByteArray::number(int(tickLabelSide)));
-  result.append(QByteArray::number(int(substituteExponent)));
-  result.append(QByteArray::number(int(numberMultiplyCross)));
-  result.append(tickLabelColor.name().toLatin1()+QByteArray::number(tickLabelColor.alpha(), 16));
-  result.append(tickLabelFont.toString().toLatin1());
+  QByteArray result("axis;"); // distinguishes the keys from those of QCPLabelPainterPrivate
+  result.append(QByteArray::number(int(type))+';');
+  result.append(QByteArray::number(mParentPlot->bufferDevicePixelRatio())+';');
+  result.append(QByteArray::number(tickLabelRotation)+';');
+  result.append(QByteArray::number(int(tickLabelSide))+';');
+  result.append(QByteArray::number(int(substituteExponent))+';');
+  result.append(QByteArray::number(int(numberMultiplyCross))+';');
+  result.append(QByteArray::number(int(abbreviateDecimalPowers))+';');
+  result.append(tickLabelColor.name().toLatin1()+QByteArray::number(tickLabelColor.alpha(), 16)+';');
+  result.append(tickLabelFont.toString().toLatin1()+';');
   return result;
 }
 
 /*! \internal
   
-  Draws a single tick label with the provided \a painter, utilizing the internal label cache to
-  significantly speed up drawing of labels that were drawn in previous calls. The tick label is
+  Draws a single tick label with the provided \a painter, utilizing the shared \ref QCPLabelCache
+  to significantly speed up drawing of labels that were drawn in previous calls. The tick label is
   always bound to an axis, the distance to the axis is controllable via \a distanceToAxis in
   pixels. The pixel position in the axis direction is passed in the \a position parameter. Hence
   for the bottom axis, \a position would indicate the horizontal pixel position (not coordinate),
@@ -10226,44 +10941,49 @@ void QCPAxisPainterPrivate::placeTickLabel(QCPPainter *painter, double position,
   }
   if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && !painter->modes().testFlag(QCPPainter::pmNoCaching)) // label caching enabled
   {
-    CachedLabel *cachedLabel = mLabelCache.take(text); // attempt to get label from cache
-    if (!cachedLabel)  // no cached label existed, create it
+    const QByteArray key = mLabelParameterHash+text.toUtf8();
+    QCPLabelCache::Label cachedLabel;
+    const bool cached = QCPLabelCache::instance()->find(key, &cachedLabel); // attempt to get label from the shared cache
+    if (QCPRenderProfiler *profiler = mParentPlot->renderProfiler())
+      profiler->addLabelCacheAccess(cached);
+    if (!cached)  // no cached label existed, create it
     {
-      cachedLabel = new CachedLabel;
       TickLabelData labelData = getTickLabelData(painter->font(), text);
-      cachedLabel->offset = getTickLabelDrawOffset(labelData)+labelData.rotatedTotalBounds.topLeft();
+      cachedLabel.offset = getTickLabelDrawOffset(labelData)+labelData.rotatedTotalBounds.topLeft();
       if (!qFuzzyCompare(1.0, mParentPlot->bufferDevicePixelRatio()))
       {
-        cachedLabel->pixmap = QPixmap(labelData.rotatedTotalBounds.size()*mParentPlot->bufferDevicePixelRatio());
+        cachedLabel.pixmap = QPixmap(labelData.rotatedTotalBounds.size()*mParentPlot->bufferDevicePixelRatio());
 #ifdef QCP_DEVICEPIXELRATIO_SUPPORTED
 #  ifdef QCP_DEVICEPIXELRATIO_FLOAT
-        cachedLabel->pixmap.setDevicePixelRatio(mParentPlot->devicePixelRatioF());
+        cachedLabel.pixmap.setDevicePixelRatio(mParentPlot->devicePixelRatioF());
 #  else
-        cachedLabel->pixmap.setDevicePixelRatio(mParentPlot->devicePixelRatio());
+        cachedLabel.pixmap.setDevicePixelRatio(mParentPlot->devicePixelRatio());
 #  endif
 #endif
       } else
-        cachedLabel->pixmap = QPixmap(labelData.rotatedTotalBounds.size());
-      cachedLabel->pixmap.fill(Qt::transparent);
-      QCPPainter cachePainter(&cachedLabel->pixmap);
-      cachePainter.setPen(painter->pen());
-      drawTickLabel(&cachePainter, -labelData.rotatedTotalBounds.topLeft().x(), -labelData.rotatedTotalBounds.topLeft().y(), labelData);
+        cachedLabel.pixmap = QPixmap(labelData.rotatedTotalBounds.size());
+      cachedLabel.pixmap.fill(Qt::transparent);
+      {
+        QCPPainter cachePainter(&cachedLabel.pixmap);
+        cachePainter.setPen(painter->pen());
+        drawTickLabel(&cachePainter, -labelData.rotatedTotalBounds.topLeft().x(), -labelData.rotatedTotalBounds.topLeft().y(), labelData);
+      } // the painter must be finished before the pixmap is shared with the cache
+      QCPLabelCache::instance()->insert(key, cachedLabel);
     }
     // if label would be partly clipped by widget border on sides, don't draw it (only for outside tick labels):
     bool labelClippedByBorder = false;
     if (tickLabelSide == QCPAxis::lsOutside)
     {
       if (QCPAxis::orientation(type) == Qt::Horizontal)
-        labelClippedByBorder = labelAnchor.x()+cachedLabel->offset.x()+cachedLabel->pixmap.width()/mParentPlot->bufferDevicePixelRatio() > viewportRect.right() || labelAnchor.x()+cachedLabel->offset.x() < viewportRect.left();
+        labelClippedByBorder = labelAnchor.x()+cachedLabel.offset.x()+cachedLabel.pixmap.width()/mParentPlot->bufferDevicePixelRatio() > viewportRect.right() || labelAnchor.x()+cachedLabel.offset.x() < viewportRect.left();
       else
-        labelClippedByBorder = labelAnchor.y()+cachedLabel->offset.y()+cachedLabel->pixmap.height()/mParentPlot->bufferDevicePixelRatio() > viewportRect.bottom() || labelAnchor.y()+cachedLabel->offset.y() < viewportRect.top();
+        labelClippedByBorder = labelAnchor.y()+cachedLabel.offset.y()+cachedLabel.pixmap.height()/mParentPlot->bufferDevicePixelRatio() > viewportRect.bottom() || labelAnchor.y()+cachedLabel.offset.y() < viewportRect.top();
     }
     if (!labelClippedByBorder)
     {
-      painter->drawPixmap(labelAnchor+cachedLabel->offset, cachedLabel->pixmap);
-      finalSize = cachedLabel->pixmap.size()/mParentPlot->bufferDevicePixelRatio();
+      painter->drawPixmap(labelAnchor+cachedLabel.offset, cachedLabel.pixmap);
+      finalSize = cachedLabel.pixmap.size()/mParentPlot->bufferDevicePixelRatio();
     }
-    mLabelCache.insert(text, cachedLabel); // return label to cache or insert for the first time if newly created
   } else // label caching disabled, draw text directly on surface:
   {
     TickLabelData labelData = getTickLabelData(painter->font(), text);
@@ -10526,10 +11246,10 @@ void QCPAxisPainterPrivate::getMaxTickLabelSize(const QFont &font, const QString
 {
   // note: this function must return the same tick label sizes as the placeTickLabel function.
   QSize finalSize;
-  if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && mLabelCache.contains(text)) // label caching enabled and have cached label
+  QCPLabelCache::Label cachedLabel;
+  if (mParentPlot->plottingHints().testFlag(QCP::phCacheLabels) && QCPLabelCache::instance()->find(mLabelParameterHash+text.toUtf8(), &cachedLabel)) // label caching enabled and have cached label
   {
-    const CachedLabel *cachedLabel = mLabelCache.object(text);
-    finalSize = cachedLabel->pixmap.size()/mParentPlot->bufferDevicePixelRatio();
+    finalSize = cachedLabel.pixmap.size()/mParentPlot->bufferDevicePixelRatio();
   } else // label caching disabled or no label with this text cached:
   {
     TickLabelData labelData = getTickLabelData(font, text);
@@ -11018,6 +11738,200 @@ void QCPScatterStyle::drawShape(QCPPainter *painter, double x, double y) const
 /* end of 'src/scatterstyle.cpp' */
 
 
+/* including file 'src/datacontainer.cpp'  */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPRangeIndex
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPRangeIndex
+  \brief Segment tree over the value ranges of consecutive blocks of data points
+
+  This class is used internally by \ref QCPDataContainer when its range index is enabled (\ref
+  QCPDataContainer::setRangeIndex). The data points of the container are grouped into blocks of
+  \ref blockSize consecutive points. For each block, the smallest lower and the largest upper value
+  bound is stored, separately for each \ref QCP::SignDomain. On top of the blocks, a segment tree
+  allows querying the value range spanned by any sequence of blocks in logarithmic time.
+
+  Blocks without any valid (non-NaN) value bound hold positive infinity as lower and negative
+  infinity as upper bound, so they don't contribute to query results.
+*/
+
+const int QCPRangeIndex::blockSize;
+
+/*!
+  Creates an empty range index.
+*/
+QCPRangeIndex::QCPRangeIndex() :
+  mBlockCount(0),
+  mLeafCount(0)
+{
+}
+
+/*!
+  Sets the number of blocks covered by this index to \a blockCount. The values of blocks that
+  existed before are kept, newly added blocks are empty. If the capacity of the tree needs to grow,
+  all inner nodes are rebuilt, otherwise only \ref updateNodes needs to be called for the changed
+  blocks.
+*/
+void QCPRangeIndex::resize(int blockCount)
+{
+  if (blockCount > mLeafCount)
+  {
+    int newLeafCount = qMax(1, mLeafCount);
+    while (newLeafCount < blockCount)
+      newLeafCount *= 2;
+    for (int domain=0; domain<3; ++domain)
+    {
+      QVector<double> lower(2*newLeafCount, std::numeric_limits<double>::infinity());
+      QVector<double> upper(2*newLeafCount, -std::numeric_limits<double>::infinity());
+      for (int i=0; i<mBlockCount; ++i)
+      {
+        lower[newLeafCount+i] = mLower[domain].at(mLeafCount+i);
+        upper[newLeafCount+i] = mUpper[domain].at(mLeafCount+i);
+      }
+      for (int i=newLeafCount-1; i>0; --i)
+      {
+        lower[i] = qMin(lower.at(2*i), lower.at(2*i+1));
+        upper[i] = qMax(upper.at(2*i), upper.at(2*i+1));
+      }
+      mLower[domain] = lower;
+      mUpper[domain] = upper;
+    }
+    mLeafCount = newLeafCount;
+  } else if (blockCount < mBlockCount)
+  {
+    const double empty[3] = {std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity(), std::numeric_limits<double>::infinity()};
+    const double emptyUpper[3] = {-std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity(), -std::numeric_limits<double>::infinity()};
+    for (int i=blockCount; i<mBlockCount; ++i)
+      setBlock(i, empty, emptyUpper);
+    const int removedBlock = blockCount;
+    mBlockCount = blockCount;
+    if (removedBlock < mLeafCount)
+    {
+      // propagate the emptied leaves to the inner nodes:
+      int first = (mLeafCount+removedBlock)/2;
+      int last = (2*mLeafCount-1)/2;
+      while (first > 0)
+      {
+        for (int node=first; node<=last; ++node)
+        {
+          for (int domain=0; domain<3; ++domain)
+          {
+            mLower[domain][node] = qMin(mLower[domain].at(2*node), mLower[domain].at(2*node+1));
+            mUpper[domain][node] = qMax(mUpper[domain].at(2*node), mUpper[domain].at(2*node+1));
+          }
+        }
+        first /= 2;
+        last /= 2;
+      }
+    }
+    return;
+  }
+  mBlockCount = blockCount;
+}
+
+/*!
+  Removes all blocks and frees the memory of the index.
+*/
+void QCPRangeIndex::clear()
+{
+  mBlockCount = 0;
+  mLeafCount = 0;
+  for (int domain=0; domain<3; ++domain)
+  {
+    mLower[domain].clear();
+    mUpper[domain].clear();
+  }
+}
+
+/*!
+  Sets the value bounds of the block with index \a block. \a lower and \a upper must point to
+  three values each, indexed by \ref QCP::SignDomain.
+
+  Only the leaf of the tree is changed, call \ref updateNodes afterwards to propagate the change
+  to the inner nodes.
+*/
+void QCPRangeIndex::setBlock(int block, const double *lower, const double *upper)
+{
+  if (block < 0 || block >= mLeafCount)
+    return;
+  for (int domain=0; domain<3; ++domain)
+  {
+    mLower[domain][mLeafCount+block] = lower[domain];
+    mUpper[domain][mLeafCount+block] = upper[domain];
+  }
+}
+
+/*!
+  Recalculates all inner nodes of the tree which depend on the blocks with index \a firstBlock
+  and higher. The cost is proportional to the number of those blocks plus the height of the tree.
+*/
+void QCPRangeIndex::updateNodes(int firstBlock)
+{
+  if (mBlockCount == 0 || firstBlock >= mBlockCount)
+    return;
+  int first = (mLeafCount+qMax(0, firstBlock))/2;
+  int last = (mLeafCount+mBlockCount-1)/2;
+  while (first > 0)
+  {
+    for (int node=first; node<=last; ++node)
+    {
+      for (int domain=0; domain<3; ++domain)
+      {
+        mLower[domain][node] = qMin(mLower[domain].at(2*node), mLower[domain].at(2*node+1));
+        mUpper[domain][node] = qMax(mUpper[domain].at(2*node), mUpper[domain].at(2*node+1));
+      }
+    }
+    first /= 2;
+    last /= 2;
+  }
+}
+
+/*!
+  Returns the value range spanned by the blocks \a firstBlock up to (excluding) \a endBlock,
+  restricted to the sign domain \a signDomain.
+
+  \a haveLower and \a haveUpper are set to whether a valid lower and upper bound was found in the
+  requested blocks. If not, the respective bound of the returned range is meaningless.
+*/
+QCPRange QCPRangeIndex::query(int firstBlock, int endBlock, QCP::SignDomain signDomain, bool &haveLower, bool &haveUpper) const
+{
+  double lower = std::numeric_limits<double>::infinity();
+  double upper = -std::numeric_limits<double>::infinity();
+  const QVector<double> &lowerTree = mLower[signDomain];
+  const QVector<double> &upperTree = mUpper[signDomain];
+  int left = qMax(0, firstBlock)+mLeafCount;
+  int right = qMin(mBlockCount, endBlock)+mLeafCount;
+  while (left < right)
+  {
+    if (left & 1)
+    {
+      lower = qMin(lower, lowerTree.at(left));
+      upper = qMax(upper, upperTree.at(left));
+      ++left;
+    }
+    if (right & 1)
+    {
+      --right;
+      lower = qMin(lower, lowerTree.at(right));
+      upper = qMax(upper, upperTree.at(right));
+    }
+    left /= 2;
+    right /= 2;
+  }
+  QCPRange result; // not constructed with bounds, since a missing bound must not cause normalization
+  haveLower = lower != std::numeric_limits<double>::infinity();
+  haveUpper = upper != -std::numeric_limits<double>::infinity();
+  if (haveLower)
+    result.lower = lower;
+  if (haveUpper)
+    result.upper = upper;
+  return result;
+}
+/* end of 'src/datacontainer.cpp' */
+
+
 /* including file 'src/plottable.cpp'       */
 /* modified 2021-03-29T02:30:44, size 38818 */
 
@@ -13261,6 +14175,614 @@ QCP::Interaction QCPAbstractItem::selectionCategory() const
 /* end of 'src/item.cpp' */
 
 
+/* including file 'src/renderprofiler.cpp' */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPRenderProfiler
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPRenderProfiler
+  \brief Records where the time of each replot is spent
+
+  A render profiler is created by \ref QCustomPlot::setRenderProfiling and is then accessible via
+  \ref QCustomPlot::renderProfiler. During every frame, i.e. every \ref QCustomPlot::replot and
+  every partial repaint of single layers (see \ref QCustomPlot::replotGraph), it records:
+
+  \li the time spent in each \ref Stage for every graph, together with the number of data points
+  in the visible range and the number of pixel points that were handed to the painter,
+  \li the time it took to draw each layer,
+  \li how many tick labels were taken from the shared \ref QCPLabelCache and how many had to be
+  rendered anew (only if \ref QCP::phCacheLabels is set).
+
+  \ref summary and \ref toJson additionally report the state of the \ref QCPLabelCache, i.e. its
+  hit rate since the start of the application, the number of cached labels and their memory.
+
+  When a frame is complete, \ref QCustomPlot::frameProfiled is emitted and the results can be
+  retrieved with the getters, as human-readable \ref summary, or as single-line JSON object with
+  \ref toJson, e.g. to append it to a log file.
+
+  Stage times of graphs that are prepared concurrently (see \ref QCP::phParallelPreparation) are
+  measured in the worker threads, so the sum of all stage times may exceed the frame time.
+*/
+
+const int QCPRenderProfiler::stageCount;
+
+/*!
+  Creates a render profiler without any recorded frames.
+*/
+QCPRenderProfiler::QCPRenderProfiler() :
+  mFrameCount(0)
+{
+  mCurrentFrame.time = mLastFrame.time = 0;
+  mCurrentFrame.labelCacheHits = mLastFrame.labelCacheHits = 0;
+  mCurrentFrame.labelCacheMisses = mLastFrame.labelCacheMisses = 0;
+}
+
+/*!
+  Returns the number of frames that were completed since the profiler was created.
+*/
+qint64 QCPRenderProfiler::frameCount() const
+{
+  QMutexLocker locker(&mMutex);
+  return mFrameCount;
+}
+
+/*!
+  Returns the time in milliseconds the last completed frame took.
+*/
+double QCPRenderProfiler::frameTime() const
+{
+  QMutexLocker locker(&mMutex);
+  return mLastFrame.time;
+}
+
+/*!
+  Returns what was recorded for each graph during the last completed frame, in the order the
+  graphs were first encountered.
+*/
+QVector<QCPRenderProfiler::PlottableProfile> QCPRenderProfiler::plottableProfiles() const
+{
+  QMutexLocker locker(&mMutex);
+  return mLastFrame.plottables;
+}
+
+/*!
+  Returns the drawing times of the layers that were drawn during the last completed frame, in
+  drawing order.
+*/
+QVector<QCPRenderProfiler::LayerProfile> QCPRenderProfiler::layerProfiles() const
+{
+  QMutexLocker locker(&mMutex);
+  return mLastFrame.layers;
+}
+
+/*!
+  Returns how many tick labels were taken from a label cache during the last completed frame.
+
+  \see labelCacheMisses
+*/
+int QCPRenderProfiler::labelCacheHits() const
+{
+  QMutexLocker locker(&mMutex);
+  return mLastFrame.labelCacheHits;
+}
+
+/*!
+  Returns how many tick labels had to be rendered and inserted into a label cache during the last
+  completed frame.
+
+  \see labelCacheHits
+*/
+int QCPRenderProfiler::labelCacheMisses() const
+{
+  QMutexLocker locker(&mMutex);
+  return mLastFrame.labelCacheMisses;
+}
+
+/*! \internal
+
+  Starts recording a new frame. Called by QCustomPlot before anything is drawn.
+*/
+void QCPRenderProfiler::beginFrame()
+{
+  QMutexLocker locker(&mMutex);
+  mCurrentFrame.time = 0;
+  mCurrentFrame.plottables.clear();
+  mCurrentFrame.layers.clear();
+  mCurrentFrame.labelCacheHits = 0;
+  mCurrentFrame.labelCacheMisses = 0;
+  mPlottableIndices.clear();
+}
+
+/*! \internal
+
+  Completes the frame started with \ref beginFrame, which took \a frameTime milliseconds in total.
+  Its results are then returned by the getters.
+*/
+void QCPRenderProfiler::endFrame(double frameTime)
+{
+  QMutexLocker locker(&mMutex);
+  mCurrentFrame.time = frameTime;
+  mLastFrame = mCurrentFrame;
+  ++mFrameCount;
+}
+
+/*!
+  Adds the time that elapsed on \a timer to the \a stage of \a plottable in the current frame, and
+  restarts \a timer so it can be passed again for the following stage.
+
+  This method is thread-safe.
+*/
+void QCPRenderProfiler::addStageTime(const QCPAbstractPlottable *plottable, Stage stage, QElapsedTimer &timer)
+{
+  const double time = timer.nsecsElapsed()*1e-6;
+  QMutexLocker locker(&mMutex);
+  plottableProfile(plottable).stageTime[stage] += time;
+  locker.unlock();
+  timer.start();
+}
+
+/*!
+  Adds \a inputPoints data points and \a emittedPoints pixel points to the counts of \a plottable
+  in the current frame.
+
+  This method is thread-safe.
+*/
+void QCPRenderProfiler::addPointCounts(const QCPAbstractPlottable *plottable, int inputPoints, int emittedPoints)
+{
+  QMutexLocker locker(&mMutex);
+  PlottableProfile &profile = plottableProfile(plottable);
+  profile.inputPoints += inputPoints;
+  profile.emittedPoints += emittedPoints;
+}
+
+/*! \internal
+
+  Records that drawing \a layer took \a time milliseconds in the current frame.
+*/
+void QCPRenderProfiler::addLayerTime(const QCPLayer *layer, double time)
+{
+  LayerProfile profile;
+  profile.name = layer->name();
+  profile.time = time;
+  QMutexLocker locker(&mMutex);
+  mCurrentFrame.layers.append(profile);
+}
+
+/*! \internal
+
+  Records a lookup in a tick label cache, which was successful if \a hit is true.
+*/
+void QCPRenderProfiler::addLabelCacheAccess(bool hit)
+{
+  QMutexLocker locker(&mMutex);
+  if (hit)
+    ++mCurrentFrame.labelCacheHits;
+  else
+    ++mCurrentFrame.labelCacheMisses;
+}
+
+/*!
+  Returns a multi-line, human-readable report of the last completed frame, suitable for showing
+  it on top of the plot.
+
+  \see toJson
+*/
+QString QCPRenderProfiler::summary() const
+{
+  const QCPLabelCache *labelCache = QCPLabelCache::instance();
+  QMutexLocker locker(&mMutex);
+  QString result = QString(QLatin1String("Frame %1: %2 ms, labels cached %3/%4"))
+      .arg(mFrameCount).arg(mLastFrame.time, 0, 'f', 2)
+      .arg(mLastFrame.labelCacheHits).arg(mLastFrame.labelCacheHits+mLastFrame.labelCacheMisses);
+  result += QString(QLatin1String("\nlabel cache: %1% hits, %2 labels, %3 of %4 kB"))
+      .arg(labelCache->hitRate()*100, 0, 'f', 1).arg(labelCache->count())
+      .arg(labelCache->memoryUsage()/1024).arg(labelCache->memoryLimit()/1024);
+  foreach (const LayerProfile &layer, mLastFrame.layers)
+    result += QLatin1String("\nlayer ") + layer.name + QString(QLatin1String(": %1 ms")).arg(layer.time, 0, 'f', 2);
+  foreach (const PlottableProfile &plottable, mLastFrame.plottables)
+  {
+    result += QLatin1String("\n") + plottable.name + QString(QLatin1String(": range %1, sampling %2, pixels %3, painting %4 ms, %5 -> %6 points"))
+        .arg(plottable.stageTime[stVisibleRange], 0, 'f', 2)
+        .arg(plottable.stageTime[stSampling], 0, 'f', 2)
+        .arg(plottable.stageTime[stTransform], 0, 'f', 2)
+        .arg(plottable.stageTime[stPainting], 0, 'f', 2)
+        .arg(plottable.inputPoints).arg(plottable.emittedPoints);
+  }
+  return result;
+}
+
+/*!
+  Returns the last completed frame as JSON object on a single line, so multiple frames can be
+  appended to a log file with one frame per line. Times are in milliseconds. Example (wrapped for
+  readability):
+
+  \code
+  {"frame":12,"time":4.1,"labelCacheHits":14,"labelCacheMisses":0,
+   "labelCache":{"hitRate":0.97,"count":230,"memory":412160,"memoryLimit":16777216},
+   "layers":[{"name":"main","time":3.6}],
+   "plottables":[{"name":"Graph 1","visibleRange":0.01,"sampling":1.2,"transform":0.3,
+                  "painting":1.9,"inputPoints":1000000,"emittedPoints":2400}]}
+  \endcode
+
+  \see summary
+*/
+QString QCPRenderProfiler::toJson() const
+{
+  QMutexLocker locker(&mMutex);
+  const auto quoted = [](const QString &text) -> QString
+  {
+    QString result = text;
+    result.replace(QLatin1Char('\\'), QLatin1String("\\\\")).replace(QLatin1Char('"'), QLatin1String("\\\""));
+    result.replace(QLatin1Char('\n'), QLatin1String("\\n")).replace(QLatin1Char('\t'), QLatin1String("\\t"));
+    return QString(QLatin1Char('"')) + result + QString(QLatin1Char('"'));
+  };
+  const QCPLabelCache *labelCache = QCPLabelCache::instance();
+  QString result = QString(QLatin1String("{\"frame\":%1,\"time\":%2,\"labelCacheHits\":%3,\"labelCacheMisses\":%4,"))
+      .arg(mFrameCount).arg(mLastFrame.time).arg(mLastFrame.labelCacheHits).arg(mLastFrame.labelCacheMisses);
+  result += QString(QLatin1String("\"labelCache\":{\"hitRate\":%1,\"count\":%2,\"memory\":%3,\"memoryLimit\":%4},\"layers\":["))
+      .arg(labelCache->hitRate()).arg(labelCache->count()).arg(labelCache->memoryUsage()).arg(labelCache->memoryLimit());
+  for (int i=0; i<mLastFrame.layers.size(); ++i)
+  {
+    const LayerProfile &layer = mLastFrame.layers.at(i);
+    if (i > 0)
+      result += QLatin1Char(',');
+    result += QLatin1String("{\"name\":") + quoted(layer.name) + QString(QLatin1String(",\"time\":%1}")).arg(layer.time);
+  }
+  result += QLatin1String("],\"plottables\":[");
+  for (int i=0; i<mLastFrame.plottables.size(); ++i)
+  {
+    const PlottableProfile &plottable = mLastFrame.plottables.at(i);
+    if (i > 0)
+      result += QLatin1Char(',');
+    result += QLatin1String("{\"name\":") + quoted(plottable.name)
+        + QString(QLatin1String(",\"visibleRange\":%1,\"sampling\":%2,\"transform\":%3,\"painting\":%4,\"inputPoints\":%5,\"emittedPoints\":%6}"))
+        .arg(plottable.stageTime[stVisibleRange]).arg(plottable.stageTime[stSampling])
+        .arg(plottable.stageTime[stTransform]).arg(plottable.stageTime[stPainting])
+        .arg(plottable.inputPoints).arg(plottable.emittedPoints);
+  }
+  result += QLatin1String("]}");
+  return result;
+}
+
+/*! \internal
+
+  Returns the profile of \a plottable in the current frame, creating it if necessary. The mutex
+  must be locked by the caller.
+*/
+QCPRenderProfiler::PlottableProfile &QCPRenderProfiler::plottableProfile(const QCPAbstractPlottable *plottable)
+{
+  QHash<const QCPAbstractPlottable*, int>::const_iterator it = mPlottableIndices.constFind(plottable);
+  if (it != mPlottableIndices.constEnd())
+    return mCurrentFrame.plottables[it.value()];
+  
+  PlottableProfile profile;
+  profile.name = plottable->name();
+  for (int i=0; i<stageCount; ++i)
+    profile.stageTime[i] = 0;
+  profile.inputPoints = 0;
+  profile.emittedPoints = 0;
+  mPlottableIndices.insert(plottable, mCurrentFrame.plottables.size());
+  mCurrentFrame.plottables.append(profile);
+  return mCurrentFrame.plottables.last();
+}
+/* end of 'src/renderprofiler.cpp' */
+
+
+/* including file 'src/pixelgrid.cpp'      */
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPPixelGrid
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPPixelGrid
+  \brief A spatial index of data points and line segments in pixel coordinates
+
+  The pixel grid divides a rect of the widget into square cells of \ref cellSize pixels and
+  remembers which data points and line segments of a plottable lie in each cell. This allows hit
+  tests like \ref QCPGraph::selectTest and \ref QCPGraph::selectTestRect to only look at the few
+  cells around the mouse cursor or inside the selection rect, instead of all visible data.
+
+  The grid is filled between calls to \ref reset and \ref finish: \ref addPoints takes the pixel
+  positions of consecutive data points, \ref addPolyline the lines drawn between them. Of several
+  points in the same pixel, only the first one is stored for \ref nearestPoint, so its memory is
+  bounded by the size of the rect. For \ref rangesInRect, the data indices of all points are kept
+  as runs of consecutive indices that fall into the same cell.
+
+  Since the pixel positions depend on the axis ranges, the owner of a grid must rebuild it when
+  the ranges or the data change.
+*/
+
+/*!
+  Creates an empty pixel grid.
+*/
+QCPPixelGrid::QCPPixelGrid() :
+  mCellSize(1),
+  mColumns(0),
+  mRows(0),
+  mRunCell(-1),
+  mRunEnd(-1)
+{
+}
+
+/*!
+  Removes all points and segments from the grid and releases its memory. Afterwards, \ref isEmpty
+  returns true.
+*/
+void QCPPixelGrid::clear()
+{
+  mRect = QRect();
+  mColumns = mRows = 0;
+  mPoints.clear();
+  mRuns.clear();
+  mSegments.clear();
+  mPointStart.clear();
+  mRunStart.clear();
+  mSegmentStart.clear();
+  mPixelTaken.clear();
+  mPointCells.clear();
+  mRunCells.clear();
+  mSegmentCells.clear();
+  mRunCell = mRunEnd = -1;
+}
+
+/*!
+  Clears the grid and prepares it for covering \a rect with cells of \a cellSize pixels. Points
+  and segments can then be added with \ref addPoints and \ref addPolyline, until \ref finish is
+  called.
+*/
+void QCPPixelGrid::reset(const QRect &rect, int cellSize)
+{
+  clear();
+  if (rect.isEmpty())
+    return;
+  mRect = rect;
+  mCellSize = qMax(1, cellSize);
+  mColumns = (rect.width()+mCellSize-1)/mCellSize;
+  mRows = (rect.height()+mCellSize-1)/mCellSize;
+  mPixelTaken.fill(0, rect.width()*rect.height());
+}
+
+/*!
+  Adds the \a count points at the pixel positions \a pixels, which belong to the data points with
+  the consecutive indices starting at \a firstIndex. Points outside the \ref rect or with NaN
+  coordinates are ignored. Successive calls must pass ascending indices.
+*/
+void QCPPixelGrid::addPoints(const QPointF *pixels, int count, int firstIndex)
+{
+  if (isEmpty())
+    return;
+  const int width = mRect.width();
+  for (int i=0; i<count; ++i)
+  {
+    const QPointF &pos = pixels[i];
+    const int cell = cellAt(pos);
+    const int index = firstIndex+i;
+    if (cell != mRunCell || index != mRunEnd) // close the current run and start a new one
+    {
+      if (mRunCell >= 0)
+        mRuns.last().setEnd(mRunEnd);
+      mRunCell = cell;
+      if (cell >= 0)
+      {
+        mRuns.append(QCPDataRange(index, index+1));
+        mRunCells.append(cell);
+      }
+    }
+    mRunEnd = index+1;
+    if (cell < 0)
+      continue;
+    const int pixel = int(pos.y()-mRect.top())*width + int(pos.x()-mRect.left());
+    if (!mPixelTaken.at(pixel))
+    {
+      mPixelTaken[pixel] = 1;
+      const Point point = {pos, index};
+      mPoints.append(point);
+      mPointCells.append(cell);
+    }
+  }
+}
+
+/*!
+  Adds the lines between the \a count \a vertices, given in pixel coordinates. If \a pairwise is
+  true, only each pair of vertices is connected (like for \ref QCPGraph::lsImpulse), otherwise all
+  successive vertices are. Segments with NaN vertices or outside the \ref rect are ignored.
+*/
+void QCPPixelGrid::addPolyline(const QPointF *vertices, int count, bool pairwise)
+{
+  if (isEmpty())
+    return;
+  const int step = pairwise ? 2 : 1;
+  for (int i=0; i+1<count; i+=step)
+  {
+    const QLineF segment(vertices[i], vertices[i+1]);
+    if (qIsNaN(segment.x1()) || qIsNaN(segment.y1()) || qIsNaN(segment.x2()) || qIsNaN(segment.y2()))
+      continue;
+    int firstColumn, firstRow, lastColumn, lastRow;
+    if (!cellSpan(QRectF(segment.p1(), segment.p2()).normalized(), firstColumn, firstRow, lastColumn, lastRow))
+      continue;
+    for (int row=firstRow; row<=lastRow; ++row)
+    {
+      for (int column=firstColumn; column<=lastColumn; ++column)
+      {
+        mSegments.append(segment);
+        mSegmentCells.append(row*mColumns+column);
+      }
+    }
+  }
+}
+
+/*!
+  Completes building the grid after points and segments were added, so it can be queried.
+*/
+void QCPPixelGrid::finish()
+{
+  if (isEmpty())
+    return;
+  if (mRunCell >= 0)
+    mRuns.last().setEnd(mRunEnd);
+  mRunCell = mRunEnd = -1;
+  mPixelTaken.clear();
+  mPixelTaken.squeeze();
+  sortByCell(mPoints, mPointCells, mPointStart);
+  sortByCell(mRuns, mRunCells, mRunStart);
+  sortByCell(mSegments, mSegmentCells, mSegmentStart);
+}
+
+/*!
+  Returns the data index of the point closest to \a pos, considering only points within \a
+  maxDistance pixels. If \a distance is not zero, it is set to the distance of that point. If no
+  point lies within \a maxDistance, returns -1.
+
+  Since only one point is stored per pixel, the returned point may be another one in the same
+  pixel as the actual closest data point.
+*/
+int QCPPixelGrid::nearestPoint(const QPointF &pos, double maxDistance, double *distance) const
+{
+  int firstColumn, firstRow, lastColumn, lastRow;
+  if (!cellSpan(QRectF(pos.x()-maxDistance, pos.y()-maxDistance, 2*maxDistance, 2*maxDistance), firstColumn, firstRow, lastColumn, lastRow))
+    return -1;
+  int result = -1;
+  double minDistSqr = maxDistance*maxDistance;
+  for (int row=firstRow; row<=lastRow; ++row)
+  {
+    for (int cell=row*mColumns+firstColumn; cell<=row*mColumns+lastColumn; ++cell)
+    {
+      for (int i=mPointStart.at(cell); i<mPointStart.at(cell+1); ++i)
+      {
+        const double distSqr = QCPVector2D(mPoints.at(i).pos-pos).lengthSquared();
+        if (distSqr <= minDistSqr)
+        {
+          minDistSqr = distSqr;
+          result = mPoints.at(i).index;
+        }
+      }
+    }
+  }
+  if (distance && result >= 0)
+    *distance = qSqrt(minDistSqr);
+  return result;
+}
+
+/*!
+  Returns the distance of \a pos to the closest polyline segment, considering only segments within
+  \a maxDistance pixels. If there is no such segment, returns -1.
+*/
+double QCPPixelGrid::polylineDistance(const QPointF &pos, double maxDistance) const
+{
+  int firstColumn, firstRow, lastColumn, lastRow;
+  if (!cellSpan(QRectF(pos.x()-maxDistance, pos.y()-maxDistance, 2*maxDistance, 2*maxDistance), firstColumn, firstRow, lastColumn, lastRow))
+    return -1;
+  const QCPVector2D p(pos);
+  double minDistSqr = maxDistance*maxDistance;
+  bool found = false;
+  for (int row=firstRow; row<=lastRow; ++row)
+  {
+    for (int cell=row*mColumns+firstColumn; cell<=row*mColumns+lastColumn; ++cell)
+    {
+      for (int i=mSegmentStart.at(cell); i<mSegmentStart.at(cell+1); ++i)
+      {
+        const double distSqr = p.distanceSquaredToLine(mSegments.at(i));
+        if (distSqr <= minDistSqr)
+        {
+          minDistSqr = distSqr;
+          found = true;
+        }
+      }
+    }
+  }
+  return found ? qSqrt(minDistSqr) : -1;
+}
+
+/*!
+  Collects the data indices of the points that may lie inside \a rect. The runs of cells that are
+  completely covered by \a rect are added to \a inside (without simplifying it). The runs of cells
+  that are only partially covered are appended to \a border, their points must be tested
+  individually by the caller.
+*/
+void QCPPixelGrid::rangesInRect(const QRectF &rect, QCPDataSelection *inside, QVector<QCPDataRange> *border) const
+{
+  int firstColumn, firstRow, lastColumn, lastRow;
+  if (!cellSpan(rect, firstColumn, firstRow, lastColumn, lastRow))
+    return;
+  for (int row=firstRow; row<=lastRow; ++row)
+  {
+    for (int column=firstColumn; column<=lastColumn; ++column)
+    {
+      const int cell = row*mColumns+column;
+      const QRectF cellRect(mRect.left()+column*mCellSize, mRect.top()+row*mCellSize, mCellSize, mCellSize);
+      const bool covered = rect.contains(cellRect);
+      for (int i=mRunStart.at(cell); i<mRunStart.at(cell+1); ++i)
+      {
+        if (covered)
+          inside->addDataRange(mRuns.at(i), false);
+        else
+          border->append(mRuns.at(i));
+      }
+    }
+  }
+}
+
+/*! \internal
+
+  Returns the index of the cell that contains \a pos, or -1 if \a pos lies outside the \ref rect
+  or has NaN coordinates.
+*/
+int QCPPixelGrid::cellAt(const QPointF &pos) const
+{
+  const double x = pos.x()-mRect.left();
+  const double y = pos.y()-mRect.top();
+  if (x >= 0 && x < mRect.width() && y >= 0 && y < mRect.height()) // also false for NaN
+    return int(y)/mCellSize*mColumns + int(x)/mCellSize;
+  return -1;
+}
+
+/*! \internal
+
+  Determines the columns and rows of the cells that \a rect overlaps, limited to the cells of the
+  grid. Returns false if \a rect doesn't overlap the grid at all.
+*/
+bool QCPPixelGrid::cellSpan(const QRectF &rect, int &firstColumn, int &firstRow, int &lastColumn, int &lastRow) const
+{
+  if (isEmpty() || !(rect.right() >= mRect.left() && rect.left() < mRect.left()+mRect.width() &&
+                     rect.bottom() >= mRect.top() && rect.top() < mRect.top()+mRect.height()))
+    return false;
+  // bound as double first, since pixel coordinates far outside the grid may exceed the int range:
+  firstColumn = int(qBound(0.0, std::floor((rect.left()-mRect.left())/mCellSize), double(mColumns-1)));
+  lastColumn = int(qBound(0.0, std::floor((rect.right()-mRect.left())/mCellSize), double(mColumns-1)));
+  firstRow = int(qBound(0.0, std::floor((rect.top()-mRect.top())/mCellSize), double(mRows-1)));
+  lastRow = int(qBound(0.0, std::floor((rect.bottom()-mRect.top())/mCellSize), double(mRows-1)));
+  return true;
+}
+
+/*! \internal
+
+  Reorders \a items, whose cell indices are given in the parallel vector \a cells, so the items of
+  each cell are contiguous, and writes the offset of each cell's first item to \a cellStart. This
+  is a counting sort, so the order of items within each cell is kept. \a cells is released
+  afterwards.
+*/
+template <class T>
+void QCPPixelGrid::sortByCell(QVector<T> &items, QVector<int> &cells, QVector<int> &cellStart) const
+{
+  const int cellCount = mColumns*mRows;
+  cellStart.fill(0, cellCount+1);
+  for (int i=0; i<cells.size(); ++i)
+    ++cellStart[cells.at(i)+1];
+  for (int cell=0; cell<cellCount; ++cell)
+    cellStart[cell+1] += cellStart.at(cell);
+  QVector<int> position = cellStart;
+  QVector<T> sorted(items.size());
+  for (int i=0; i<items.size(); ++i)
+    sorted[position[cells.at(i)]++] = items.at(i);
+  items = sorted;
+  cells.clear();
+  cells.squeeze();
+}
+
+/* end of 'src/pixelgrid.cpp' */
+
+
 /* including file 'src/core.cpp'             */
 /* modified 2021-03-29T02:30:44, size 127198 */
 
@@ -13487,6 +15009,13 @@ QCP::Interaction QCPAbstractItem::selectionCategory() const
   \see replot, beforeReplot, afterLayout
 */
 
+/*! \fn void QCustomPlot::frameProfiled()
+  
+  This signal is emitted after each frame while render profiling is enabled (see \ref
+  setRenderProfiling), i.e. after every \ref replot and every partial repaint of single layers.
+  The results of the frame can then be retrieved from \ref renderProfiler.
+*/
+
 /* end of documentation of signals */
 /* start of documentation of public members */
 
@@ -13615,6 +15144,10 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   mSelectionRectMode(QCP::srmNone),
   mSelectionRect(nullptr),
   mOpenGl(false),
+  mFrameInterval(16),
+  mFrameTimeBudget(0),
+  mGraphLayerLimit(0),
+  mVectorExportResolution(600),
   mMouseHasMoved(false),
   mMouseEventLayerable(nullptr),
   mMouseSignalLayerable(nullptr),
@@ -13622,12 +15155,30 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   mReplotQueued(false),
   mReplotTime(0),
   mReplotTimeAverage(0),
+  mFrameTimer(new QTimer(this)),
+  mMergedReplotCount(0),
+  mDroppedReplotCount(0),
+  mFrameDroppedWhileHidden(false),
+  mRenderProfiler(nullptr),
+  mVectorSampling(0),
+  mQualityLevel(qlFull),
+  mQualityTimer(new QTimer(this)),
+  mInteractiveSampling(0),
+  mFastFrameCount(0),
   mOpenGlMultisamples(16),
   mOpenGlAntialiasedElementsBackup(QCP::aeNone),
   mOpenGlCacheLabelsBackup(true)
 {
   setAttribute(Qt::WA_NoMousePropagation);
   setAttribute(Qt::WA_OpaquePaintEvent);
+  mFrameTimer->setSingleShot(true);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 0, 0)
+  mFrameTimer->setTimerType(Qt::PreciseTimer);
+#endif
+  connect(mFrameTimer, SIGNAL(timeout()), this, SLOT(processScheduledFrame()));
+  mQualityTimer->setSingleShot(true);
+  mQualityTimer->setInterval(250);
+  connect(mQualityTimer, SIGNAL(timeout()), this, SLOT(restoreQuality()));
   setFocusPolicy(Qt::ClickFocus);
   setMouseTracking(true);
   QLocale currentLocale = locale();
@@ -13704,6 +15255,8 @@ QCustomPlot::~QCustomPlot()
   mCurrentLayer = nullptr;
   qDeleteAll(mLayers); // don't use removeLayer, because it would prevent the last layer to be removed
   mLayers.clear();
+  
+  delete mRenderProfiler;
 }
 
 /*!
@@ -13917,11 +15470,20 @@ void QCustomPlot::setNoAntialiasingOnDrag(bool enabled)
 /*!
   Sets the plotting hints for this QCustomPlot instance as an \a or combination of QCP::PlottingHint.
   
+  Toggling \ref QCP::phRasterLines recreates the paint buffers, since it switches them between
+  QPixmap and QImage.
+  
   \see setPlottingHint
 */
 void QCustomPlot::setPlottingHints(const QCP::PlottingHints &hints)
 {
+  const bool bufferTypeChanged = hints.testFlag(QCP::phRasterLines) != mPlottingHints.testFlag(QCP::phRasterLines);
   mPlottingHints = hints;
+  if (bufferTypeChanged && !mOpenGl)
+  {
+    mPaintBuffers.clear();
+    setupPaintBuffers();
+  }
 }
 
 /*!
@@ -13941,6 +15503,116 @@ void QCustomPlot::setPlottingHint(QCP::PlottingHint hint, bool enabled)
     setPlottingHints(newHints);
 }
 
+/*!
+  Sets the minimum time in milliseconds between two replots, when the plotting hint \ref
+  QCP::phFrameScheduling is set. The default of 16 ms corresponds to a display refresh rate of 60
+  Hz.
+
+  With frame scheduling, every replot requested with \ref rpQueuedReplot, including those caused by
+  user interactions like range dragging and zooming, is deferred to the next frame. All requests
+  arriving before that frame are merged into a single replot, and consecutive mouse wheel steps are
+  collapsed into one zoom operation. Replots that would happen while the widget is hidden are
+  dropped, the widget is replotted once it is shown again. How many requests were merged and
+  dropped is reported by \ref mergedReplotCount and \ref droppedReplotCount.
+
+  \see setPlottingHint
+*/
+void QCustomPlot::setFrameInterval(int msec)
+{
+  mFrameInterval = qMax(0, msec);
+}
+
+/*!
+  Sets the time in milliseconds that interactive replots may take. If a replot that closely
+  follows the previous one (e.g. while the user drags or zooms, or while data is streaming) takes
+  longer, the drawing quality of the following replots is reduced by one \ref QualityLevel: first
+  antialiasing of plottables is turned off, then fills, then scatter shapes, and finally the data
+  of graphs and curves is thinned. The reductions apply to the replots on screen only, exports are
+  always drawn in full quality.
+
+  Once no replot happened for 250 ms, the full quality is restored with a final replot. While
+  replots continue, the quality is raised again by one level after 30 consecutive replots that
+  took less than half of \a msec.
+
+  A budget of 0 (the default) disables the reductions.
+
+  \see qualityLevel, replotTime
+*/
+void QCustomPlot::setFrameTimeBudget(double msec)
+{
+  mFrameTimeBudget = qMax(0.0, msec);
+  if (mFrameTimeBudget == 0 && mQualityLevel != qlFull)
+  {
+    mQualityTimer->stop();
+    restoreQuality();
+  }
+}
+
+/*!
+  Sets the maximum number of graphs that are automatically given a layer of their own. If \a limit
+  is 0 (the default), graphs stay on the layer they were created on.
+
+  With a limit, each full \ref replot ranks the graphs on the "main" layer (or on one of the
+  automatically created graph layers) by their number of data points, multiplied by one plus the
+  number of times they were individually replotted with \ref replotGraph. The \a limit graphs
+  with the highest rank are moved to dedicated layers in \ref QCPLayer::lmBuffered mode, directly
+  above the "main" layer and in the order the graphs were created. The remaining graphs are moved
+  back to the "main" layer. Since every buffered layer holds a paint buffer of the size of the
+  widget, \a limit bounds the additional memory.
+
+  A graph on a dedicated layer can then be restyled, hidden or shown and redrawn with \ref
+  replotGraph, which only repaints its own layer (and the legend, if the graph has a legend item),
+  instead of all graphs. Likewise, when the user selects or deselects plottables by clicking, only
+  the layers of the affected plottables are repainted.
+
+  Graphs that were placed on other layers manually are left untouched.
+*/
+void QCustomPlot::setGraphLayerLimit(int limit)
+{
+  mGraphLayerLimit = qMax(0, limit);
+}
+
+/*!
+  Sets the resolution in dots per inch at which graphs are decimated when the plot is exported to
+  a vector format, i.e. with \ref savePdf or \ref toPainter on a PDF, SVG or QPicture painter.
+  The viewport pixels of the plot are taken as points (1/72 inch), like in \ref savePdf.
+
+  Of the data points of a graph line that fall into the same device pixel along the key axis,
+  only the first, the lowest, the highest and the last one are written (see \ref
+  QCPGraph::getDecimatedLineData), and of scatters only one per device pixel. Extremes and gaps
+  due to NaN values are preserved, so the output looks the same at the given resolution, while
+  its file size and export time are bounded by the page size instead of the number of data
+  points. This applies regardless of \ref QCPGraph::setAdaptiveSampling, which samples at screen
+  resolution.
+
+  The default is 600 dpi. Set \a dpi to 0 to write all visible data points.
+*/
+void QCustomPlot::setVectorExportResolution(int dpi)
+{
+  mVectorExportResolution = qMax(0, dpi);
+}
+
+/*!
+  Sets whether the time spent in each frame is recorded. If \a enabled, a \ref QCPRenderProfiler
+  is created which is then returned by \ref renderProfiler, and \ref frameProfiled is emitted
+  after every frame. Disabling deletes the profiler, \ref renderProfiler then returns \c nullptr.
+
+  Profiling costs a few timer readings per graph and layer, so it should only be enabled while
+  the performance is investigated.
+*/
+void QCustomPlot::setRenderProfiling(bool enabled)
+{
+  if (enabled == (mRenderProfiler != nullptr))
+    return;
+  if (enabled)
+    mRenderProfiler = new QCPRenderProfiler;
+  else
+  {
+    delete mRenderProfiler;
+    mRenderProfiler = nullptr;
+  }
+}
+
 /*!
   Sets the keyboard modifier that will be recognized as multi-select-modifier.
   
@@ -15117,6 +16789,14 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
 {
   if (refreshPriority == QCustomPlot::rpQueuedReplot)
   {
+    if (mPlottingHints.testFlag(QCP::phFrameScheduling))
+    {
+      if (mFrameTimer->isActive())
+        ++mMergedReplotCount;
+      else
+        mFrameTimer->start(mLastFrame.isValid() ? int(qMax(qint64(0), mFrameInterval-mLastFrame.elapsed())) : 0);
+      return;
+    }
     if (!mReplotQueued)
     {
       mReplotQueued = true;
@@ -15129,6 +16809,15 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
     return;
   mReplotting = true;
   mReplotQueued = false;
+  if (mFrameTimer->isActive()) // this replot also covers the scheduled frame
+  {
+    mFrameTimer->stop();
+    ++mMergedReplotCount;
+  }
+  mLastFrame.start();
+  foreach (QCPAxisRect *axisRect, axisRects())
+    axisRect->applyPendingWheelZoom();
+  updateGraphLayers();
   emit beforeReplot();
   
 # if QT_VERSION < QT_VERSION_CHECK(4, 8, 0)
@@ -15139,11 +16828,17 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
   replotTimer.start();
 # endif
   
+  if (mRenderProfiler)
+    mRenderProfiler->beginFrame();
   updateLayout();
   // draw all layered objects (grid, axes, plottables, items, legend,...) into their buffers:
   setupPaintBuffers();
+  if (mPlottingHints.testFlag(QCP::phParallelPreparation))
+    prepareGraphs();
   foreach (QCPLayer *layer, mLayers)
-    layer->drawToPaintBuffer();
+    drawLayerToPaintBuffer(layer);
+  foreach (QCPGraph *graph, mGraphs) // in case a prepared graph wasn't drawn
+    graph->discardPreparedDraw();
   foreach (QSharedPointer<QCPAbstractPaintBuffer> buffer, mPaintBuffers)
     buffer->setInvalidated(false);
   
@@ -15161,8 +16856,15 @@ void QCustomPlot::replot(QCustomPlot::RefreshPriority refreshPriority)
     mReplotTimeAverage = mReplotTimeAverage*0.9 + mReplotTime*0.1; // exponential moving average with a time constant of 10 last replots
   else
     mReplotTimeAverage = mReplotTime; // no previous replots to average with, so initialize with replot time
+  if (mFrameTimeBudget > 0)
+    updateQualityLevel();
   
   emit afterReplot();
+  if (mRenderProfiler)
+  {
+    mRenderProfiler->endFrame(mReplotTime);
+    emit frameProfiled();
+  }
   mReplotting = false;
 }
 
@@ -15177,6 +16879,57 @@ double QCustomPlot::replotTime(bool average) const
   return average ? mReplotTimeAverage : mReplotTime;
 }
 
+/*!
+  Redraws \a graph after it was changed, e.g. restyled with a different pen, hidden or shown.
+
+  If the graph is on a dedicated graph layer (see \ref setGraphLayerLimit), only this layer and the
+  layer of its legend item are repainted. Otherwise, or if a full replot is necessary anyway (e.g.
+  because the layers changed), a replot is queued with \ref rpQueuedReplot.
+
+  Graphs redrawn often with this method are preferred for dedicated graph layers.
+*/
+void QCustomPlot::replotGraph(QCPGraph *graph)
+{
+  if (!graph || !mGraphs.contains(graph))
+    return;
+  ++graph->mLayerReplotCount;
+  
+  QList<QCPLayer*> layers;
+  layers << graph->layer();
+  if (mGraphLayerLimit > 0 && mGraphLayers.contains(graph->layer()))
+  {
+    if (legend)
+    {
+      if (QCPPlottableLegendItem *legendItem = legend->itemWithPlottable(graph))
+        layers << legendItem->layer();
+    }
+    if (replotLayers(layers))
+      return;
+  }
+  replot(rpQueuedReplot);
+}
+
+/*! \fn int QCustomPlot::mergedReplotCount() const
+
+  Returns how many replot requests were merged into another replot by the frame scheduling (see
+  \ref setFrameInterval), since construction or the last call of \ref resetReplotCounters.
+*/
+
+/*! \fn int QCustomPlot::droppedReplotCount() const
+
+  Returns how many scheduled replots were skipped because the widget was hidden (see \ref
+  setFrameInterval), since construction or the last call of \ref resetReplotCounters.
+*/
+
+/*!
+  Resets the counters returned by \ref mergedReplotCount and \ref droppedReplotCount to zero.
+*/
+void QCustomPlot::resetReplotCounters()
+{
+  mMergedReplotCount = 0;
+  mDroppedReplotCount = 0;
+}
+
 /*!
   Rescales the axes such that all plottables (like graphs) in the plot are fully visible.
   
@@ -15286,7 +17039,9 @@ bool QCustomPlot::savePdf(const QString &fileName, int width, int height, QCP::E
         mBackgroundBrush.color() != Qt::transparent &&
         mBackgroundBrush.color().alpha() > 0) // draw pdf background color if not white/transparent
       printpainter.fillRect(viewport(), mBackgroundBrush);
+    mVectorSampling = mVectorExportResolution/72.0; // the page is as many points large as the viewport has pixels
     draw(&printpainter);
+    mVectorSampling = 0;
     printpainter.end();
     success = true;
   }
@@ -15494,6 +17249,21 @@ void QCustomPlot::resizeEvent(QResizeEvent *event)
   replot(rpQueuedRefresh); // queued refresh is important here, to prevent painting issues in some contexts (e.g. MDI subwindow)
 }
 
+/*! \internal
+
+  Event handler for when the QCustomPlot widget is shown. If a scheduled replot was dropped while
+  the widget was hidden (see \ref setFrameInterval), a replot is queued.
+*/
+void QCustomPlot::showEvent(QShowEvent *event)
+{
+  QWidget::showEvent(event);
+  if (mFrameDroppedWhileHidden)
+  {
+    mFrameDroppedWhileHidden = false;
+    replot(rpQueuedReplot);
+  }
+}
+
 /*! \internal
   
  Event handler for when a double click occurs. Emits the \ref mouseDoubleClick signal, then
@@ -15721,6 +17491,12 @@ void QCustomPlot::wheelEvent(QWheelEvent *event)
 */
 void QCustomPlot::draw(QCPPainter *painter)
 {
+  // this draws exports, which are never reduced in quality (see setFrameTimeBudget):
+  const QualityLevel interactiveLevel = mQualityLevel;
+  const double interactiveSampling = mInteractiveSampling;
+  mQualityLevel = qlFull;
+  mInteractiveSampling = 0;
+  
   updateLayout();
   
   // draw viewport background pixmap:
@@ -15730,6 +17506,9 @@ void QCustomPlot::draw(QCPPainter *painter)
   foreach (QCPLayer *layer, mLayers)
     layer->draw(painter);
   
+  mQualityLevel = interactiveLevel;
+  mInteractiveSampling = interactiveSampling;
+  
   /* Debug code to draw all layout element rects
   foreach (QCPLayoutElement *el, findChildren<QCPLayoutElement*>())
   {
@@ -15742,6 +17521,39 @@ void QCustomPlot::draw(QCPPainter *painter)
   */
 }
 
+/*! \internal
+
+  Called at the end of \ref replot when a frame time budget is set. Replots that follow the previous
+  one while the quality timer still runs count as interactive: If such a replot took longer than the
+  budget, the quality of the next replots is reduced by one level. If replots stay well within the
+  budget, it is raised again step by step. The quality timer is restarted, so the full quality is
+  restored once the replots stop.
+
+  \see setFrameTimeBudget, restoreQuality
+*/
+void QCustomPlot::updateQualityLevel()
+{
+  if (mQualityTimer->isActive()) // the previous replot was just before this one
+  {
+    if (mReplotTime > mFrameTimeBudget)
+    {
+      if (mQualityLevel < qlThinned)
+        mQualityLevel = QualityLevel(mQualityLevel+1);
+      mFastFrameCount = 0;
+    } else if (mReplotTime < 0.5*mFrameTimeBudget)
+    {
+      if (mQualityLevel > qlFull && ++mFastFrameCount >= 30)
+      {
+        mQualityLevel = QualityLevel(mQualityLevel-1);
+        mFastFrameCount = 0;
+      }
+    } else
+      mFastFrameCount = 0;
+    mInteractiveSampling = mQualityLevel >= qlThinned ? 0.5 : 0;
+  }
+  mQualityTimer->start();
+}
+
 /*! \internal
 
   Performs the layout update steps defined by \ref QCPLayoutElement::UpdatePhase, by calling \ref
@@ -15760,6 +17572,29 @@ void QCustomPlot::updateLayout()
   emit afterLayout();
 }
 
+/*! \internal
+
+  Prepares the line and scatter pixel data of all visible graphs concurrently on the global thread
+  pool (see \ref QCPGraph::prepareDraw), so the subsequent drawing of the layers only needs to
+  paint them. This is called by \ref replot if the plotting hint \ref QCP::phParallelPreparation
+  is set.
+
+  If less than two graphs need to be drawn, nothing is prepared, since there would be nothing to
+  gain from distributing the work.
+*/
+void QCustomPlot::prepareGraphs()
+{
+  QList<QCPGraph*> graphs;
+  foreach (QCPGraph *graph, mGraphs)
+  {
+    if (graph->realVisibility() && graph->initPreparedDraw())
+      graphs.append(graph);
+  }
+  if (graphs.size() < 2)
+    return;
+  QtConcurrent::blockingMap(graphs, [](QCPGraph *graph) { graph->prepareDraw(); });
+}
+
 /*! \internal
   
   Draws the viewport background pixmap of the plot.
@@ -15856,13 +17691,137 @@ void QCustomPlot::setupPaintBuffers()
   }
 }
 
+/*! \internal
+
+  Moves the graphs to dedicated graph layers or back to the "main" layer, according to the policy
+  described at \ref setGraphLayerLimit. Graph layers are created and removed as needed, so there
+  are never more than the graph layer limit. Graphs are only moved if their layer actually changes,
+  so the paint buffers stay valid if the ranking is stable.
+
+  This method is called by \ref replot before the paint buffers are set up.
+*/
+void QCustomPlot::updateGraphLayers()
+{
+  QCPLayer *baseLayer = layer(QLatin1String("main"));
+  if (!baseLayer || (mGraphLayerLimit == 0 && mGraphLayers.isEmpty()))
+    return;
+  
+  // only manage graphs that weren't placed on other layers by the user:
+  QList<QCPGraph*> managedGraphs;
+  foreach (QCPGraph *graph, mGraphs)
+  {
+    if (graph->layer() == baseLayer || mGraphLayers.contains(graph->layer()))
+      managedGraphs.append(graph);
+  }
+  QList<QCPGraph*> ranking = managedGraphs;
+  std::stable_sort(ranking.begin(), ranking.end(), [](const QCPGraph *a, const QCPGraph *b)
+  {
+    return a->data()->size()*(1.0+a->mLayerReplotCount) > b->data()->size()*(1.0+b->mLayerReplotCount);
+  });
+  const int dedicatedCount = qMin(mGraphLayerLimit, ranking.size());
+  const QList<QCPGraph*> dedicatedGraphs = ranking.mid(0, dedicatedCount);
+  
+  // create missing and remove surplus graph layers:
+  while (mGraphLayers.size() < dedicatedCount)
+  {
+    const QString name = QString(QLatin1String("graph layer %1")).arg(mGraphLayers.size()+1);
+    if (!addLayer(name, mGraphLayers.isEmpty() ? baseLayer : mGraphLayers.last(), limAbove))
+      break;
+    QCPLayer *graphLayer = layer(name);
+    graphLayer->setMode(QCPLayer::lmBuffered);
+    mGraphLayers.append(graphLayer);
+  }
+  while (mGraphLayers.size() > dedicatedCount)
+  {
+    QCPLayer *graphLayer = mGraphLayers.takeLast();
+    foreach (QCPLayerable *child, graphLayer->children())
+      child->setLayer(baseLayer);
+    removeLayer(graphLayer);
+  }
+  
+  // assign dedicated layers in creation order of the graphs, to keep their stacking order:
+  int graphLayerIndex = 0;
+  foreach (QCPGraph *graph, managedGraphs)
+  {
+    QCPLayer *targetLayer = baseLayer;
+    if (dedicatedGraphs.contains(graph) && graphLayerIndex < mGraphLayers.size())
+      targetLayer = mGraphLayers.at(graphLayerIndex++);
+    if (graph->layer() != targetLayer)
+      graph->setLayer(targetLayer);
+  }
+}
+
+/*! \internal
+
+  Repaints only the paint buffers that the given \a layers draw to, each with all layers sharing
+  that buffer, and then updates the widget. This is how \ref replotGraph and the selection
+  handling avoid a full replot.
+
+  Returns false without painting anything if a full replot is required or already pending, e.g.
+  because paint buffers were invalidated by layer changes. The caller must then replot.
+*/
+bool QCustomPlot::replotLayers(const QList<QCPLayer*> &layers)
+{
+  if (mReplotting || mReplotQueued || mFrameTimer->isActive() || hasInvalidatedPaintBuffers())
+    return false;
+  
+  QList<QSharedPointer<QCPAbstractPaintBuffer> > buffers;
+  foreach (QCPLayer *layer, layers)
+  {
+    QSharedPointer<QCPAbstractPaintBuffer> buffer = layer ? layer->mPaintBuffer.toStrongRef() : QSharedPointer<QCPAbstractPaintBuffer>();
+    if (!buffer)
+      return false;
+    if (!buffers.contains(buffer))
+      buffers.append(buffer);
+  }
+  QElapsedTimer frameTimer;
+  frameTimer.start();
+  if (mRenderProfiler)
+    mRenderProfiler->beginFrame();
+  foreach (QSharedPointer<QCPAbstractPaintBuffer> buffer, buffers)
+  {
+    buffer->clear(Qt::transparent);
+    foreach (QCPLayer *layer, mLayers)
+    {
+      if (layer->mPaintBuffer.toStrongRef() == buffer)
+        drawLayerToPaintBuffer(layer);
+    }
+    buffer->setInvalidated(false);
+  }
+  update();
+  if (mRenderProfiler)
+  {
+    mRenderProfiler->endFrame(frameTimer.nsecsElapsed()*1e-6);
+    emit frameProfiled();
+  }
+  return true;
+}
+
+/*! \internal
+
+  Draws \a layer into its paint buffer and, if render profiling is enabled (see \ref
+  setRenderProfiling), records how long that took.
+*/
+void QCustomPlot::drawLayerToPaintBuffer(QCPLayer *layer)
+{
+  if (!mRenderProfiler)
+  {
+    layer->drawToPaintBuffer();
+    return;
+  }
+  QElapsedTimer layerTimer;
+  layerTimer.start();
+  layer->drawToPaintBuffer();
+  mRenderProfiler->addLayerTime(layer, layerTimer.nsecsElapsed()*1e-6);
+}
+
 /*! \internal
 
   This method is used by \ref setupPaintBuffers when it needs to create new paint buffers.
 
-  Depending on the current setting of \ref setOpenGl, and the current Qt version, different
-  backends (subclasses of \ref QCPAbstractPaintBuffer) are created, initialized with the proper
-  size and device pixel ratio, and returned.
+  Depending on the current setting of \ref setOpenGl, the plotting hint \ref QCP::phRasterLines,
+  and the current Qt version, different backends (subclasses of \ref QCPAbstractPaintBuffer) are
+  created, initialized with the proper size and device pixel ratio, and returned.
 */
 QCPAbstractPaintBuffer *QCustomPlot::createPaintBuffer()
 {
@@ -15876,7 +17835,9 @@ QCPAbstractPaintBuffer *QCustomPlot::createPaintBuffer()
     qDebug() << Q_FUNC_INFO << "OpenGL enabled even though no support for it compiled in, this shouldn't have happened. Falling back to pixmap paint buffer.";
     return new QCPPaintBufferPixmap(viewport().size(), mBufferDevicePixelRatio);
 #endif
-  } else
+  } else if (mPlottingHints.testFlag(QCP::phRasterLines))
+    return new QCPPaintBufferImage(viewport().size(), mBufferDevicePixelRatio);
+  else
     return new QCPPaintBufferPixmap(viewport().size(), mBufferDevicePixelRatio);
 }
 
@@ -16011,6 +17972,41 @@ void QCustomPlot::legendRemoved(QCPLegend *legend)
     this->legend = nullptr;
 }
 
+/*! \internal
+
+  Called by the frame timer when a frame scheduled by \ref replot with \ref rpQueuedReplot is due.
+  Performs the replot, unless the widget isn't visible, in which case the frame is dropped.
+
+  \see setFrameInterval
+*/
+void QCustomPlot::processScheduledFrame()
+{
+  if (!isVisible())
+  {
+    ++mDroppedReplotCount;
+    mFrameDroppedWhileHidden = true;
+    return;
+  }
+  replot(rpRefreshHint);
+}
+
+/*! \internal
+
+  Called by the quality timer when no replot happened for a while after the drawing quality was
+  reduced. Restores the full quality and replots.
+
+  \see setFrameTimeBudget
+*/
+void QCustomPlot::restoreQuality()
+{
+  mFastFrameCount = 0;
+  if (mQualityLevel == qlFull)
+    return;
+  mQualityLevel = qlFull;
+  mInteractiveSampling = 0;
+  replot(rpQueuedReplot);
+}
+
 /*! \internal
   
   This slot is connected to the selection rect's \ref QCPSelectionRect::accepted signal when \ref
@@ -16150,6 +18146,8 @@ void QCustomPlot::processPointSelection(QMouseEvent *event)
   QVariant details;
   QCPLayerable *clickedLayerable = layerableAt(event->pos(), true, &details);
   bool selectionStateChanged = false;
+  QList<QCPLayer*> changedLayers; // layers of plottables with changed selection, others cause a full replot
+  bool onlyPlottablesChanged = true;
   bool additive = mInteractions.testFlag(QCP::iMultiSelect) && event->modifiers().testFlag(mMultiSelectModifier);
   // deselect all other layerables if not additive selection:
   if (!additive)
@@ -16163,6 +18161,11 @@ void QCustomPlot::processPointSelection(QMouseEvent *event)
           bool selChanged = false;
           layerable->deselectEvent(&selChanged);
           selectionStateChanged |= selChanged;
+          if (selChanged)
+          {
+            changedLayers << layerable->layer();
+            onlyPlottablesChanged &= qobject_cast<QCPAbstractPlottable*>(layerable) != nullptr;
+          }
         }
       }
     }
@@ -16173,11 +18176,18 @@ void QCustomPlot::processPointSelection(QMouseEvent *event)
     bool selChanged = false;
     clickedLayerable->selectEvent(event, additive, details, &selChanged);
     selectionStateChanged |= selChanged;
+    if (selChanged)
+    {
+      changedLayers << clickedLayerable->layer();
+      onlyPlottablesChanged &= qobject_cast<QCPAbstractPlottable*>(clickedLayerable) != nullptr;
+    }
   }
   if (selectionStateChanged)
   {
     emit selectionChangedByUser();
-    replot(rpQueuedReplot);
+    // with graph layers, repaint only the layers of the (de)selected plottables if possible:
+    if (!(mGraphLayerLimit > 0 && onlyPlottablesChanged && replotLayers(changedLayers)))
+      replot(rpQueuedReplot);
   }
 }
 
@@ -16370,7 +18380,7 @@ QList<QCPLayerable*> QCustomPlot::layerableListAt(const QPointF &pos, bool onlyS
 */
 bool QCustomPlot::saveRastered(const QString &fileName, int width, int height, double scale, const char *format, int quality, int resolution, QCP::ResolutionUnit resolutionUnit)
 {
-  QImage buffer = toPixmap(width, height, scale).toImage();
+  QImage buffer = toImage(width, height, scale);
   
   int dotsPerMeter = 0;
   switch (resolutionUnit)
@@ -16439,6 +18449,72 @@ QPixmap QCustomPlot::toPixmap(int width, int height, double scale)
   return result;
 }
 
+/*!
+  Renders the plot to an image and returns it.
+
+  The plot is sized to \a width and \a height in pixels and scaled with \a scale, like with \ref
+  toPixmap. Unlike pixmaps, images are independent of the windowing system, so the returned image
+  may be encoded and saved on another thread. If the plotting hint \ref
+  QCP::phParallelPreparation is set, the pixel data of the graphs is prepared concurrently, like in
+  \ref replot.
+
+  \see toPixmap, saveRastered
+*/
+QImage QCustomPlot::toImage(int width, int height, double scale)
+{
+  // this method is somewhat similar to toPixmap. Change something here, and a change in toPixmap might be necessary, too.
+  int newWidth, newHeight;
+  if (width == 0 || height == 0)
+  {
+    newWidth = this->width();
+    newHeight = this->height();
+  } else
+  {
+    newWidth = width;
+    newHeight = height;
+  }
+  int scaledWidth = qRound(scale*newWidth);
+  int scaledHeight = qRound(scale*newHeight);
+  
+  const bool opaque = mBackgroundBrush.style() == Qt::SolidPattern && mBackgroundBrush.color().alpha() == 255;
+  QImage result(scaledWidth, scaledHeight, opaque ? QImage::Format_RGB32 : QImage::Format_ARGB32_Premultiplied);
+  result.fill(mBackgroundBrush.style() == Qt::SolidPattern ? mBackgroundBrush.color() : Qt::transparent); // if using non-solid pattern, make transparent now and draw brush pattern later
+  QCPPainter painter;
+  painter.begin(&result);
+  if (painter.isActive())
+  {
+    QRect oldViewport = viewport();
+    setViewport(QRect(0, 0, newWidth, newHeight));
+    painter.setMode(QCPPainter::pmNoCaching);
+    if (!qFuzzyCompare(scale, 1.0))
+    {
+      if (scale > 1.0) // for scale < 1 we always want cosmetic pens where possible, because else lines might disappear for very small scales
+        painter.setMode(QCPPainter::pmNonCosmetic);
+      painter.scale(scale, scale);
+    }
+    if (mBackgroundBrush.style() != Qt::SolidPattern && mBackgroundBrush.style() != Qt::NoBrush) // solid fills were done a few lines above with QImage::fill
+      painter.fillRect(mViewport, mBackgroundBrush);
+    if (mPlottingHints.testFlag(QCP::phParallelPreparation))
+    {
+      updateLayout(); // graphs are prepared for the axis rects of the new viewport
+      const double interactiveSampling = mInteractiveSampling;
+      mInteractiveSampling = 0; // exports are never thinned, see setFrameTimeBudget
+      prepareGraphs();
+      mInteractiveSampling = interactiveSampling;
+    }
+    draw(&painter);
+    foreach (QCPGraph *graph, mGraphs) // in case a prepared graph wasn't drawn
+      graph->discardPreparedDraw();
+    setViewport(oldViewport);
+    painter.end();
+  } else // might happen if image has width or height zero
+  {
+    qDebug() << Q_FUNC_INFO << "Couldn't activate painter on image";
+    return QImage();
+  }
+  return result;
+}
+
 /*!
   Renders the plot using the passed \a painter.
   
@@ -16472,7 +18548,11 @@ void QCustomPlot::toPainter(QCPPainter *painter, int width, int height)
     painter->setMode(QCPPainter::pmNoCaching);
     if (mBackgroundBrush.style() != Qt::NoBrush) // unlike in toPixmap, we can't do QPixmap::fill for Qt::SolidPattern brush style, so we also draw solid fills with fillRect here
       painter->fillRect(mViewport, mBackgroundBrush);
+    const QPaintEngine::Type engineType = painter->paintEngine() ? painter->paintEngine()->type() : QPaintEngine::Raster;
+    if (engineType == QPaintEngine::Pdf || engineType == QPaintEngine::SVG || engineType == QPaintEngine::Picture) // vector output, decimate graphs like in savePdf
+      mVectorSampling = mVectorExportResolution/72.0;
     draw(painter);
+    mVectorSampling = 0;
     setViewport(oldViewport);
   } else
     qDebug() << Q_FUNC_INFO << "Passed painter is not active";
@@ -16687,6 +18767,11 @@ void QCPColorGradient::setPeriodic(bool enabled)
 
   The QRgb values that are placed in \a scanLine have their r, g, and b components premultiplied
   with alpha (see QImage::Format_ARGB32_Premultiplied).
+
+  On x86 processors with AVX2, four values at a time are mapped to the gradient, also for
+  logarithmic ranges. Calls for different \a scanLine arrays may run concurrently, e.g. on row
+  bands of an image as in \ref QCPColorMap::updateMapImage, once the gradient's color buffer is up
+  to date.
 */
 void QCPColorGradient::colorize(const double *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic)
 {
@@ -16706,7 +18791,14 @@ void QCPColorGradient::colorize(const double *data, const QCPRange &range, QRgb
   
   const bool skipNanCheck = mNanHandling == nhNone;
   const double posToIndexFactor = !logarithmic ? (mLevelCount-1)/range.size() : (mLevelCount-1)/qLn(range.upper/range.lower);
-  for (int i=0; i<n; ++i)
+  const QRgb *colorBuffer = mColorBuffer.constData(); // const access, so concurrent calls never detach the buffer
+  int i = 0;
+#ifdef QCP_AVX2_DISPATCH
+  static const bool haveAvx2 = __builtin_cpu_supports("avx2");
+  if (haveAvx2)
+    i = colorizeAvx2(data, range, scanLine, n, dataIndexFactor, logarithmic);
+#endif
+  for (; i<n; ++i)
   {
     const double value = data[dataIndexFactor*i];
     if (skipNanCheck || !std::isnan(value))
@@ -16721,18 +18813,9 @@ void QCPColorGradient::colorize(const double *data, const QCPRange &range, QRgb
         if (index < 0)
           index += mLevelCount;
       }
-      scanLine[i] = mColorBuffer.at(index);
+      scanLine[i] = colorBuffer[index];
     } else
-    {
-      switch(mNanHandling)
-      {
-      case nhLowestColor: scanLine[i] = mColorBuffer.first(); break;
-      case nhHighestColor: scanLine[i] = mColorBuffer.last(); break;
-      case nhTransparent: scanLine[i] = qRgba(0, 0, 0, 0); break;
-      case nhNanColor: scanLine[i] = mNanColor.rgba(); break;
-      case nhNone: break; // shouldn't happen
-      }
-    }
+      scanLine[i] = nanColorRgb();
   }
 }
 
@@ -16767,7 +18850,26 @@ void QCPColorGradient::colorize(const double *data, const unsigned char *alpha,
   
   const bool skipNanCheck = mNanHandling == nhNone;
   const double posToIndexFactor = !logarithmic ? (mLevelCount-1)/range.size() : (mLevelCount-1)/qLn(range.upper/range.lower);
-  for (int i=0; i<n; ++i)
+  const QRgb *colorBuffer = mColorBuffer.constData(); // const access, so concurrent calls never detach the buffer
+  int i = 0;
+#ifdef QCP_AVX2_DISPATCH
+  static const bool haveAvx2 = __builtin_cpu_supports("avx2");
+  if (haveAvx2)
+  {
+    i = colorizeAvx2(data, range, scanLine, n, dataIndexFactor, logarithmic);
+    for (int k=0; k<i; ++k) // apply alpha to the colors of the values, like below
+    {
+      const unsigned char cellAlpha = alpha[dataIndexFactor*k];
+      if (cellAlpha != 255 && (skipNanCheck || !std::isnan(data[dataIndexFactor*k])))
+      {
+        const QRgb rgb = scanLine[k];
+        const float alphaF = cellAlpha/255.0f;
+        scanLine[k] = qRgba(int(qRed(rgb)*alphaF), int(qGreen(rgb)*alphaF), int(qBlue(rgb)*alphaF), int(qAlpha(rgb)*alphaF));
+      }
+    }
+  }
+#endif
+  for (; i<n; ++i)
   {
     const double value = data[dataIndexFactor*i];
     if (skipNanCheck || !std::isnan(value))
@@ -16784,24 +18886,15 @@ void QCPColorGradient::colorize(const double *data, const unsigned char *alpha,
       }
       if (alpha[dataIndexFactor*i] == 255)
       {
-        scanLine[i] = mColorBuffer.at(index);
+        scanLine[i] = colorBuffer[index];
       } else
       {
-        const QRgb rgb = mColorBuffer.at(index);
+        const QRgb rgb = colorBuffer[index];
         const float alphaF = alpha[dataIndexFactor*i]/255.0f;
         scanLine[i] = qRgba(int(qRed(rgb)*alphaF), int(qGreen(rgb)*alphaF), int(qBlue(rgb)*alphaF), int(qAlpha(rgb)*alphaF)); // also multiply r,g,b with alpha, to conform to Format_ARGB32_Premultiplied
       }
     } else
-    {
-      switch(mNanHandling)
-      {
-      case nhLowestColor: scanLine[i] = mColorBuffer.first(); break;
-      case nhHighestColor: scanLine[i] = mColorBuffer.last(); break;
-      case nhTransparent: scanLine[i] = qRgba(0, 0, 0, 0); break;
-      case nhNanColor: scanLine[i] = mNanColor.rgba(); break;
-      case nhNone: break; // shouldn't happen
-      }
-    }
+      scanLine[i] = nanColorRgb();
   }
 }
 
@@ -17112,6 +19205,88 @@ void QCPColorGradient::updateColorBuffer()
   }
   mColorBufferInvalidated = false;
 }
+
+/*! \internal
+
+  Returns the color that \ref colorize assigns to NaN values according to the \ref
+  setNanHandling mode. With \ref nhNone, NaN values aren't expected and transparent is returned.
+  The color buffer must be up to date.
+*/
+QRgb QCPColorGradient::nanColorRgb() const
+{
+  switch (mNanHandling)
+  {
+    case nhLowestColor: return mColorBuffer.at(0);
+    case nhHighestColor: return mColorBuffer.at(mColorBuffer.size()-1);
+    case nhNanColor: return mNanColor.rgba();
+    case nhTransparent:
+    case nhNone: break;
+  }
+  return qRgba(0, 0, 0, 0);
+}
+
+#ifdef QCP_AVX2_DISPATCH
+/*! \internal
+
+  Maps groups of four values of \a data to colors of the gradient with AVX2 instructions, like the
+  portable loop of \ref colorize. Logarithms are evaluated with \c qcpLnAvx2, so a value that lies
+  within about 1e-13 of the boundary between two color levels may end up in the neighboring level.
+  Values that have no logarithm (zero, negative or infinite values on a logarithmic range) get the
+  color at the respective end of the gradient.
+
+  Returns the number of values that were colorized, the remaining ones (fewer than four) must be
+  handled by the portable loop. The color buffer must be up to date and the CPU must support AVX2.
+*/
+__attribute__((target("avx2")))
+int QCPColorGradient::colorizeAvx2(const double *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic) const
+{
+  const double posToIndexFactor = !logarithmic ? (mLevelCount-1)/range.size() : (mLevelCount-1)/qLn(range.upper/range.lower);
+  const int *colorBuffer = reinterpret_cast<const int*>(mColorBuffer.constData());
+  const __m256d lower = _mm256_set1_pd(range.lower);
+  const __m256d factor = _mm256_set1_pd(posToIndexFactor);
+  const __m256d zero = _mm256_setzero_pd();
+  const __m256d maxIndex = _mm256_set1_pd(mLevelCount-1);
+  const __m256d levelCount = _mm256_set1_pd(mLevelCount);
+  const __m256d infinity = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+  const __m256i evenLanes = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6); // picks the low halves of four 64 bit masks
+  const bool handleNan = mNanHandling != nhNone;
+  const __m128i nanColor = _mm_set1_epi32(int(nanColorRgb()));
+  int i = 0;
+  for (; i+4<=n; i+=4)
+  {
+    const double *values = data+i*dataIndexFactor;
+    const __m256d value = dataIndexFactor == 1 ? _mm256_loadu_pd(values) : _mm256_setr_pd(values[0], values[dataIndexFactor], values[2*dataIndexFactor], values[3*dataIndexFactor]);
+    
+    __m256d position;
+    if (!logarithmic)
+      position = _mm256_mul_pd(_mm256_sub_pd(value, lower), factor);
+    else
+    {
+      const __m256d ratio = _mm256_div_pd(value, lower);
+      const __m256d tooSmall = _mm256_cmp_pd(ratio, _mm256_set1_pd(std::numeric_limits<double>::min()), _CMP_LT_OQ); // zero, negative or denormal
+      const __m256d tooLarge = _mm256_cmp_pd(ratio, _mm256_set1_pd(std::numeric_limits<double>::max()), _CMP_GT_OQ);
+      position = _mm256_mul_pd(qcpLnAvx2(ratio), factor);
+      position = _mm256_blendv_pd(position, _mm256_sub_pd(zero, infinity), tooSmall);
+      position = _mm256_blendv_pd(position, infinity, tooLarge);
+    }
+    if (mPeriodic)
+    {
+      const __m256d truncated = _mm256_round_pd(position, _MM_FROUND_TO_ZERO | _MM_FROUND_NO_EXC); // like the int conversion of the portable loop
+      position = _mm256_sub_pd(truncated, _mm256_mul_pd(levelCount, _mm256_floor_pd(_mm256_div_pd(truncated, levelCount))));
+    }
+    position = _mm256_min_pd(_mm256_max_pd(position, zero), maxIndex); // max returns zero for NaN positions, so the index is always valid
+    
+    __m128i color = _mm_i32gather_epi32(colorBuffer, _mm256_cvttpd_epi32(position), 4);
+    if (handleNan)
+    {
+      const __m256i nan = _mm256_castpd_si256(_mm256_cmp_pd(value, value, _CMP_UNORD_Q));
+      color = _mm_blendv_epi8(color, nanColor, _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(nan, evenLanes)));
+    }
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(scanLine+i), color);
+  }
+  return i;
+}
+#endif
 /* end of 'src/colorgradient.cpp' */
 
 
@@ -17544,7 +19719,8 @@ QCPAxisRect::QCPAxisRect(QCustomPlot *parentPlot, bool setupDefaultAxes) :
   mRangeZoom(Qt::Horizontal|Qt::Vertical),
   mRangeZoomFactorHorz(0.85),
   mRangeZoomFactorVert(0.85),
-  mDragging(false)
+  mDragging(false),
+  mPendingWheelSteps(0)
 {
   mInsetLayout->initializeParentPlot(mParentPlot);
   mInsetLayout->setParentLayerable(this);
@@ -18659,30 +20835,64 @@ void QCPAxisRect::wheelEvent(QWheelEvent *event)
   {
     if (mRangeZoom != 0)
     {
-      double factor;
       double wheelSteps = delta/120.0; // a single step delta is +/-120 usually
-      if (mRangeZoom.testFlag(Qt::Horizontal))
+      if (mParentPlot->plottingHints().testFlag(QCP::phFrameScheduling))
       {
-        factor = qPow(mRangeZoomFactorHorz, wheelSteps);
-        foreach (QPointer<QCPAxis> axis, mRangeZoomHorzAxis)
-        {
-          if (!axis.isNull())
-            axis->scaleRange(factor, axis->pixelToCoord(pos.x()));
-        }
-      }
-      if (mRangeZoom.testFlag(Qt::Vertical))
+        // collect wheel steps until the next frame, they are applied as one zoom in applyPendingWheelZoom:
+        mPendingWheelSteps += wheelSteps;
+        mPendingWheelPos = pos;
+        mParentPlot->replot(QCustomPlot::rpQueuedReplot);
+      } else
       {
-        factor = qPow(mRangeZoomFactorVert, wheelSteps);
-        foreach (QPointer<QCPAxis> axis, mRangeZoomVertAxis)
-        {
-          if (!axis.isNull())
-            axis->scaleRange(factor, axis->pixelToCoord(pos.y()));
-        }
+        zoomByWheelSteps(wheelSteps, pos);
+        mParentPlot->replot();
       }
-      mParentPlot->replot();
     }
   }
 }
+
+/*! \internal
+
+  Scales the ranges of the range zoom axes (\ref setRangeZoomAxes) by the range zoom factors to the
+  power of \a wheelSteps, around the pixel position \a pos.
+*/
+void QCPAxisRect::zoomByWheelSteps(double wheelSteps, const QPointF &pos)
+{
+  double factor;
+  if (mRangeZoom.testFlag(Qt::Horizontal))
+  {
+    factor = qPow(mRangeZoomFactorHorz, wheelSteps);
+    foreach (QPointer<QCPAxis> axis, mRangeZoomHorzAxis)
+    {
+      if (!axis.isNull())
+        axis->scaleRange(factor, axis->pixelToCoord(pos.x()));
+    }
+  }
+  if (mRangeZoom.testFlag(Qt::Vertical))
+  {
+    factor = qPow(mRangeZoomFactorVert, wheelSteps);
+    foreach (QPointer<QCPAxis> axis, mRangeZoomVertAxis)
+    {
+      if (!axis.isNull())
+        axis->scaleRange(factor, axis->pixelToCoord(pos.y()));
+    }
+  }
+}
+
+/*! \internal
+
+  Applies the wheel steps collected by \ref wheelEvent since the last replot as a single zoom
+  operation, around the most recent wheel position. This is called by \ref QCustomPlot::replot
+  before the replot, when the plotting hint \ref QCP::phFrameScheduling is set.
+*/
+void QCPAxisRect::applyPendingWheelZoom()
+{
+  if (qFuzzyIsNull(mPendingWheelSteps))
+    return;
+  const double wheelSteps = mPendingWheelSteps;
+  mPendingWheelSteps = 0;
+  zoomByWheelSteps(wheelSteps, mPendingWheelPos);
+}
 /* end of 'src/layoutelements/layoutelement-axisrect.cpp' */
 
 
@@ -20862,7 +23072,14 @@ QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   QCPAbstractPlottable1D<QCPGraphData>(keyAxis, valueAxis),
   mLineStyle{},
   mScatterSkip{},
-  mAdaptiveSampling{}
+  mAdaptiveSampling{},
+  mDensityScatter(false),
+  mDensityGradient(QCPColorGradient::gpThermal),
+  mDensitySpriteLimit(0),
+  mPrepared(false),
+  mPrepareUnselectedScatters(false),
+  mPrepareSelectedScatters(false),
+  mLayerReplotCount(0)
 {
   // special handling for QCPGraphs to maintain the simple graph interface:
   mParentPlot->registerGraph(this);
@@ -20874,6 +23091,7 @@ QCPGraph::QCPGraph(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   setScatterSkip(0);
   setChannelFillGraph(nullptr);
   setAdaptiveSampling(true);
+  setDensitySpriteLimit(2000);
 }
 
 QCPGraph::~QCPGraph()
@@ -20898,6 +23116,11 @@ QCPGraph::~QCPGraph()
 void QCPGraph::setData(QSharedPointer<QCPGraphDataContainer> data)
 {
   mDataContainer = data;
+  // the caches are keyed on the data revision, which a different container may have as well:
+  mHitTestGrid.clear();
+  mHitTestSignature.clear();
+  mWideLineOutline = QPainterPath();
+  mWideLineSignature.clear();
 }
 
 /*! \overload
@@ -21019,12 +23242,61 @@ void QCPGraph::setChannelFillGraph(QCPGraph *targetGraph)
   sampling off. For example, when saving the plot to disk. This can be achieved by setting \a
   enabled to false before issuing a command like \ref QCustomPlot::savePng, and setting \a enabled
   back to true afterwards.
+  
+  With adaptive sampling enabled, the pixel points of line and step plots are additionally reduced
+  right before painting, such that vertices in the same pixel column or far outside the axis rect
+  aren't handed to QPainter (see \ref simplifyLines).
 */
 void QCPGraph::setAdaptiveSampling(bool enabled)
 {
   mAdaptiveSampling = enabled;
 }
 
+/*!
+  Sets whether the scatters of this graph shall be rendered as a density image instead of drawing
+  each scatter symbol individually.
+
+  In density mode, all data points of a segment are binned into a per-pixel count buffer of the
+  axis rect (concurrently, if the visible data is large enough). The counts are then mapped through
+  the \ref setDensityGradient "density gradient" on a logarithmic scale and drawn as one image.
+  Pixels without data stay transparent. If only few pixels are occupied (see \ref
+  setDensitySpriteLimit), the scatter symbol of the current scatter style is instead rendered once
+  and stamped at every occupied pixel. Either way, the cost of painting is bounded by the number of
+  pixels of the axis rect and no longer by the number of data points, which makes this mode
+  suitable for scatter plots with millions of points.
+
+  Density mode only takes effect if a scatter style is set (\ref setScatterStyle). The \ref
+  setScatterSkip "scatter skip" is ignored, since every data point contributes to the density.
+*/
+void QCPGraph::setDensityScatter(bool enabled)
+{
+  mDensityScatter = enabled;
+}
+
+/*!
+  Sets the color gradient that maps the number of data points per pixel to a color, when \ref
+  setDensityScatter "density scatter mode" is enabled. The lowest gradient color is used for pixels
+  with a single data point, the highest for the pixel with the most data points.
+
+  The default gradient is \ref QCPColorGradient::gpThermal.
+*/
+void QCPGraph::setDensityGradient(const QCPColorGradient &gradient)
+{
+  mDensityGradient = gradient;
+}
+
+/*!
+  Sets the number of occupied pixels up to which the density scatter mode (\ref setDensityScatter)
+  stamps the scatter symbol at each occupied pixel, rather than drawing the colored density image.
+  This keeps sparse regions of the data recognizable as individual scatters.
+
+  Set \a pixels to 0 to always draw the density image. The default is 2000.
+*/
+void QCPGraph::setDensitySpriteLimit(int pixels)
+{
+  mDensitySpriteLimit = qMax(0, pixels);
+}
+
 /*! \overload
   
   Adds the provided points in \a keys and \a values to the current data. The provided vectors
@@ -21109,6 +23381,54 @@ double QCPGraph::selectTest(const QPointF &pos, bool onlySelectable, QVariant *d
     return -1;
 }
 
+/*!
+  \copydoc QCPPlottableInterface1D::selectTestRect
+
+  For graphs with many data points, this uses the hit test grid also used by \ref selectTest, so
+  only the data points in cells on the border of \a rect need to be tested individually.
+*/
+QCPDataSelection QCPGraph::selectTestRect(const QRectF &rect, bool onlySelectable) const
+{
+  QCPDataSelection result;
+  if ((onlySelectable && mSelectable == QCP::stNone) || mDataContainer->isEmpty())
+    return result;
+  if (!mKeyAxis || !mValueAxis)
+    return result;
+  
+  const QRectF normRect = rect.normalized();
+  if (!updateHitTestGrid() || !QRectF(mHitTestGrid.rect()).contains(normRect))
+    return QCPAbstractPlottable1D<QCPGraphData>::selectTestRect(rect, onlySelectable);
+  
+  QVector<QCPDataRange> border;
+  mHitTestGrid.rangesInRect(normRect, &result, &border);
+  // test the data points of partially covered cells like QCPAbstractPlottable1D::selectTestRect:
+  double key1, value1, key2, value2;
+  pixelsToCoords(rect.topLeft(), key1, value1);
+  pixelsToCoords(rect.bottomRight(), key2, value2);
+  const QCPRange keyRange(key1, key2); // QCPRange normalizes internally so we don't have to care about whether key1 < key2
+  const QCPRange valueRange(value1, value2);
+  foreach (const QCPDataRange &run, border)
+  {
+    int currentSegmentBegin = -1; // -1 means we're currently not in a segment that's contained in rect
+    for (int i=run.begin(); i<run.end(); ++i)
+    {
+      QCPGraphDataContainer::const_iterator it = mDataContainer->constBegin()+i;
+      const bool contained = keyRange.contains(it->key) && valueRange.contains(it->value);
+      if (contained && currentSegmentBegin == -1)
+        currentSegmentBegin = i;
+      else if (!contained && currentSegmentBegin != -1)
+      {
+        result.addDataRange(QCPDataRange(currentSegmentBegin, i), false);
+        currentSegmentBegin = -1;
+      }
+    }
+    if (currentSegmentBegin != -1)
+      result.addDataRange(QCPDataRange(currentSegmentBegin, run.end()), false);
+  }
+  result.simplify();
+  return result;
+}
+
 /* inherits documentation from base class */
 QCPRange QCPGraph::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
 {
@@ -21134,12 +23454,20 @@ void QCPGraph::draw(QCPPainter *painter)
   QList<QCPDataRange> selectedSegments, unselectedSegments, allSegments;
   getDataSegments(selectedSegments, unselectedSegments);
   allSegments << unselectedSegments << selectedSegments;
+  const bool usePrepared = mPrepared && mPreparedLines.size() == allSegments.size(); // pixel data may already have been prepared concurrently, see QCustomPlot::prepareGraphs
+  QCPRenderProfiler *profiler = mParentPlot->renderProfiler();
+  QElapsedTimer paintTimer;
   for (int i=0; i<allSegments.size(); ++i)
   {
     bool isSelectedSegment = i >= unselectedSegments.size();
     // get line pixel points appropriate to line style:
-    QCPDataRange lineDataRange = isSelectedSegment ? allSegments.at(i) : allSegments.at(i).adjusted(-1, 1); // unselected segments extend lines to bordering selected data point (safe to exceed total data bounds in first/last segment, getLines takes care)
-    getLines(&lines, lineDataRange);
+    if (usePrepared)
+      lines = mPreparedLines.at(i);
+    else
+    {
+      QCPDataRange lineDataRange = isSelectedSegment ? allSegments.at(i) : allSegments.at(i).adjusted(-1, 1); // unselected segments extend lines to bordering selected data point (safe to exceed total data bounds in first/last segment, getLines takes care)
+      getLines(&lines, lineDataRange);
+    }
     
     // check data validity if flag set:
 #ifdef QCUSTOMPLOT_CHECK_DATA
@@ -21152,6 +23480,8 @@ void QCPGraph::draw(QCPPainter *painter)
 #endif
     
     // draw fill of graph:
+    if (profiler)
+      paintTimer.start();
     if (isSelectedSegment && mSelectionDecorator)
       mSelectionDecorator->applyBrush(painter);
     else
@@ -21170,8 +23500,22 @@ void QCPGraph::draw(QCPPainter *painter)
       if (mLineStyle == lsImpulse)
         drawImpulsePlot(painter, lines);
       else
-        drawLinePlot(painter, lines); // also step plots can be drawn as a line plot
+      {
+        if (allSegments.size() != 1 || !drawCachedWideLine(painter)) // wide lines without selection reuse their outline while the ranges are only moved
+        {
+          if (mAdaptiveSampling && mParentPlot->mVectorSampling == 0) // vector exports are decimated at a finer resolution by getLines
+          {
+            const int lineCount = lines.size();
+            simplifyLines(&lines, painter->pen().widthF());
+            if (profiler)
+              profiler->addPointCounts(this, 0, lines.size()-lineCount);
+          }
+          drawLinePlot(painter, lines); // also step plots can be drawn as a line plot
+        }
+      }
     }
+    if (profiler)
+      profiler->addStageTime(this, QCPRenderProfiler::stPainting, paintTimer);
     
     // draw scatters:
     QCPScatterStyle finalScatterStyle = mScatterStyle;
@@ -21179,10 +23523,23 @@ void QCPGraph::draw(QCPPainter *painter)
       finalScatterStyle = mSelectionDecorator->getFinalScatterStyle(mScatterStyle);
     if (!finalScatterStyle.isNone())
     {
-      getScatters(&scatters, allSegments.at(i));
-      drawScatterPlot(painter, scatters, finalScatterStyle);
+      if (mDensityScatter)
+        drawDensityScatterPlot(painter, allSegments.at(i), finalScatterStyle);
+      else
+      {
+        if (usePrepared)
+          scatters = mPreparedScatters.at(i);
+        else
+          getScatters(&scatters, allSegments.at(i));
+        if (profiler)
+          paintTimer.start();
+        drawScatterPlot(painter, scatters, finalScatterStyle);
+      }
+      if (profiler)
+        profiler->addStageTime(this, QCPRenderProfiler::stPainting, paintTimer);
     }
   }
+  discardPreparedDraw();
   
   // draw other selection decoration that isn't just line/scatter pens and brushes:
   if (mSelectionDecorator)
@@ -21247,8 +23604,14 @@ void QCPGraph::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
 void QCPGraph::getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const
 {
   if (!lines) return;
+  QCPRenderProfiler *profiler = mParentPlot->renderProfiler();
+  QElapsedTimer stageTimer;
+  if (profiler)
+    stageTimer.start();
   QCPGraphDataContainer::const_iterator begin, end;
   getVisibleDataBounds(begin, end, dataRange);
+  if (profiler)
+    profiler->addStageTime(this, QCPRenderProfiler::stVisibleRange, stageTimer);
   if (begin == end)
   {
     lines->clear();
@@ -21257,7 +23620,16 @@ void QCPGraph::getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange)
   
   QVector<QCPGraphData> lineData;
   if (mLineStyle != lsNone)
-    getOptimizedLineData(&lineData, begin, end);
+  {
+    if (mParentPlot->mVectorSampling > 0) // drawing a vector export, see QCustomPlot::setVectorExportResolution
+      getDecimatedLineData(&lineData, begin, end, mParentPlot->mVectorSampling);
+    else if (mParentPlot->mInteractiveSampling > 0) // interactive replot thinned to its time budget, see QCustomPlot::setFrameTimeBudget
+      getDecimatedLineData(&lineData, begin, end, mParentPlot->mInteractiveSampling);
+    else
+      getOptimizedLineData(&lineData, begin, end);
+  }
+  if (profiler)
+    profiler->addStageTime(this, QCPRenderProfiler::stSampling, stageTimer);
   
   if (mKeyAxis->rangeReversed() != (mKeyAxis->orientation() == Qt::Vertical)) // make sure key pixels are sorted ascending in lineData (significantly simplifies following processing)
     std::reverse(lineData.begin(), lineData.end());
@@ -21271,6 +23643,11 @@ void QCPGraph::getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange)
     case lsStepCenter: *lines = dataToStepCenterLines(lineData); break;
     case lsImpulse: *lines = dataToImpulseLines(lineData); break;
   }
+  if (profiler)
+  {
+    profiler->addStageTime(this, QCPRenderProfiler::stTransform, stageTimer);
+    profiler->addPointCounts(this, int(end-begin), lines->size());
+  }
 }
 
 /*! \internal
@@ -21292,8 +23669,14 @@ void QCPGraph::getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataR
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; scatters->clear(); return; }
   
+  QCPRenderProfiler *profiler = mParentPlot->renderProfiler();
+  QElapsedTimer stageTimer;
+  if (profiler)
+    stageTimer.start();
   QCPGraphDataContainer::const_iterator begin, end;
   getVisibleDataBounds(begin, end, dataRange);
+  if (profiler)
+    profiler->addStageTime(this, QCPRenderProfiler::stVisibleRange, stageTimer);
   if (begin == end)
   {
     scatters->clear();
@@ -21302,31 +23685,29 @@ void QCPGraph::getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataR
   
   QVector<QCPGraphData> data;
   getOptimizedScatterData(&data, begin, end);
+  if (profiler)
+    profiler->addStageTime(this, QCPRenderProfiler::stSampling, stageTimer);
   
   if (mKeyAxis->rangeReversed() != (mKeyAxis->orientation() == Qt::Vertical)) // make sure key pixels are sorted ascending in data (significantly simplifies following processing)
     std::reverse(data.begin(), data.end());
   
-  scatters->resize(data.size());
-  if (keyAxis->orientation() == Qt::Vertical)
+  *scatters = dataToLines(data);
+  // data points with NaN values have no scatter:
+  int kept = 0;
+  for (int i=0; i<data.size(); ++i)
   {
-    for (int i=0; i<data.size(); ++i)
-    {
-      if (!qIsNaN(data.at(i).value))
-      {
-        (*scatters)[i].setX(valueAxis->coordToPixel(data.at(i).value));
-        (*scatters)[i].setY(keyAxis->coordToPixel(data.at(i).key));
-      }
-    }
-  } else
+    if (!qIsNaN(data.at(i).value))
+      (*scatters)[kept++] = scatters->at(i);
+  }
+  scatters->resize(kept);
+  if (mParentPlot->mVectorSampling > 0) // drawing a vector export, see QCustomPlot::setVectorExportResolution
+    decimateScatters(scatters, mParentPlot->mVectorSampling);
+  else if (mParentPlot->mInteractiveSampling > 0) // interactive replot thinned to its time budget, see QCustomPlot::setFrameTimeBudget
+    decimateScatters(scatters, mParentPlot->mInteractiveSampling);
+  if (profiler)
   {
-    for (int i=0; i<data.size(); ++i)
-    {
-      if (!qIsNaN(data.at(i).value))
-      {
-        (*scatters)[i].setX(keyAxis->coordToPixel(data.at(i).key));
-        (*scatters)[i].setY(valueAxis->coordToPixel(data.at(i).value));
-      }
-    }
+    profiler->addStageTime(this, QCPRenderProfiler::stTransform, stageTimer);
+    profiler->addPointCounts(this, 0, scatters->size()); // the visible data points were already counted by getLines
   }
 }
 
@@ -21348,22 +23729,21 @@ QVector<QPointF> QCPGraph::dataToLines(const QVector<QCPGraphData> &data) const
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
 
   result.resize(data.size());
+  if (data.isEmpty())
+    return result;
   
-  // transform data points to pixels:
+  // transform data points to pixels, keys and values are converted directly between the interleaved members:
+  Q_STATIC_ASSERT(sizeof(QCPGraphData) == 2*sizeof(double) && sizeof(QPointF) == 2*sizeof(qreal));
+  const QCPGraphData *source = data.constData();
+  QPointF *target = result.data();
   if (keyAxis->orientation() == Qt::Vertical)
   {
-    for (int i=0; i<data.size(); ++i)
-    {
-      result[i].setX(valueAxis->coordToPixel(data.at(i).value));
-      result[i].setY(keyAxis->coordToPixel(data.at(i).key));
-    }
+    valueAxis->coordsToPixels(&source->value, &target->rx(), data.size(), 2, 2);
+    keyAxis->coordsToPixels(&source->key, &target->ry(), data.size(), 2, 2);
   } else // key axis is horizontal
   {
-    for (int i=0; i<data.size(); ++i)
-    {
-      result[i].setX(keyAxis->coordToPixel(data.at(i).key));
-      result[i].setY(valueAxis->coordToPixel(data.at(i).value));
-    }
+    keyAxis->coordsToPixels(&source->key, &target->rx(), data.size(), 2, 2);
+    valueAxis->coordsToPixels(&source->value, &target->ry(), data.size(), 2, 2);
   }
   return result;
 }
@@ -21385,30 +23765,31 @@ QVector<QPointF> QCPGraph::dataToStepLeftLines(const QVector<QCPGraphData> &data
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
   
-  result.resize(data.size()*2);
+  const QVector<QPointF> points = dataToLines(data);
+  result.resize(points.size()*2);
   
-  // calculate steps from data and transform to pixel coordinates:
+  // calculate steps from the data points in pixel coordinates:
   if (keyAxis->orientation() == Qt::Vertical)
   {
-    double lastValue = valueAxis->coordToPixel(data.first().value);
-    for (int i=0; i<data.size(); ++i)
+    double lastValue = points.first().x();
+    for (int i=0; i<points.size(); ++i)
     {
-      const double key = keyAxis->coordToPixel(data.at(i).key);
+      const double key = points.at(i).y();
       result[i*2+0].setX(lastValue);
       result[i*2+0].setY(key);
-      lastValue = valueAxis->coordToPixel(data.at(i).value);
+      lastValue = points.at(i).x();
       result[i*2+1].setX(lastValue);
       result[i*2+1].setY(key);
     }
   } else // key axis is horizontal
   {
-    double lastValue = valueAxis->coordToPixel(data.first().value);
-    for (int i=0; i<data.size(); ++i)
+    double lastValue = points.first().y();
+    for (int i=0; i<points.size(); ++i)
     {
-      const double key = keyAxis->coordToPixel(data.at(i).key);
+      const double key = points.at(i).x();
       result[i*2+0].setX(key);
       result[i*2+0].setY(lastValue);
-      lastValue = valueAxis->coordToPixel(data.at(i).value);
+      lastValue = points.at(i).y();
       result[i*2+1].setX(key);
       result[i*2+1].setY(lastValue);
     }
@@ -21433,30 +23814,31 @@ QVector<QPointF> QCPGraph::dataToStepRightLines(const QVector<QCPGraphData> &dat
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
   
-  result.resize(data.size()*2);
+  const QVector<QPointF> points = dataToLines(data);
+  result.resize(points.size()*2);
   
-  // calculate steps from data and transform to pixel coordinates:
+  // calculate steps from the data points in pixel coordinates:
   if (keyAxis->orientation() == Qt::Vertical)
   {
-    double lastKey = keyAxis->coordToPixel(data.first().key);
-    for (int i=0; i<data.size(); ++i)
+    double lastKey = points.first().y();
+    for (int i=0; i<points.size(); ++i)
     {
-      const double value = valueAxis->coordToPixel(data.at(i).value);
+      const double value = points.at(i).x();
       result[i*2+0].setX(value);
       result[i*2+0].setY(lastKey);
-      lastKey = keyAxis->coordToPixel(data.at(i).key);
+      lastKey = points.at(i).y();
       result[i*2+1].setX(value);
       result[i*2+1].setY(lastKey);
     }
   } else // key axis is horizontal
   {
-    double lastKey = keyAxis->coordToPixel(data.first().key);
-    for (int i=0; i<data.size(); ++i)
+    double lastKey = points.first().x();
+    for (int i=0; i<points.size(); ++i)
     {
-      const double value = valueAxis->coordToPixel(data.at(i).value);
+      const double value = points.at(i).y();
       result[i*2+0].setX(lastKey);
       result[i*2+0].setY(value);
-      lastKey = keyAxis->coordToPixel(data.at(i).key);
+      lastKey = points.at(i).x();
       result[i*2+1].setX(lastKey);
       result[i*2+1].setY(value);
     }
@@ -21481,45 +23863,46 @@ QVector<QPointF> QCPGraph::dataToStepCenterLines(const QVector<QCPGraphData> &da
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
   
-  result.resize(data.size()*2);
+  const QVector<QPointF> points = dataToLines(data);
+  result.resize(points.size()*2);
   
-  // calculate steps from data and transform to pixel coordinates:
+  // calculate steps from the data points in pixel coordinates:
   if (keyAxis->orientation() == Qt::Vertical)
   {
-    double lastKey = keyAxis->coordToPixel(data.first().key);
-    double lastValue = valueAxis->coordToPixel(data.first().value);
+    double lastKey = points.first().y();
+    double lastValue = points.first().x();
     result[0].setX(lastValue);
     result[0].setY(lastKey);
-    for (int i=1; i<data.size(); ++i)
+    for (int i=1; i<points.size(); ++i)
     {
-      const double key = (keyAxis->coordToPixel(data.at(i).key)+lastKey)*0.5;
+      const double key = (points.at(i).y()+lastKey)*0.5;
       result[i*2-1].setX(lastValue);
       result[i*2-1].setY(key);
-      lastValue = valueAxis->coordToPixel(data.at(i).value);
-      lastKey = keyAxis->coordToPixel(data.at(i).key);
+      lastValue = points.at(i).x();
+      lastKey = points.at(i).y();
       result[i*2+0].setX(lastValue);
       result[i*2+0].setY(key);
     }
-    result[data.size()*2-1].setX(lastValue);
-    result[data.size()*2-1].setY(lastKey);
+    result[points.size()*2-1].setX(lastValue);
+    result[points.size()*2-1].setY(lastKey);
   } else // key axis is horizontal
   {
-    double lastKey = keyAxis->coordToPixel(data.first().key);
-    double lastValue = valueAxis->coordToPixel(data.first().value);
+    double lastKey = points.first().x();
+    double lastValue = points.first().y();
     result[0].setX(lastKey);
     result[0].setY(lastValue);
-    for (int i=1; i<data.size(); ++i)
+    for (int i=1; i<points.size(); ++i)
     {
-      const double key = (keyAxis->coordToPixel(data.at(i).key)+lastKey)*0.5;
+      const double key = (points.at(i).x()+lastKey)*0.5;
       result[i*2-1].setX(key);
       result[i*2-1].setY(lastValue);
-      lastValue = valueAxis->coordToPixel(data.at(i).value);
-      lastKey = keyAxis->coordToPixel(data.at(i).key);
+      lastValue = points.at(i).y();
+      lastKey = points.at(i).x();
       result[i*2+0].setX(key);
       result[i*2+0].setY(lastValue);
     }
-    result[data.size()*2-1].setX(lastKey);
-    result[data.size()*2-1].setY(lastValue);
+    result[points.size()*2-1].setX(lastKey);
+    result[points.size()*2-1].setY(lastValue);
   }
   return result;
 }
@@ -21541,28 +23924,26 @@ QVector<QPointF> QCPGraph::dataToImpulseLines(const QVector<QCPGraphData> &data)
   QCPAxis *valueAxis = mValueAxis.data();
   if (!keyAxis || !valueAxis) { qDebug() << Q_FUNC_INFO << "invalid key or value axis"; return result; }
   
-  result.resize(data.size()*2);
+  const QVector<QPointF> points = dataToLines(data);
+  result.resize(points.size()*2);
   
-  // transform data points to pixels:
+  // add the zero value base point to each data point in pixel coordinates:
+  const double zeroPixel = valueAxis->coordToPixel(0);
   if (keyAxis->orientation() == Qt::Vertical)
   {
-    for (int i=0; i<data.size(); ++i)
+    for (int i=0; i<points.size(); ++i)
     {
-      const double key = keyAxis->coordToPixel(data.at(i).key);
-      result[i*2+0].setX(valueAxis->coordToPixel(0));
-      result[i*2+0].setY(key);
-      result[i*2+1].setX(valueAxis->coordToPixel(data.at(i).value));
-      result[i*2+1].setY(key);
+      result[i*2+0].setX(zeroPixel);
+      result[i*2+0].setY(points.at(i).y());
+      result[i*2+1] = points.at(i);
     }
   } else // key axis is horizontal
   {
-    for (int i=0; i<data.size(); ++i)
+    for (int i=0; i<points.size(); ++i)
     {
-      const double key = keyAxis->coordToPixel(data.at(i).key);
-      result[i*2+0].setX(key);
-      result[i*2+0].setY(valueAxis->coordToPixel(0));
-      result[i*2+1].setX(key);
-      result[i*2+1].setY(valueAxis->coordToPixel(data.at(i).value));
+      result[i*2+0].setX(points.at(i).x());
+      result[i*2+0].setY(zeroPixel);
+      result[i*2+1] = points.at(i);
     }
   }
   return result;
@@ -21589,6 +23970,7 @@ void QCPGraph::drawFill(QCPPainter *painter, QVector<QPointF> *lines) const
 {
   if (mLineStyle == lsImpulse) return; // fill doesn't make sense for impulse plot
   if (painter->brush().style() == Qt::NoBrush || painter->brush().color().alpha() == 0) return;
+  if (mParentPlot->qualityLevel() >= QCustomPlot::qlNoFills) return; // interactive replot over its time budget, see QCustomPlot::setFrameTimeBudget
   
   applyFillAntialiasingHint(painter);
   const QVector<QCPDataRange> segments = getNonNanSegments(lines, keyAxis()->orientation());
@@ -21621,10 +24003,97 @@ void QCPGraph::drawFill(QCPPainter *painter, QVector<QPointF> *lines) const
 */
 void QCPGraph::drawScatterPlot(QCPPainter *painter, const QVector<QPointF> &scatters, const QCPScatterStyle &style) const
 {
+  QCPScatterStyle finalStyle = style;
+  if (mParentPlot->qualityLevel() >= QCustomPlot::qlNoScatterShapes) // interactive replot over its time budget, see QCustomPlot::setFrameTimeBudget
+    finalStyle.setShape(QCPScatterStyle::ssDot);
   applyScattersAntialiasingHint(painter);
-  style.applyTo(painter, mPen);
+  finalStyle.applyTo(painter, mPen);
   foreach (const QPointF &scatter, scatters)
-    style.drawShape(painter, scatter.x(), scatter.y());
+    finalStyle.drawShape(painter, scatter.x(), scatter.y());
+}
+
+/*! \internal
+
+  Draws the data points of \a dataRange as a density image, see \ref setDensityScatter.
+
+  The per-pixel counts are obtained with \ref getScatterDensity. If at most \ref
+  setDensitySpriteLimit pixels are occupied, a sprite of the scatter symbol defined by \a style is
+  rendered once and drawn at the center of each occupied pixel. Otherwise the counts are mapped
+  through the density gradient with a logarithmic scale, from one data point up to the maximum
+  count, and drawn as a single image covering the axis rect.
+
+  \see drawScatterPlot
+*/
+void QCPGraph::drawDensityScatterPlot(QCPPainter *painter, const QCPDataRange &dataRange, const QCPScatterStyle &style) const
+{
+  const QRect axisRect = mKeyAxis->axisRect()->rect();
+  const bool keyIsHorizontal = mKeyAxis->orientation() == Qt::Horizontal;
+  const int keySize = keyIsHorizontal ? axisRect.width() : axisRect.height();
+  const int valueSize = keyIsHorizontal ? axisRect.height() : axisRect.width();
+  if (keySize <= 0 || valueSize <= 0)
+    return;
+  
+  QVector<quint32> density;
+  getScatterDensity(&density, dataRange, keySize, valueSize);
+  quint32 maxCount = 0;
+  int occupiedPixels = 0;
+  for (int i=0; i<density.size(); ++i)
+  {
+    if (density.at(i) > 0)
+    {
+      ++occupiedPixels;
+      if (density.at(i) > maxCount)
+        maxCount = density.at(i);
+    }
+  }
+  if (occupiedPixels == 0)
+    return;
+  
+  if (occupiedPixels <= mDensitySpriteLimit)
+  {
+    // render scatter symbol once and stamp it at every occupied pixel:
+    const double penWidth = qMax(1.0, style.isPenDefined() ? style.pen().widthF() : mPen.widthF());
+    const int spriteSize = style.shape() == QCPScatterStyle::ssPixmap ? qMax(style.pixmap().width(), style.pixmap().height()) : qCeil(style.size()+2*penWidth)+2;
+    QPixmap sprite(spriteSize, spriteSize);
+    sprite.fill(Qt::transparent);
+    {
+      QCPPainter spritePainter(&sprite);
+      applyScattersAntialiasingHint(&spritePainter);
+      style.applyTo(&spritePainter, mPen);
+      style.drawShape(&spritePainter, spriteSize/2.0, spriteSize/2.0);
+    }
+    const QPointF spriteOffset(spriteSize/2.0-0.5, spriteSize/2.0-0.5); // sprite center lands on pixel center
+    for (int i=0; i<density.size(); ++i)
+    {
+      if (density.at(i) == 0)
+        continue;
+      const int keyPixel = i/valueSize;
+      const int valuePixel = i%valueSize;
+      const QPointF pixel = keyIsHorizontal ? QPointF(axisRect.left()+keyPixel, axisRect.top()+valuePixel) : QPointF(axisRect.left()+valuePixel, axisRect.top()+keyPixel);
+      painter->drawPixmap(pixel-spriteOffset, sprite);
+    }
+  } else
+  {
+    // map counts through density gradient, empty pixels stay transparent:
+    QImage image(axisRect.size(), QImage::Format_ARGB32_Premultiplied);
+    QCPColorGradient gradient(mDensityGradient);
+    const QCPRange countRange(1, qMax(maxCount, quint32(2)));
+    const int lineWidth = image.width();
+    QVector<double> counts(lineWidth);
+    QVector<unsigned char> alpha(lineWidth);
+    for (int y=0; y<image.height(); ++y)
+    {
+      // density buffer is key-major, so for a horizontal key axis a scan line runs across keys, otherwise across values
+      for (int x=0; x<lineWidth; ++x)
+      {
+        const quint32 count = keyIsHorizontal ? density.at(x*valueSize+y) : density.at(y*valueSize+x);
+        counts[x] = count;
+        alpha[x] = count > 0 ? 255 : 0;
+      }
+      gradient.colorize(counts.constData(), alpha.constData(), countRange, reinterpret_cast<QRgb*>(image.scanLine(y)), lineWidth, 1, true);
+    }
+    painter->drawImage(axisRect.topLeft(), image);
+  }
 }
 
 /*!  \internal
@@ -21642,6 +24111,260 @@ void QCPGraph::drawLinePlot(QCPPainter *painter, const QVector<QPointF> &lines)
   }
 }
 
+/*! \internal
+
+  Draws the line of a graph with a wide pen (more than 1 pixel) by filling a cached outline of the
+  line, instead of stroking the line anew in every replot. This is used by \ref draw when no data
+  is selected, and returns false if the line must be drawn by \ref drawLinePlot instead, i.e. for
+  thin pens, impulse plots, logarithmic axes and exports.
+
+  The outline is built for the data within the visible ranges extended by half their size on every
+  side, with dashes already generated by \ref QCPPainter::dashPolyline. As long as the ranges are
+  only moved within that area (e.g. by dragging) and neither the data, the pen, the line style nor
+  the axis rect size changed, the outline is just translated to the new position.
+*/
+bool QCPGraph::drawCachedWideLine(QCPPainter *painter)
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (painter->modes().testFlag(QCPPainter::pmVectorized) || painter->modes().testFlag(QCPPainter::pmNoCaching))
+    return false;
+  const QPen pen = painter->pen();
+  if (pen.style() == Qt::NoPen || pen.isCosmetic() || pen.widthF() <= 1.0 || pen.brush().style() == Qt::NoBrush ||
+      mLineStyle == lsImpulse || keyAxis->scaleType() != QCPAxis::stLinear || valueAxis->scaleType() != QCPAxis::stLinear)
+  {
+    if (!mWideLineSignature.isEmpty())
+    {
+      mWideLineOutline = QPainterPath();
+      mWideLineSignature.clear();
+    }
+    return false;
+  }
+  
+  const QCPRange keyRange = keyAxis->range();
+  const QCPRange valueRange = valueAxis->range();
+  QVector<double> signature;
+  signature << keyAxis->rangeReversed() << valueAxis->rangeReversed() << keyAxis->orientation()
+            << keyAxis->axisRect()->width() << keyAxis->axisRect()->height() << mLineStyle << mAdaptiveSampling
+            << pen.widthF() << pen.style() << pen.capStyle() << pen.joinStyle() << pen.miterLimit() << pen.dashOffset()
+            << double(mDataContainer->revision());
+  foreach (qreal length, pen.dashPattern())
+    signature << length;
+  // a moved range may differ from the previous size by rounding, so the sizes are compared with a tolerance:
+  const bool sameSize = !mWideLineSignature.isEmpty() &&
+      qAbs(keyRange.size()-mWideLineKeyRange.size()/2.0) <= 1e-9*keyRange.size() &&
+      qAbs(valueRange.size()-mWideLineValueRange.size()/2.0) <= 1e-9*valueRange.size();
+  if (!sameSize || signature != mWideLineSignature ||
+      keyRange.lower < mWideLineKeyRange.lower || keyRange.upper > mWideLineKeyRange.upper ||
+      valueRange.lower < mWideLineValueRange.lower || valueRange.upper > mWideLineValueRange.upper)
+  {
+    mWideLineSignature = signature;
+    mWideLineKeyRange = QCPRange(keyRange.lower-keyRange.size()/2.0, keyRange.upper+keyRange.size()/2.0);
+    mWideLineValueRange = QCPRange(valueRange.lower-valueRange.size()/2.0, valueRange.upper+valueRange.size()/2.0);
+    mWideLineOrigin = coordsToPixels(mWideLineKeyRange.lower, mWideLineValueRange.lower);
+    const QRectF area = QRectF(mWideLineOrigin, coordsToPixels(mWideLineKeyRange.upper, mWideLineValueRange.upper)).normalized();
+    
+    // get the line of the covered key range, like getLines does for the visible one:
+    QVector<QCPGraphData> lineData;
+    getOptimizedLineData(&lineData, mDataContainer->findBegin(mWideLineKeyRange.lower), mDataContainer->findEnd(mWideLineKeyRange.upper));
+    if (keyAxis->rangeReversed() != (keyAxis->orientation() == Qt::Vertical))
+      std::reverse(lineData.begin(), lineData.end());
+    QVector<QPointF> lines;
+    switch (mLineStyle)
+    {
+      case lsStepLeft: lines = dataToStepLeftLines(lineData); break;
+      case lsStepRight: lines = dataToStepRightLines(lineData); break;
+      case lsStepCenter: lines = dataToStepCenterLines(lineData); break;
+      default: lines = dataToLines(lineData); break;
+    }
+    if (mAdaptiveSampling)
+      simplifyLines(&lines, pen.widthF(), area);
+    if (pen.style() != Qt::SolidLine)
+      lines = QCPPainter::dashPolyline(lines, pen, area.adjusted(-pen.widthF(), -pen.widthF(), pen.widthF(), pen.widthF()));
+    
+    QPainterPath path;
+    bool gap = true;
+    for (int i=0; i<lines.size(); ++i)
+    {
+      const QPointF &point = lines.at(i);
+      if (qIsNaN(point.x()) || qIsNaN(point.y()) || qIsInf(point.y()))
+        gap = true;
+      else if (gap)
+      {
+        path.moveTo(point);
+        gap = false;
+      } else
+        path.lineTo(point);
+    }
+    QPainterPathStroker stroker;
+    stroker.setWidth(pen.widthF());
+    stroker.setCapStyle(pen.capStyle());
+    stroker.setJoinStyle(pen.joinStyle());
+    stroker.setMiterLimit(pen.miterLimit());
+    mWideLineOutline = stroker.createStroke(path);
+  }
+  
+  const QPointF offset = coordsToPixels(mWideLineKeyRange.lower, mWideLineValueRange.lower)-mWideLineOrigin;
+  applyDefaultAntialiasingHint(painter);
+  painter->translate(offset);
+  painter->fillPath(mWideLineOutline, pen.brush());
+  painter->translate(-offset);
+  return true;
+}
+
+/*! \internal
+
+  Reduces the pixel points \a lines of a line or step plot, as returned by \ref getLines, to the
+  vertices that make a visible difference when drawn with a pen of \a penWidth. This keeps the
+  number of vertices handed to QPainter bounded by the size of the axis rect, no matter how many
+  data points are visible:
+
+  \li Consecutive vertices in the same pixel column (on the key axis) are merged into the first,
+  the lowest, the highest and the last of them, so vertical extremes are preserved. Of these, a
+  vertex in the same pixel row as its predecessor is dropped.
+  \li Consecutive vertices that lie outside the axis rect (extended by a margin for the pen) on a
+  common side only contribute invisible segments, so only the first and last of them are kept.
+  If \a area is given, it is used instead of the axis rect.
+
+  NaN vertices, which separate line segments, are always kept. The vertices are classified with
+  \ref classifyLineVertices, which uses AVX2 instructions where available.
+*/
+void QCPGraph::simplifyLines(QVector<QPointF> *lines, double penWidth, const QRectF &area) const
+{
+  const int count = lines->size();
+  if (count < 8)
+    return;
+  const double margin = qMax(1.0, penWidth)+1.0;
+  const QRectF clipRect = (area.isEmpty() ? QRectF(mKeyAxis.data()->axisRect()->rect()) : area).adjusted(-margin, -margin, margin, margin);
+  const bool keyIsX = mKeyAxis.data()->orientation() == Qt::Horizontal;
+  const QPointF *points = lines->constData();
+  QVector<int> columns(count), outcodes(count);
+  int classified = 0;
+#ifdef QCP_AVX2_DISPATCH
+  static const bool haveAvx2 = __builtin_cpu_supports("avx2");
+  if (haveAvx2 && sizeof(qreal) == sizeof(double))
+    classified = classifyLineVerticesAvx2(points, count, clipRect, keyIsX, columns.data(), outcodes.data());
+#endif
+  classifyLineVertices(points+classified, count-classified, clipRect, keyIsX, columns.data()+classified, outcodes.data()+classified);
+  
+  // merge runs of vertices in the same pixel column into their first, lowest, highest and last vertex:
+  QVector<int> kept;
+  kept.reserve(qMin(count, 4*int(keyIsX ? clipRect.width() : clipRect.height())+16));
+  int i = 0;
+  while (i < count)
+  {
+    if (outcodes.at(i) == ocNaN)
+    {
+      kept.append(i++);
+      continue;
+    }
+    int end = i+1, minIndex = i, maxIndex = i;
+    double minValue = keyIsX ? points[i].y() : points[i].x();
+    double maxValue = minValue;
+    while (end < count && columns.at(end) == columns.at(i) && outcodes.at(end) != ocNaN)
+    {
+      const double value = keyIsX ? points[end].y() : points[end].x();
+      if (value < minValue) { minValue = value; minIndex = end; }
+      if (value > maxValue) { maxValue = value; maxIndex = end; }
+      ++end;
+    }
+    const int candidates[4] = {i, qMin(minIndex, maxIndex), qMax(minIndex, maxIndex), end-1};
+    double lastRow = 0;
+    for (int k=0; k<4; ++k)
+    {
+      if (k > 0 && candidates[k] == candidates[k-1])
+        continue;
+      const double row = std::floor(keyIsX ? points[candidates[k]].y() : points[candidates[k]].x());
+      if (k > 0 && row == lastRow)
+        continue;
+      kept.append(candidates[k]);
+      lastRow = row;
+    }
+    i = end;
+  }
+  
+  // of runs of vertices outside the clip rect on a common side, only the segments entering and leaving are visible:
+  QVector<QPointF> result;
+  result.reserve(kept.size());
+  int k = 0;
+  while (k < kept.size())
+  {
+    int common = outcodes.at(kept.at(k));
+    int last = k;
+    if (common != 0 && common != ocNaN)
+    {
+      while (last+1 < kept.size() && (common & outcodes.at(kept.at(last+1))) != 0)
+        common &= outcodes.at(kept.at(++last));
+    }
+    result.append(points[kept.at(k)]);
+    if (last > k)
+      result.append(points[kept.at(last)]);
+    k = last+1;
+  }
+  *lines = result;
+}
+
+/*! \internal
+
+  Determines for each of the \a count vertices in \a points the pixel column on the key axis,
+  which is written to \a columns, and its position relative to \a clipRect as combination of \ref
+  LineVertexOutcode, which is written to \a outcodes. Columns beyond the range of int are set to
+  the smallest int.
+*/
+void QCPGraph::classifyLineVertices(const QPointF *points, int count, const QRectF &clipRect, bool keyIsX, int *columns, int *outcodes)
+{
+  const double left = clipRect.left(), right = clipRect.right(), top = clipRect.top(), bottom = clipRect.bottom();
+  for (int i=0; i<count; ++i)
+  {
+    const double x = points[i].x();
+    const double y = points[i].y();
+    const double key = std::floor(keyIsX ? x : y);
+    columns[i] = key >= -2147483648.0 && key <= 2147483647.0 ? int(key) : std::numeric_limits<int>::min();
+    if (qIsNaN(x) || qIsNaN(y))
+      outcodes[i] = ocNaN;
+    else
+      outcodes[i] = (x < left ? ocLeft : 0) | (x > right ? ocRight : 0) | (y < top ? ocTop : 0) | (y > bottom ? ocBottom : 0);
+  }
+}
+
+#ifdef QCP_AVX2_DISPATCH
+/*! \internal
+
+  Does the same as \ref classifyLineVertices for groups of four vertices, with AVX2 instructions.
+  Returns the number of vertices that were classified, the remaining ones must be passed to \ref
+  classifyLineVertices. This method may only be called if the CPU supports AVX2 and qreal is
+  double.
+*/
+__attribute__((target("avx2")))
+int QCPGraph::classifyLineVerticesAvx2(const QPointF *points, int count, const QRectF &clipRect, bool keyIsX, int *columns, int *outcodes)
+{
+  const double *coords = reinterpret_cast<const double*>(points);
+  const __m256d left = _mm256_set1_pd(clipRect.left());
+  const __m256d right = _mm256_set1_pd(clipRect.right());
+  const __m256d top = _mm256_set1_pd(clipRect.top());
+  const __m256d bottom = _mm256_set1_pd(clipRect.bottom());
+  int i = 0;
+  for (; i+4<=count; i+=4)
+  {
+    const __m256d a = _mm256_loadu_pd(coords+2*i);
+    const __m256d b = _mm256_loadu_pd(coords+2*i+4);
+    const __m256d x = _mm256_unpacklo_pd(a, b); // vertices in order 0, 2, 1, 3
+    const __m256d y = _mm256_unpackhi_pd(a, b);
+    // build the outcodes as doubles from the comparison masks, vertices with a NaN coordinate only get ocNaN:
+    const __m256d nan = _mm256_or_pd(_mm256_cmp_pd(x, x, _CMP_UNORD_Q), _mm256_cmp_pd(y, y, _CMP_UNORD_Q));
+    const __m256d code = _mm256_blendv_pd(_mm256_add_pd(_mm256_and_pd(_mm256_cmp_pd(x, left, _CMP_LT_OQ), _mm256_set1_pd(ocLeft)),
+                         _mm256_add_pd(_mm256_and_pd(_mm256_cmp_pd(x, right, _CMP_GT_OQ), _mm256_set1_pd(ocRight)),
+                         _mm256_add_pd(_mm256_and_pd(_mm256_cmp_pd(y, top, _CMP_LT_OQ), _mm256_set1_pd(ocTop)),
+                                       _mm256_and_pd(_mm256_cmp_pd(y, bottom, _CMP_GT_OQ), _mm256_set1_pd(ocBottom))))), _mm256_set1_pd(ocNaN), nan);
+    const __m128i codes = _mm256_cvtpd_epi32(code);
+    const __m128i cols = _mm256_cvttpd_epi32(_mm256_floor_pd(keyIsX ? x : y)); // out of range and NaN give the smallest int
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(outcodes+i), _mm_shuffle_epi32(codes, _MM_SHUFFLE(3, 1, 2, 0)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(columns+i), _mm_shuffle_epi32(cols, _MM_SHUFFLE(3, 1, 2, 0)));
+  }
+  return i;
+}
+#endif
+
 /*! \internal
 
   Draws impulses from the provided data, i.e. it connects all line pairs in \a lines, given in
@@ -21940,6 +24663,115 @@ void QCPGraph::getOptimizedScatterData(QVector<QCPGraphData> *scatterData, QCPGr
   }
 }
 
+/*! \internal
+
+  Returns via \a lineData the data points between \a begin and \a end that are needed to draw the
+  graph line with \a samplesPerPixel samples per pixel along the key axis. This is used instead of
+  \ref getOptimizedLineData when drawing vector exports (see \ref
+  QCustomPlot::setVectorExportResolution), independently of \ref setAdaptiveSampling.
+
+  Unlike adaptive sampling, only real data points are returned: Of the data points that fall into
+  the same sample interval, the first one, the one with the lowest value, the one with the highest
+  value and the last one are kept, in their original order. Data points with NaN values are
+  always kept, so gaps in the line are preserved.
+*/
+void QCPGraph::getDecimatedLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end, double samplesPerPixel) const
+{
+  if (!lineData) return;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  if (!keyAxis) { qDebug() << Q_FUNC_INFO << "invalid key axis"; return; }
+  if (begin == end) return;
+  
+  const int dataCount = int(end-begin);
+  const double intervalCount = qAbs(keyAxis->coordToPixel(begin->key)-keyAxis->coordToPixel((end-1)->key))*samplesPerPixel+1;
+  if (dataCount < 4*intervalCount) // at most four data points are kept per interval, so there's nothing to gain
+  {
+    lineData->resize(dataCount);
+    std::copy(begin, end, lineData->begin());
+    return;
+  }
+  
+  lineData->reserve(int(qMin(4*intervalCount, double(dataCount)))+16);
+  const QCPGraphData *data = &*begin;
+  int first = -1, minIndex = 0, maxIndex = 0; // data indices of the open interval, first is -1 if there is none
+  double interval = 0;
+  // appends the first, lowest, highest and last data point of the open interval, which ends before index:
+  auto closeInterval = [&](int index)
+  {
+    if (first < 0)
+      return;
+    const int candidates[4] = {first, qMin(minIndex, maxIndex), qMax(minIndex, maxIndex), index-1};
+    for (int k=0; k<4; ++k)
+    {
+      if (k == 0 || candidates[k] != candidates[k-1])
+        lineData->append(data[candidates[k]]);
+    }
+    first = -1;
+  };
+  
+  // convert the keys to pixels in chunks and assign the data points to intervals:
+  const int chunkSize = 4096;
+  QVector<double> pixels(chunkSize);
+  for (int chunkBegin=0; chunkBegin<dataCount; chunkBegin+=chunkSize)
+  {
+    const int count = qMin(chunkSize, dataCount-chunkBegin);
+    keyAxis->coordsToPixels(&data[chunkBegin].key, pixels.data(), count, 2, 1);
+    for (int k=0; k<count; ++k)
+    {
+      const int i = chunkBegin+k;
+      const double value = data[i].value;
+      if (qIsNaN(value)) // gap in the line
+      {
+        closeInterval(i);
+        lineData->append(data[i]);
+        continue;
+      }
+      const double pointInterval = std::floor(pixels.at(k)*samplesPerPixel);
+      if (first < 0 || pointInterval != interval)
+      {
+        closeInterval(i);
+        first = minIndex = maxIndex = i;
+        interval = pointInterval;
+      } else if (value < data[minIndex].value)
+        minIndex = i;
+      else if (value > data[maxIndex].value)
+        maxIndex = i;
+    }
+  }
+  closeInterval(dataCount);
+}
+
+/*! \internal
+
+  Reduces the scatter pixel positions in \a scatters to at most one per cell of 1/\a
+  samplesPerPixel pixels, i.e. one per device pixel when drawing a vector export at the resolution
+  set with \ref QCustomPlot::setVectorExportResolution. Scatters outside the axis rect (extended by
+  the scatter size) are removed as well, since they would be clipped anyway.
+*/
+void QCPGraph::decimateScatters(QVector<QPointF> *scatters, double samplesPerPixel) const
+{
+  const double margin = mScatterStyle.size();
+  const QRectF rect = QRectF(mKeyAxis.data()->axisRect()->rect()).adjusted(-margin, -margin, margin, margin);
+  const qint64 columns = qint64(std::ceil(rect.width()*samplesPerPixel))+1;
+  const qint64 rows = qint64(std::ceil(rect.height()*samplesPerPixel))+1;
+  if (columns*rows > (std::numeric_limits<int>::max)()) // too many cells to mark them in a bit array, keep all scatters
+    return;
+  QBitArray occupied(int(columns*rows));
+  int kept = 0;
+  for (int i=0; i<scatters->size(); ++i)
+  {
+    const QPointF pos = scatters->at(i);
+    if (!rect.contains(pos))
+      continue;
+    const int cell = int((pos.y()-rect.top())*samplesPerPixel)*int(columns) + int((pos.x()-rect.left())*samplesPerPixel);
+    if (occupied.testBit(cell))
+      continue;
+    occupied.setBit(cell);
+    (*scatters)[kept++] = pos;
+  }
+  scatters->resize(kept);
+}
+
 /*!
   This method outputs the currently visible data range via \a begin and \a end. The returned range
   will also never exceed \a rangeRestriction.
@@ -21968,6 +24800,155 @@ void QCPGraph::getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin
   }
 }
 
+/*! \internal
+
+  Decides, in the GUI thread, which parts of the pixel data \ref prepareDraw will need to compute
+  for the upcoming replot. This is done here because the scatter styles of the graph and its
+  selection decorator may hold pixmaps, which must not be copied outside the GUI thread.
+
+  Returns false if the graph has nothing to draw, in which case \ref prepareDraw shouldn't be
+  called.
+
+  \see QCustomPlot::prepareGraphs
+*/
+bool QCPGraph::initPreparedDraw()
+{
+  discardPreparedDraw();
+  if (!mKeyAxis || !mValueAxis) return false;
+  if (mKeyAxis.data()->range().size() <= 0 || mDataContainer->isEmpty()) return false;
+  if (mLineStyle == lsNone && mScatterStyle.isNone()) return false;
+  
+  mPrepareUnselectedScatters = !mScatterStyle.isNone() && !mDensityScatter; // density scatters are binned in draw, see drawDensityScatterPlot
+  mPrepareSelectedScatters = mSelectionDecorator && !mDensityScatter ? !mSelectionDecorator->getFinalScatterStyle(mScatterStyle).isNone() : mPrepareUnselectedScatters;
+  return true;
+}
+
+/*! \internal
+
+  Counts the data points of \a dataRange per pixel of the axis rect, for \ref
+  drawDensityScatterPlot. \a density is resized to \a keySize times \a valueSize entries and stored
+  key-major, i.e. the count of the pixel at key offset \a k and value offset \a v (both relative to
+  the top left corner of the axis rect) is at index <tt>k*valueSize+v</tt>. Data points outside the
+  axis rect or with NaN coordinates are not counted.
+
+  Large data ranges are split into chunks that are binned concurrently. Since the data is sorted by
+  key, each chunk only covers a narrow band of key pixels. It counts into a private buffer for that
+  band, which is afterwards added to \a density. This keeps the memory and merge overhead
+  proportional to the number of pixels, rather than to the number of chunks times the number of
+  pixels.
+*/
+void QCPGraph::getScatterDensity(QVector<quint32> *density, const QCPDataRange &dataRange, int keySize, int valueSize) const
+{
+  if (!density) return;
+  density->fill(0, keySize*valueSize);
+  QCPGraphDataContainer::const_iterator begin, end;
+  getVisibleDataBounds(begin, end, dataRange);
+  if (begin == end)
+    return;
+  
+  const QCPAxis *keyAxis = mKeyAxis.data();
+  const QCPAxis *valueAxis = mValueAxis.data();
+  const QRect axisRect = keyAxis->axisRect()->rect();
+  const bool keyIsHorizontal = keyAxis->orientation() == Qt::Horizontal;
+  const double keyOrigin = keyIsHorizontal ? axisRect.left() : axisRect.top();
+  const double valueOrigin = keyIsHorizontal ? axisRect.top() : axisRect.left();
+  
+  struct DensityChunk
+  {
+    QCPGraphDataContainer::const_iterator begin, end;
+    int keyLower, keyUpper;
+    QVector<quint32> counts;
+  };
+  const int minimumChunkSize = 65536;
+  const int dataCount = int(end-begin);
+  const int chunkCount = qBound(1, dataCount/minimumChunkSize, 4*qMax(1, QThread::idealThreadCount()));
+  QVector<DensityChunk> chunks(chunkCount);
+  for (int i=0; i<chunkCount; ++i)
+  {
+    chunks[i].begin = begin + int(qint64(dataCount)*i/chunkCount);
+    chunks[i].end = begin + int(qint64(dataCount)*(i+1)/chunkCount);
+  }
+  
+  auto binChunk = [=](DensityChunk &chunk)
+  {
+    // data is sorted by key, so the first and last data point bound the key pixels of this chunk:
+    const double firstKeyPixel = keyAxis->coordToPixel(chunk.begin->key)-keyOrigin;
+    const double lastKeyPixel = keyAxis->coordToPixel((chunk.end-1)->key)-keyOrigin;
+    if (qIsNaN(firstKeyPixel) || qIsNaN(lastKeyPixel))
+    {
+      chunk.keyLower = 0;
+      chunk.keyUpper = keySize-1;
+    } else
+    {
+      chunk.keyLower = int(qBound(0.0, std::floor(qMin(firstKeyPixel, lastKeyPixel)), keySize-1.0));
+      chunk.keyUpper = int(qBound(0.0, std::floor(qMax(firstKeyPixel, lastKeyPixel)), keySize-1.0));
+    }
+    chunk.counts.fill(0, (chunk.keyUpper-chunk.keyLower+1)*valueSize);
+    quint32 *counts = chunk.counts.data();
+    for (QCPGraphDataContainer::const_iterator it=chunk.begin; it!=chunk.end; ++it)
+    {
+      const double keyPixel = keyAxis->coordToPixel(it->key)-keyOrigin;
+      const double valuePixel = valueAxis->coordToPixel(it->value)-valueOrigin;
+      if (keyPixel >= chunk.keyLower && keyPixel < chunk.keyUpper+1 && valuePixel >= 0 && valuePixel < valueSize) // also rejects NaN
+        ++counts[(int(keyPixel)-chunk.keyLower)*valueSize + int(valuePixel)];
+    }
+  };
+  if (chunkCount > 1)
+    QtConcurrent::blockingMap(chunks, binChunk);
+  else
+    binChunk(chunks[0]);
+  
+  // add the key pixel bands of all chunks to the full density buffer:
+  quint32 *result = density->data();
+  foreach (const DensityChunk &chunk, chunks)
+  {
+    quint32 *target = result + chunk.keyLower*valueSize;
+    const quint32 *source = chunk.counts.constData();
+    const int n = chunk.counts.size();
+    for (int i=0; i<n; ++i)
+      target[i] += source[i];
+  }
+}
+
+/*! \internal
+
+  Computes the line and scatter pixel data of all data segments exactly like \ref draw would, and
+  keeps them until the next call of \ref draw, which then only needs to paint them.
+
+  This method doesn't modify anything but the prepared buffers of this graph, and only reads from
+  the data container and the axes. This allows \ref QCustomPlot::prepareGraphs to call it for
+  multiple graphs concurrently. \ref initPreparedDraw must have been called beforehand.
+*/
+void QCPGraph::prepareDraw()
+{
+  QList<QCPDataRange> selectedSegments, unselectedSegments, allSegments;
+  getDataSegments(selectedSegments, unselectedSegments);
+  allSegments << unselectedSegments << selectedSegments;
+  mPreparedLines.resize(allSegments.size());
+  mPreparedScatters.resize(allSegments.size());
+  for (int i=0; i<allSegments.size(); ++i)
+  {
+    bool isSelectedSegment = i >= unselectedSegments.size();
+    QCPDataRange lineDataRange = isSelectedSegment ? allSegments.at(i) : allSegments.at(i).adjusted(-1, 1); // same extension of unselected segments as in draw
+    getLines(&mPreparedLines[i], lineDataRange);
+    if (isSelectedSegment ? mPrepareSelectedScatters : mPrepareUnselectedScatters)
+      getScatters(&mPreparedScatters[i], allSegments.at(i));
+  }
+  mPrepared = true;
+}
+
+/*! \internal
+
+  Releases the pixel data stored by \ref prepareDraw. Subsequent calls to \ref draw compute the
+  pixel data themselves again.
+*/
+void QCPGraph::discardPreparedDraw()
+{
+  mPrepared = false;
+  mPreparedLines.clear();
+  mPreparedScatters.clear();
+}
+
 /*!  \internal
   
   This method goes through the passed points in \a lineData and returns a list of the segments
@@ -22410,8 +25391,65 @@ double QCPGraph::pointDistance(const QPointF &pixelPoint, QCPGraphDataContainer:
   if (mLineStyle == lsNone && mScatterStyle.isNone())
     return -1.0;
   
+  // with many data points, only look at the cells of the hit test grid within the selection tolerance:
+  if (updateHitTestGrid() && mHitTestGrid.rect().contains(pixelPoint.toPoint()))
+  {
+    const double tolerance = mParentPlot->selectionTolerance();
+    double minDist = (std::numeric_limits<double>::max)();
+    const int index = mHitTestGrid.nearestPoint(pixelPoint, tolerance, &minDist);
+    if (index >= 0)
+      closestData = mDataContainer->constBegin()+index;
+    if (mLineStyle != lsNone)
+    {
+      const double lineDist = mHitTestGrid.polylineDistance(pixelPoint, tolerance);
+      if (lineDist >= 0 && lineDist < minDist)
+        minDist = lineDist;
+    }
+    if (index < 0 && minDist <= tolerance) // the line was hit between points further apart than the tolerance
+    {
+      double pointDistSqr;
+      closestData = nearestKeyWindowPoint(pixelPoint, pointDistSqr);
+    }
+    return minDist;
+  }
+  
   // calculate minimum distances to graph data points and find closestData iterator:
-  double minDistSqr = (std::numeric_limits<double>::max)();
+  double minDistSqr;
+  closestData = nearestKeyWindowPoint(pixelPoint, minDistSqr);
+    
+  // calculate distance to graph line if there is one (if so, will probably be smaller than distance to closest data point):
+  if (mLineStyle != lsNone)
+  {
+    // line displayed, calculate distance to line segments:
+    QVector<QPointF> lineData;
+    getLines(&lineData, QCPDataRange(0, dataCount())); // don't limit data range further since with sharp data spikes, line segments may be closer to test point than segments with closer key coordinate
+    QCPVector2D p(pixelPoint);
+    const int step = mLineStyle==lsImpulse ? 2 : 1; // impulse plot differs from other line styles in that the lineData points are only pairwise connected
+    for (int i=0; i<lineData.size()-1; i+=step)
+    {
+      const double currentDistSqr = p.distanceSquaredToLine(lineData.at(i), lineData.at(i+1));
+      if (currentDistSqr < minDistSqr)
+        minDistSqr = currentDistSqr;
+    }
+  }
+  
+  return qSqrt(minDistSqr);
+}
+
+/*! \internal
+
+  Returns the data point closest to \a pixelPoint among those with keys within the selection
+  tolerance around it, plus the nearest point on either side, and sets \a minDistSqr to its squared
+  pixel distance. If there is no such point, returns the end iterator of the data container and
+  sets \a minDistSqr to the largest double.
+
+  Used by \ref pointDistance, also to find the data point belonging to a hit of the graph line
+  between points that are further apart than the selection tolerance.
+*/
+QCPGraphDataContainer::const_iterator QCPGraph::nearestKeyWindowPoint(const QPointF &pixelPoint, double &minDistSqr) const
+{
+  QCPGraphDataContainer::const_iterator closestData = mDataContainer->constEnd();
+  minDistSqr = (std::numeric_limits<double>::max)();
   // determine which key range comes into question, taking selection tolerance around pos into account:
   double posKeyMin, posKeyMax, dummy;
   pixelsToCoords(pixelPoint-QPointF(mParentPlot->selectionTolerance(), mParentPlot->selectionTolerance()), posKeyMin, dummy);
@@ -22430,24 +25468,79 @@ double QCPGraph::pointDistance(const QPointF &pixelPoint, QCPGraphDataContainer:
       closestData = it;
     }
   }
-    
-  // calculate distance to graph line if there is one (if so, will probably be smaller than distance to closest data point):
-  if (mLineStyle != lsNone)
+  return closestData;
+}
+
+/*! \internal
+
+  Makes sure the hit test grid used by \ref pointDistance and \ref selectTestRect matches the
+  current axis ranges, axis rect and data, and rebuilds it if necessary. The grid holds the pixel
+  positions of the visible data points and of the graph line as it is drawn (see \ref
+  simplifyLines), so hit tests only need to look at a few grid cells instead of all visible data
+  points. It is rebuilt when the ranges or the data change, not on every mouse move.
+
+  Returns false if the graph has too few data points for the grid to pay off, in which case the
+  callers test all data points directly.
+*/
+bool QCPGraph::updateHitTestGrid() const
+{
+  QCPAxis *keyAxis = mKeyAxis.data();
+  QCPAxis *valueAxis = mValueAxis.data();
+  if (!keyAxis || !valueAxis || mDataContainer->size() < 20000) // testing all data points is fast enough for small graphs
   {
-    // line displayed, calculate distance to line segments:
-    QVector<QPointF> lineData;
-    getLines(&lineData, QCPDataRange(0, dataCount())); // don't limit data range further since with sharp data spikes, line segments may be closer to test point than segments with closer key coordinate
-    QCPVector2D p(pixelPoint);
-    const int step = mLineStyle==lsImpulse ? 2 : 1; // impulse plot differs from other line styles in that the lineData points are only pairwise connected
-    for (int i=0; i<lineData.size()-1; i+=step)
+    if (!mHitTestGrid.isEmpty())
     {
-      const double currentDistSqr = p.distanceSquaredToLine(lineData.at(i), lineData.at(i+1));
-      if (currentDistSqr < minDistSqr)
-        minDistSqr = currentDistSqr;
+      mHitTestGrid.clear();
+      mHitTestSignature.clear();
     }
+    return false;
   }
   
-  return qSqrt(minDistSqr);
+  const int tolerance = mParentPlot->selectionTolerance();
+  const QRect gridRect = keyAxis->axisRect()->rect().adjusted(-tolerance, -tolerance, tolerance, tolerance);
+  QVector<double> signature;
+  signature << keyAxis->range().lower << keyAxis->range().upper << valueAxis->range().lower << valueAxis->range().upper
+            << keyAxis->scaleType() << valueAxis->scaleType() << keyAxis->rangeReversed() << valueAxis->rangeReversed()
+            << keyAxis->orientation() << mLineStyle << mAdaptiveSampling << mPen.widthF() << double(mDataContainer->revision());
+  if (signature == mHitTestSignature && gridRect == mHitTestGrid.rect())
+    return true;
+  
+  mHitTestGrid.reset(gridRect, qMax(4, tolerance));
+  // add the pixel positions of the visible data points in chunks, converted like in dataToLines:
+  Q_STATIC_ASSERT(sizeof(QCPGraphData) == 2*sizeof(double) && sizeof(QPointF) == 2*sizeof(qreal));
+  QCPGraphDataContainer::const_iterator begin, end;
+  getVisibleDataBounds(begin, end, QCPDataRange(0, dataCount()));
+  const int beginIndex = int(begin-mDataContainer->constBegin());
+  const int endIndex = int(end-mDataContainer->constBegin());
+  const int chunkSize = 4096;
+  QVector<QPointF> pixels(chunkSize);
+  for (int index=beginIndex; index<endIndex; index+=chunkSize)
+  {
+    const int count = qMin(chunkSize, endIndex-index);
+    const QCPGraphData *source = &*(mDataContainer->constBegin()+index);
+    if (keyAxis->orientation() == Qt::Vertical)
+    {
+      valueAxis->coordsToPixels(&source->value, &pixels.data()->rx(), count, 2, 2);
+      keyAxis->coordsToPixels(&source->key, &pixels.data()->ry(), count, 2, 2);
+    } else // key axis is horizontal
+    {
+      keyAxis->coordsToPixels(&source->key, &pixels.data()->rx(), count, 2, 2);
+      valueAxis->coordsToPixels(&source->value, &pixels.data()->ry(), count, 2, 2);
+    }
+    mHitTestGrid.addPoints(pixels.constData(), count, index);
+  }
+  // add the graph line as it is drawn:
+  if (mLineStyle != lsNone)
+  {
+    QVector<QPointF> lines;
+    getLines(&lines, QCPDataRange(0, dataCount()));
+    if (mAdaptiveSampling && mLineStyle != lsImpulse)
+      simplifyLines(&lines, mPen.widthF());
+    mHitTestGrid.addPolyline(lines.constData(), lines.size(), mLineStyle == lsImpulse);
+  }
+  mHitTestGrid.finish();
+  mHitTestSignature = signature;
+  return true;
 }
 
 /*! \internal
@@ -22636,7 +25729,8 @@ QCPCurveData::QCPCurveData(double t, double key, double value) :
 QCPCurve::QCPCurve(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   QCPAbstractPlottable1D<QCPCurveData>(keyAxis, valueAxis),
   mScatterSkip{},
-  mLineStyle{}
+  mLineStyle{},
+  mAdaptiveSampling{}
 {
   // modify inherited properties from abstract plottable:
   setPen(QPen(Qt::blue, 0));
@@ -22645,6 +25739,7 @@ QCPCurve::QCPCurve(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   setScatterStyle(QCPScatterStyle());
   setLineStyle(lsLine);
   setScatterSkip(0);
+  setAdaptiveSampling(true);
 }
 
 QCPCurve::~QCPCurve()
@@ -22746,6 +25841,26 @@ void QCPCurve::setLineStyle(QCPCurve::LineStyle style)
   mLineStyle = style;
 }
 
+/*!
+  Sets whether adaptive sampling shall be used when plotting this curve. Like for \ref
+  QCPGraph::setAdaptiveSampling, this can drastically improve the replot performance of curves with
+  a large number of points, e.g. phase portraits or x-y traces of long recordings, without notably
+  changing their appearance.
+  
+  Since a curve may run in any direction, the sampling happens in screen space: Consecutive line
+  vertices that fall into the same pixel are merged into the first and the last of them. All
+  discarded segments lie inside that pixel, so the path stays continuous and deviates from the
+  original by less than a pixel, and so do fills. Of consecutive scatters in the same pixel, only
+  the first is drawn. When exporting to vector formats, the pixels are as fine as the vector export
+  resolution (see \ref QCustomPlot::setVectorExportResolution).
+  
+  By default, adaptive sampling is enabled.
+*/
+void QCPCurve::setAdaptiveSampling(bool enabled)
+{
+  mAdaptiveSampling = enabled;
+}
+
 /*! \overload
   
   Adds the provided points in \a t, \a keys and \a values to the current data. The provided vectors
@@ -22908,6 +26023,12 @@ void QCPCurve::draw(QCPPainter *painter)
     
     QCPDataRange lineDataRange = isSelectedSegment ? allSegments.at(i) : allSegments.at(i).adjusted(-1, 1); // unselected segments extend lines to bordering selected data point (safe to exceed total data bounds in first/last segment, getCurveLines takes care)
     getCurveLines(&lines, lineDataRange, finalCurvePen.widthF());
+    if (mAdaptiveSampling || mParentPlot->mInteractiveSampling > 0)
+    {
+      mergePixelRuns(&lines, true);
+      if (QCPRenderProfiler *profiler = mParentPlot->renderProfiler())
+        profiler->addPointCounts(this, lineDataRange.bounded(QCPDataRange(0, mDataContainer->size())).size(), lines.size());
+    }
     
     // check data validity if flag set:
   #ifdef QCUSTOMPLOT_CHECK_DATA
@@ -22926,7 +26047,8 @@ void QCPCurve::draw(QCPPainter *painter)
     else
       painter->setBrush(mBrush);
     painter->setPen(Qt::NoPen);
-    if (painter->brush().style() != Qt::NoBrush && painter->brush().color().alpha() != 0)
+    if (painter->brush().style() != Qt::NoBrush && painter->brush().color().alpha() != 0 &&
+        mParentPlot->qualityLevel() < QCustomPlot::qlNoFills) // fills are left out of interactive replots over their time budget
       painter->drawPolygon(QPolygonF(lines));
     
     // draw curve line:
@@ -23012,12 +26134,15 @@ void QCPCurve::drawCurveLine(QCPPainter *painter, const QVector<QPointF> &lines)
 */
 void QCPCurve::drawScatterPlot(QCPPainter *painter, const QVector<QPointF> &points, const QCPScatterStyle &style) const
 {
-  // draw scatter point symbols:
+  // draw scatter point symbols, as dots in interactive replots over their time budget:
+  QCPScatterStyle finalStyle = style;
+  if (mParentPlot->qualityLevel() >= QCustomPlot::qlNoScatterShapes)
+    finalStyle.setShape(QCPScatterStyle::ssDot);
   applyScattersAntialiasingHint(painter);
-  style.applyTo(painter, mPen);
+  finalStyle.applyTo(painter, mPen);
   foreach (const QPointF &point, points)
     if (!qIsNaN(point.x()) && !qIsNaN(point.y()))
-      style.drawShape(painter,  point);
+      finalStyle.drawShape(painter,  point);
 }
 
 /*! \internal
@@ -23028,7 +26153,9 @@ void QCPCurve::drawScatterPlot(QCPPainter *painter, const QVector<QPointF> &poin
   Line segments that aren't visible in the current axis rect are handled in an optimized way. They
   are projected onto a rectangle slightly larger than the visible axis rect and simplified
   regarding point count. The algorithm makes sure to preserve appearance of lines and fills inside
-  the visible axis rect by generating new temporary points on the outer rect if necessary.
+  the visible axis rect by generating new temporary points on the outer rect if necessary. The
+  points inside the visible rect are converted to pixels with \ref QCPAxis::coordsToPixels, one
+  call per run of consecutive data points.
 
   \a lines will be filled with points in pixel coordinates, that can be drawn with \ref
   drawCurveLine.
@@ -23071,6 +26198,21 @@ void QCPCurve::getCurveLines(QVector<QPointF> *lines, const QCPDataRange &dataRa
   QCPCurveDataContainer::const_iterator prevIt = itEnd-1;
   int prevRegion = getRegion(prevIt->key, prevIt->value, keyMin, valueMax, keyMax, valueMin);
   QVector<QPointF> trailingPoints; // points that must be applied after all other points (are generated only when handling first point to get virtual segment between last and first point right)
+  // points inside R are added as placeholders and converted to pixels afterwards, in runs of consecutive data points:
+  struct PixelRun { int lineIndex, dataIndex, count; };
+  QVector<PixelRun> runs;
+  auto appendInside = [&](const QCPCurveDataContainer::const_iterator &point)
+  {
+    const int dataIndex = int(point-mDataContainer->constBegin());
+    if (!runs.isEmpty() && runs.last().lineIndex+runs.last().count == lines->size() && runs.last().dataIndex+runs.last().count == dataIndex)
+      ++runs.last().count;
+    else
+    {
+      const PixelRun run = {lines->size(), dataIndex, 1};
+      runs.append(run);
+    }
+    lines->append(QPointF());
+  };
   while (it != itEnd)
   {
     const int currentRegion = getRegion(it->key, it->value, keyMin, valueMax, keyMax, valueMin);
@@ -23112,13 +26254,13 @@ void QCPCurve::getCurveLines(QVector<QPointF> *lines, const QCPDataRange &dataRa
           trailingPoints << getOptimizedPoint(prevRegion, prevIt->key, prevIt->value, it->key, it->value, keyMin, valueMax, keyMax, valueMin);
         else
           lines->append(getOptimizedPoint(prevRegion, prevIt->key, prevIt->value, it->key, it->value, keyMin, valueMax, keyMax, valueMin));
-        lines->append(coordsToPixels(it->key, it->value));
+        appendInside(it);
       }
     } else // region didn't change
     {
       if (currentRegion == 5) // still in R, keep adding original points
       {
-        lines->append(coordsToPixels(it->key, it->value));
+        appendInside(it);
       } else // still outside R, no need to add anything
       {
         // see how this is not doing anything? That's the main optimization...
@@ -23128,6 +26270,16 @@ void QCPCurve::getCurveLines(QVector<QPointF> *lines, const QCPDataRange &dataRa
     prevRegion = currentRegion;
     ++it;
   }
+  // fill in the placeholders, converting the key and value coordinates of each run at once:
+  Q_STATIC_ASSERT(sizeof(QCPCurveData) == 3*sizeof(double) && sizeof(QPointF) == 2*sizeof(qreal));
+  const bool keyIsVertical = keyAxis->orientation() == Qt::Vertical;
+  foreach (const PixelRun &run, runs)
+  {
+    const QCPCurveData *source = &*(mDataContainer->constBegin()+run.dataIndex);
+    QPointF *target = lines->data()+run.lineIndex;
+    keyAxis->coordsToPixels(&source->key, keyIsVertical ? &target->ry() : &target->rx(), run.count, 3, 2);
+    valueAxis->coordsToPixels(&source->value, keyIsVertical ? &target->rx() : &target->ry(), run.count, 3, 2);
+  }
   *lines << trailingPoints;
 }
 
@@ -23183,51 +26335,85 @@ void QCPCurve::getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataR
     ++itIndex;
     ++it;
   }
-  if (keyAxis->orientation() == Qt::Vertical)
+  // collect the coordinates of visible scatters in the order of pixel x and y, then transform them all at once:
+  const bool keyIsVertical = keyAxis->orientation() == Qt::Vertical;
+  QVector<double> coords;
+  while (it != end)
   {
-    while (it != end)
+    if (!qIsNaN(it->value) && keyRange.contains(it->key) && valueRange.contains(it->value))
     {
-      if (!qIsNaN(it->value) && keyRange.contains(it->key) && valueRange.contains(it->value))
-        scatters->append(QPointF(valueAxis->coordToPixel(it->value), keyAxis->coordToPixel(it->key)));
-      
-      // advance iterator to next (non-skipped) data point:
-      if (!doScatterSkip)
-        ++it;
-      else
-      {
-        itIndex += scatterModulo;
-        if (itIndex < endIndex) // make sure we didn't jump over end
-          it += scatterModulo;
-        else
-        {
-          it = end;
-          itIndex = endIndex;
-        }
-      }
+      coords.append(keyIsVertical ? it->value : it->key);
+      coords.append(keyIsVertical ? it->key : it->value);
     }
-  } else
-  {
-    while (it != end)
+    
+    // advance iterator to next (non-skipped) data point:
+    if (!doScatterSkip)
+      ++it;
+    else
     {
-      if (!qIsNaN(it->value) && keyRange.contains(it->key) && valueRange.contains(it->value))
-        scatters->append(QPointF(keyAxis->coordToPixel(it->key), valueAxis->coordToPixel(it->value)));
-      
-      // advance iterator to next (non-skipped) data point:
-      if (!doScatterSkip)
-        ++it;
+      itIndex += scatterModulo;
+      if (itIndex < endIndex) // make sure we didn't jump over end
+        it += scatterModulo;
       else
       {
-        itIndex += scatterModulo;
-        if (itIndex < endIndex) // make sure we didn't jump over end
-          it += scatterModulo;
-        else
-        {
-          it = end;
-          itIndex = endIndex;
-        }
+        it = end;
+        itIndex = endIndex;
       }
     }
   }
+  scatters->resize(coords.size()/2);
+  if (!scatters->isEmpty())
+  {
+    (keyIsVertical ? valueAxis : keyAxis)->coordsToPixels(coords.constData(), &scatters->data()->rx(), scatters->size(), 2, 2);
+    (keyIsVertical ? keyAxis : valueAxis)->coordsToPixels(coords.constData()+1, &scatters->data()->ry(), scatters->size(), 2, 2);
+  }
+  if (mAdaptiveSampling || mParentPlot->mInteractiveSampling > 0)
+    mergePixelRuns(scatters, false);
+}
+
+/*! \internal
+
+  Merges runs of consecutive \a points that fall into the same pixel, as done by adaptive sampling
+  (see \ref setAdaptiveSampling). Of each run, the first point is kept and, if \a keepLast is
+  true, also the last one. Since the pixel is convex, the segments between the points of a run lie
+  inside it, so for curve lines (\a keepLast true) the path stays continuous and every discarded
+  segment is within a pixel of the remaining ones.
+
+  While drawing a vector export, the pixels are subdivided according to the export resolution, and
+  while interactive replots are thinned (\ref QCustomPlot::qlThinned), runs span two pixels. NaN
+  points never belong to a run and are always kept.
+*/
+void QCPCurve::mergePixelRuns(QVector<QPointF> *points, bool keepLast) const
+{
+  const int count = points->size();
+  if (count < 3)
+    return;
+  double sampling = 1.0;
+  if (mParentPlot->mVectorSampling > 0)
+    sampling = mParentPlot->mVectorSampling;
+  else if (mParentPlot->mInteractiveSampling > 0) // interactive replot thinned to its time budget, see QCustomPlot::setFrameTimeBudget
+    sampling = mParentPlot->mInteractiveSampling;
+  QPointF *data = points->data();
+  int kept = 1; // the first point always starts a run
+  int runStart = 0;
+  double runX = std::floor(data[0].x()*sampling);
+  double runY = std::floor(data[0].y()*sampling);
+  for (int i=1; i<count; ++i)
+  {
+    const double x = std::floor(data[i].x()*sampling);
+    const double y = std::floor(data[i].y()*sampling);
+    if (x == runX && y == runY) // comparisons with NaN are false, so NaN points end runs
+      continue;
+    if (keepLast && i-1 > runStart)
+      data[kept++] = data[i-1];
+    data[kept++] = data[i];
+    runStart = i;
+    runX = x;
+    runY = y;
+  }
+  if (keepLast && count-1 > runStart)
+    data[kept++] = data[count-1];
+  points->resize(kept);
 }
 
 /*! \internal
@@ -25253,6 +28439,12 @@ QCPStatisticalBoxData::QCPStatisticalBoxData(double key, double minimum, double
   "addData" method or accessing the individual data points through \ref data, and setting the
   <tt>QVector<double> outliers</tt> of the data points directly.
   
+  The statistics of a set of samples can be computed with \ref boxStatistics, e.g. to add one box
+  per \ref DataSet with \ref addData(double, DataSet*). Alternatively, raw samples can be passed
+  with \ref setSourceData. The key range visible on the key axis is then divided into \ref
+  setBinCount bins, and the statistical box of the samples in each bin is computed, concurrently
+  for all bins. Whenever the key axis range changes, the boxes are recomputed for the visible bins.
+  
   \section qcpstatisticalbox-appearance Changing the appearance
   
   The appearance of each data point box, ranging from the lower to the upper quartile, is
@@ -25315,7 +28507,9 @@ QCPStatisticalBox::QCPStatisticalBox(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mWhiskerBarPen(Qt::black),
   mWhiskerAntialiased(false),
   mMedianPen(Qt::black, 3, Qt::SolidLine, Qt::FlatCap),
-  mOutlierStyle(QCPScatterStyle::ssCircle, Qt::blue, 6)
+  mOutlierStyle(QCPScatterStyle::ssCircle, Qt::blue, 6),
+  mBinCount(20),
+  mBinWidth(0)
 {
   setPen(QPen(Qt::black));
   setBrush(Qt::NoBrush);
@@ -25335,10 +28529,13 @@ QCPStatisticalBox::QCPStatisticalBox(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   the \ref QCPDataContainer<DataType>::set method on the statistical box data container directly:
   \snippet documentation/doc-code-snippets/mainwindow.cpp qcpstatisticalbox-datasharing-2
   
+  If source data was set with \ref setSourceData, it is released.
+  
   \see addData
 */
 void QCPStatisticalBox::setData(QSharedPointer<QCPStatisticalBoxDataContainer> data)
 {
+  mSourceData.clear();
   mDataContainer = data;
 }
 /*! \overload
@@ -25350,10 +28547,13 @@ void QCPStatisticalBox::setData(QSharedPointer<QCPStatisticalBoxDataContainer> d
   If you can guarantee that the passed data points are sorted by \a keys in ascending order, you
   can set \a alreadySorted to true, to improve performance by saving a sorting run.
   
+  If source data was set with \ref setSourceData, it is released.
+  
   \see addData
 */
 void QCPStatisticalBox::setData(const QVector<double> &keys, const QVector<double> &minimum, const QVector<double> &lowerQuartile, const QVector<double> &median, const QVector<double> &upperQuartile, const QVector<double> &maximum, bool alreadySorted)
 {
+  mSourceData.clear();
   mDataContainer->clear();
   addData(keys, minimum, lowerQuartile, median, upperQuartile, maximum, alreadySorted);
 }
@@ -25361,6 +28561,9 @@ void QCPStatisticalBox::setData(const QVector<double> &keys, const QVector<doubl
 /*!
   Sets the width of the boxes in key coordinates.
   
+  If the boxes are computed from source data (\ref setSourceData), \a width is a fraction of the
+  bin width instead, so the boxes follow the zoom level. The same applies to \ref setWhiskerWidth.
+  
   \see setWhiskerWidth
 */
 void QCPStatisticalBox::setWidth(double width)
@@ -25491,6 +28694,134 @@ void QCPStatisticalBox::addData(double key, double minimum, double lowerQuartile
   mDataContainer->add(QCPStatisticalBoxData(key, minimum, lowerQuartile, median, upperQuartile, maximum, outliers));
 }
 
+/*! \overload
+  
+  Adds a statistical box at \a key which summarizes the values (the second column) of the given \a
+  dataSet, as computed by \ref boxStatistics.
+*/
+void QCPStatisticalBox::addData(double key, DataSet *dataSet)
+{
+  QVector<double> samples(dataSet->Size());
+  for (int i=0; i<samples.size(); ++i)
+    samples[i] = dataSet->getPoint(i)[1];
+  mDataContainer->add(boxStatistics(key, std::move(samples)));
+}
+
+/*!
+  Sets the raw samples from which the statistical boxes are computed, one per key bin (see \ref
+  setBinCount). Since a QSharedPointer is used, the container may be shared with other plottables,
+  e.g. a \ref QCPGraph displaying the same samples.
+  
+  The boxes are computed at the next replot, and recomputed whenever the key axis range changes.
+  The selection then moves to the new boxes that overlap the key spans of the selected ones. After
+  modifying the source data, call \ref rebin, which clears the selection at the next replot.
+  Setting box data with \ref setData releases the source data.
+*/
+void QCPStatisticalBox::setSourceData(QSharedPointer<QCPGraphDataContainer> data)
+{
+  mSourceData = data;
+  mDataContainer = QSharedPointer<QCPStatisticalBoxDataContainer>(new QCPStatisticalBoxDataContainer); // don't overwrite a container that may be shared
+  rebin();
+}
+
+/*! \overload
+
+  Replaces the source data with the points of the given \a dataSet.
+*/
+void QCPStatisticalBox::setSourceData(DataSet *dataSet)
+{
+  QVector<QCPGraphData> points(dataSet->Size());
+  for (int i=0; i<points.size(); ++i)
+  {
+    const double *point = dataSet->getPoint(i);
+    points[i] = QCPGraphData(point[0], point[1]);
+  }
+  QSharedPointer<QCPGraphDataContainer> data(new QCPGraphDataContainer);
+  data->set(points);
+  setSourceData(data);
+}
+
+/*!
+  Sets into how many bins the visible key range is divided, if the boxes are computed from source
+  data (\ref setSourceData). The bins are aligned to multiples of the bin width, so they stay in
+  place while panning.
+*/
+void QCPStatisticalBox::setBinCount(int count)
+{
+  if (mBinCount != qMax(1, count))
+  {
+    mBinCount = qMax(1, count);
+    rebin();
+  }
+}
+
+/*!
+  Makes the statistical boxes be recomputed from the source data (\ref setSourceData) at the next
+  replot. Call this after modifying the source data container.
+*/
+void QCPStatisticalBox::rebin()
+{
+  mBinnedKeyRange = QCPRange(0, 0);
+  mBinWidth = 0;
+}
+
+/*!
+  Computes the statistical box of \a samples at \a key: the median, the quartiles, the whiskers
+  and the outliers. NaN samples are ignored. If there are no other samples, all values of the
+  returned box are NaN.
+  
+  The quartiles and the median are interpolated linearly between the neighbouring samples in sorted
+  order. The whiskers reach to the most extreme samples within 1.5 interquartile ranges from the
+  box, and the samples beyond are outliers.
+  
+  Instead of sorting, the required order statistics are found by selection (\c std::nth_element).
+  Each selection only partitions the part that the previous ones left unordered. So the time is
+  linear in the number of samples, and \a samples is reordered in place without further copies.
+  Pass it with \c std::move if the caller doesn't need it anymore.
+*/
+QCPStatisticalBoxData QCPStatisticalBox::boxStatistics(double key, QVector<double> samples)
+{
+  samples.erase(std::remove_if(samples.begin(), samples.end(), [](double sample) { return qIsNaN(sample); }), samples.end());
+  const int count = samples.size();
+  if (count == 0)
+    return QCPStatisticalBoxData(key, qQNaN(), qQNaN(), qQNaN(), qQNaN(), qQNaN());
+  double *data = samples.data();
+  
+  // select the median, then the lower quartile left of it and the upper quartile right of it. The order statistic
+  // following a selected one is the smallest element of the partition to its right:
+  const double medianPosition = 0.5*(count-1), lowerPosition = 0.25*(count-1), upperPosition = 0.75*(count-1);
+  const int medianIndex = int(medianPosition), lowerIndex = int(lowerPosition), upperIndex = int(upperPosition);
+  std::nth_element(data, data+medianIndex, data+count);
+  if (lowerIndex < medianIndex)
+    std::nth_element(data, data+lowerIndex, data+medianIndex);
+  if (upperIndex > medianIndex)
+    std::nth_element(data+medianIndex+1, data+upperIndex, data+count);
+  const double medianNext = medianIndex+1 < count ? *std::min_element(data+medianIndex+1, data+count) : data[medianIndex];
+  const double lowerNext = lowerIndex+1 < medianIndex ? *std::min_element(data+lowerIndex+1, data+medianIndex) : (lowerIndex < medianIndex ? data[medianIndex] : medianNext);
+  const double upperNext = upperIndex+1 < count ? *std::min_element(data+upperIndex+1, data+count) : data[upperIndex];
+  const double median = data[medianIndex]+(medianPosition-medianIndex)*(medianNext-data[medianIndex]);
+  const double lowerQuartile = data[lowerIndex]+(lowerPosition-lowerIndex)*(lowerNext-data[lowerIndex]);
+  const double upperQuartile = data[upperIndex]+(upperPosition-upperIndex)*(upperNext-data[upperIndex]);
+  
+  // whiskers and outliers, in one pass over all samples:
+  const double interquartileRange = upperQuartile-lowerQuartile;
+  const double lowerFence = lowerQuartile-1.5*interquartileRange;
+  const double upperFence = upperQuartile+1.5*interquartileRange;
+  double minimum = lowerQuartile, maximum = upperQuartile;
+  QVector<double> outliers;
+  for (int i=0; i<count; ++i)
+  {
+    const double sample = data[i];
+    if (sample < lowerFence || sample > upperFence)
+      outliers.append(sample);
+    else if (sample < minimum)
+      minimum = sample;
+    else if (sample > maximum)
+      maximum = sample;
+  }
+  return QCPStatisticalBoxData(key, minimum, lowerQuartile, median, upperQuartile, maximum, outliers);
+}
+
 /*!
   \copydoc QCPPlottableInterface1D::selectTestRect
 */
@@ -25575,6 +28906,8 @@ double QCPStatisticalBox::selectTest(const QPointF &pos, bool onlySelectable, QV
 /* inherits documentation from base class */
 QCPRange QCPStatisticalBox::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
 {
+  if (mSourceData) // the bins depend on the key range, so use the range of the samples
+    return mSourceData->keyRange(foundRange, inSignDomain);
   QCPRange range = mDataContainer->keyRange(foundRange, inSignDomain);
   // determine exact range by including width of bars/flags:
   if (foundRange)
@@ -25590,12 +28923,15 @@ QCPRange QCPStatisticalBox::getKeyRange(bool &foundRange, QCP::SignDomain inSign
 /* inherits documentation from base class */
 QCPRange QCPStatisticalBox::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
 {
+  if (mSourceData)
+    return mSourceData->valueRange(foundRange, inSignDomain, inKeyRange);
   return mDataContainer->valueRange(foundRange, inSignDomain, inKeyRange);
 }
 
 /* inherits documentation from base class */
 void QCPStatisticalBox::draw(QCPPainter *painter)
 {
+  updateBins();
   if (mDataContainer->isEmpty()) return;
   QCPAxis *keyAxis = mKeyAxis.data();
   QCPAxis *valueAxis = mValueAxis.data();
@@ -25681,7 +29017,8 @@ void QCPStatisticalBox::drawStatisticalBox(QCPPainter *painter, QCPStatisticalBo
   painter->save();
   painter->setClipRect(quartileBox, Qt::IntersectClip);
   painter->setPen(mMedianPen);
-  painter->drawLine(QLineF(coordsToPixels(it->key-mWidth*0.5, it->median), coordsToPixels(it->key+mWidth*0.5, it->median)));
+  const double halfWidth = mWidth*widthScale()*0.5;
+  painter->drawLine(QLineF(coordsToPixels(it->key-halfWidth, it->median), coordsToPixels(it->key+halfWidth, it->median)));
   painter->restore();
   // draw whisker lines:
   applyAntialiasingHint(painter, mWhiskerAntialiased, QCP::aePlottables);
@@ -25696,6 +29033,93 @@ void QCPStatisticalBox::drawStatisticalBox(QCPPainter *painter, QCPStatisticalBo
     outlierStyle.drawShape(painter, coordsToPixels(it->key, it->outliers.at(i)));
 }
 
+/*! \internal
+  
+  If the boxes are computed from source data (\ref setSourceData) and the key axis range changed
+  since they were last computed, recomputes them for the bins of the visible key range.
+  
+  The samples of each bin are found by binary search in the source data, which is sorted by key.
+  The bins are then processed concurrently, each copying only its own samples for \ref
+  boxStatistics. Empty bins don't get a box.
+*/
+void QCPStatisticalBox::updateBins()
+{
+  if (!mSourceData || !mKeyAxis)
+    return;
+  const QCPRange keyRange = mKeyAxis.data()->range();
+  if (keyRange == mBinnedKeyRange && mBinWidth > 0)
+    return;
+  // the selection refers to the current boxes, remember the key spans of the selected ones to select the new boxes overlapping them:
+  QVector<QCPRange> selectedSpans;
+  if (!mSelection.isEmpty() && mBinWidth > 0)
+  {
+    foreach (const QCPDataRange &range, mSelection.dataRanges())
+    {
+      if (range.begin() < mDataContainer->size())
+        selectedSpans.append(QCPRange(mDataContainer->at(range.begin())->key-mBinWidth*0.5, mDataContainer->at(qMin(range.end(), mDataContainer->size())-1)->key+mBinWidth*0.5));
+    }
+  }
+  mBinnedKeyRange = keyRange;
+  mBinWidth = keyRange.size()/mBinCount;
+  
+  struct Bin
+  {
+    QCPGraphDataContainer::const_iterator begin, end;
+    QCPStatisticalBoxData box;
+  };
+  QVector<Bin> bins;
+  const qint64 firstBin = qint64(std::floor(keyRange.lower/mBinWidth));
+  const qint64 lastBin = qint64(std::floor(keyRange.upper/mBinWidth));
+  for (qint64 index=firstBin; index<=lastBin; ++index)
+  {
+    Bin bin;
+    bin.begin = mSourceData->findBegin(index*mBinWidth, false);
+    bin.end = mSourceData->findBegin((index+1)*mBinWidth, false); // the bin is half-open, so use the begin of the next one
+    bin.box.key = (index+0.5)*mBinWidth;
+    if (bin.begin != bin.end)
+      bins.append(bin);
+  }
+  QtConcurrent::blockingMap(bins, [](Bin &bin)
+  {
+    QVector<double> samples;
+    samples.reserve(int(bin.end-bin.begin));
+    for (QCPGraphDataContainer::const_iterator it=bin.begin; it!=bin.end; ++it)
+      samples.append(it->value);
+    bin.box = boxStatistics(bin.box.key, std::move(samples));
+  });
+  
+  QVector<QCPStatisticalBoxData> boxes;
+  boxes.reserve(bins.size());
+  for (int i=0; i<bins.size(); ++i)
+  {
+    if (!qIsNaN(bins.at(i).box.median)) // bins with only NaN samples
+      boxes.append(bins.at(i).box);
+  }
+  mDataContainer->set(boxes, true);
+  
+  QCPDataSelection selection;
+  const double margin = mBinWidth*0.5-mBinWidth*1e-6; // boxes that only touch a selected span aren't selected
+  foreach (const QCPRange &span, selectedSpans)
+  {
+    const int begin = int(mDataContainer->findBegin(span.lower-margin, false)-mDataContainer->constBegin());
+    const int end = int(mDataContainer->findEnd(span.upper+margin, false)-mDataContainer->constBegin());
+    selection.addDataRange(QCPDataRange(begin, end), false);
+  }
+  selection.simplify();
+  setSelection(selection);
+}
+
+/*! \internal
+  
+  Returns the factor the box width (\ref setWidth) and the whisker width (\ref setWhiskerWidth)
+  are multiplied with to get key coordinates. This is the bin width if the boxes are computed from
+  source data (\ref setSourceData), and 1 otherwise.
+*/
+double QCPStatisticalBox::widthScale() const
+{
+  return mSourceData && mBinWidth > 0 ? mBinWidth : 1.0;
+}
+
 /*!  \internal
   
   called by \ref draw to determine which data (key) range is visible at the current key axis range
@@ -25719,8 +29143,9 @@ void QCPStatisticalBox::getVisibleDataBounds(QCPStatisticalBoxDataContainer::con
     end = mDataContainer->constEnd();
     return;
   }
-  begin = mDataContainer->findBegin(mKeyAxis.data()->range().lower-mWidth*0.5); // subtract half width of box to include partially visible data points
-  end = mDataContainer->findEnd(mKeyAxis.data()->range().upper+mWidth*0.5); // add half width of box to include partially visible data points
+  const double halfWidth = mWidth*widthScale()*0.5;
+  begin = mDataContainer->findBegin(mKeyAxis.data()->range().lower-halfWidth); // subtract half width of box to include partially visible data points
+  end = mDataContainer->findEnd(mKeyAxis.data()->range().upper+halfWidth); // add half width of box to include partially visible data points
 }
 
 /*!  \internal
@@ -25732,9 +29157,10 @@ void QCPStatisticalBox::getVisibleDataBounds(QCPStatisticalBoxDataContainer::con
 */
 QRectF QCPStatisticalBox::getQuartileBox(QCPStatisticalBoxDataContainer::const_iterator it) const
 {
+  const double halfWidth = mWidth*widthScale()*0.5;
   QRectF result;
-  result.setTopLeft(coordsToPixels(it->key-mWidth*0.5, it->upperQuartile));
-  result.setBottomRight(coordsToPixels(it->key+mWidth*0.5, it->lowerQuartile));
+  result.setTopLeft(coordsToPixels(it->key-halfWidth, it->upperQuartile));
+  result.setBottomRight(coordsToPixels(it->key+halfWidth, it->lowerQuartile));
   return result;
 }
 
@@ -25763,9 +29189,10 @@ QVector<QLineF> QCPStatisticalBox::getWhiskerBackboneLines(QCPStatisticalBoxData
 */
 QVector<QLineF> QCPStatisticalBox::getWhiskerBarLines(QCPStatisticalBoxDataContainer::const_iterator it) const
 {
+  const double halfWidth = mWhiskerWidth*widthScale()*0.5;
   QVector<QLineF> result(2);
-  result[0].setPoints(coordsToPixels(it->key-mWhiskerWidth*0.5, it->minimum), coordsToPixels(it->key+mWhiskerWidth*0.5, it->minimum)); // min bar
-  result[1].setPoints(coordsToPixels(it->key-mWhiskerWidth*0.5, it->maximum), coordsToPixels(it->key+mWhiskerWidth*0.5, it->maximum)); // max bar
+  result[0].setPoints(coordsToPixels(it->key-halfWidth, it->minimum), coordsToPixels(it->key+halfWidth, it->minimum)); // min bar
+  result[1].setPoints(coordsToPixels(it->key-halfWidth, it->maximum), coordsToPixels(it->key+halfWidth, it->maximum)); // max bar
   return result;
 }
 /* end of 'src/plottables/plottable-statisticalbox.cpp' */
@@ -25803,12 +29230,16 @@ QVector<QLineF> QCPStatisticalBox::getWhiskerBarLines(QCPStatisticalBoxDataConta
   QCPColorMap::rescaleDataRange with the necessary information quickly. Setting a cell to a value
   that is greater than the current maximum increases this maximum to the new value. However,
   setting the cell that currently holds the maximum value to a smaller value doesn't decrease the
-  maximum again, because finding the true new maximum would require going through the entire data
-  array, which might be time consuming. The same holds for the data minimum. This functionality is
-  given by \ref recalculateDataBounds, such that you can decide when it is sensible to find the
-  true current minimum and maximum. The method QCPColorMap::rescaleDataRange offers a convenience
-  parameter \a recalculateDataBounds which may be set to true to automatically call \ref
-  recalculateDataBounds internally.
+  maximum again. The same holds for the data minimum. The true current minimum and maximum are
+  found by \ref recalculateDataBounds. The method QCPColorMap::rescaleDataRange offers a
+  convenience parameter \a recalculateDataBounds which may be set to true to automatically call
+  \ref recalculateDataBounds internally.
+  
+  To make \ref recalculateDataBounds cheap, the minimum and maximum of every row of cells (cells
+  with equal value index) are kept up to date by \ref setCell, \ref setData and \ref fill. Only
+  rows in which the cell holding the row's minimum or maximum was overwritten with a less extreme
+  value need to be looked at again. So a streaming color map that is updated cell by cell can
+  recalculate its bounds and rescale its data range every frame.
 */
 
 /* start of documentation of inline functions */
@@ -25821,6 +29252,8 @@ QVector<QLineF> QCPStatisticalBox::getWhiskerBarLines(QCPStatisticalBoxDataConta
 
 /* end of documentation of inline functions */
 
+const int QCPColorMapData::tileSize;
+
 /*!
   Constructs a new QCPColorMapData instance. The instance has \a keySize cells in the key direction
   and \a valueSize cells in the value direction. These cells will be displayed by the \ref QCPColorMap
@@ -25885,7 +29318,11 @@ QCPColorMapData &QCPColorMapData::operator=(const QCPColorMapData &other)
         memcpy(mAlpha, other.mAlpha, sizeof(mAlpha[0])*size_t(keySize*valueSize));
     }
     mDataBounds = other.mDataBounds;
+    mRowLower = other.mRowLower;
+    mRowUpper = other.mRowUpper;
+    mStaleRows = other.mStaleRows;
     mDataModified = true;
+    mModifiedTiles.clear(); // the whole map is modified
   }
   return *this;
 }
@@ -25945,6 +29382,9 @@ void QCPColorMapData::setSize(int keySize, int valueSize)
     mKeySize = keySize;
     mValueSize = valueSize;
     delete[] mData;
+    mRowLower.clear(); // set up again by fill
+    mRowUpper.clear();
+    mStaleRows.clear();
     mIsEmpty = mKeySize == 0 || mValueSize == 0;
     if (!mIsEmpty)
     {
@@ -25966,6 +29406,7 @@ void QCPColorMapData::setSize(int keySize, int valueSize)
       createAlpha();
     
     mDataModified = true;
+    mModifiedTiles.clear(); // the whole map is modified
   }
 }
 
@@ -26062,14 +29503,7 @@ void QCPColorMapData::setData(double key, double value, double z)
   int keyCell = int( (key-mKeyRange.lower)/(mKeyRange.upper-mKeyRange.lower)*(mKeySize-1)+0.5 );
   int valueCell = int( (value-mValueRange.lower)/(mValueRange.upper-mValueRange.lower)*(mValueSize-1)+0.5 );
   if (keyCell >= 0 && keyCell < mKeySize && valueCell >= 0 && valueCell < mValueSize)
-  {
-    mData[valueCell*mKeySize + keyCell] = z;
-    if (z < mDataBounds.lower)
-      mDataBounds.lower = z;
-    if (z > mDataBounds.upper)
-      mDataBounds.upper = z;
-     mDataModified = true;
-  }
+    writeCell(keyCell, valueCell, z);
 }
 
 /*!
@@ -26086,14 +29520,8 @@ void QCPColorMapData::setData(double key, double value, double z)
 void QCPColorMapData::setCell(int keyIndex, int valueIndex, double z)
 {
   if (keyIndex >= 0 && keyIndex < mKeySize && valueIndex >= 0 && valueIndex < mValueSize)
-  {
-    mData[valueIndex*mKeySize + keyIndex] = z;
-    if (z < mDataBounds.lower)
-      mDataBounds.lower = z;
-    if (z > mDataBounds.upper)
-      mDataBounds.upper = z;
-     mDataModified = true;
-  } else
+    writeCell(keyIndex, valueIndex, z);
+  else
     qDebug() << Q_FUNC_INFO << "index out of bounds:" << keyIndex << valueIndex;
 }
 
@@ -26119,14 +29547,15 @@ void QCPColorMapData::setAlpha(int keyIndex, int valueIndex, unsigned char alpha
     if (mAlpha || createAlpha())
     {
       mAlpha[valueIndex*mKeySize + keyIndex] = alpha;
-      mDataModified = true;
+      markCellModified(keyIndex, valueIndex);
     }
   } else
     qDebug() << Q_FUNC_INFO << "index out of bounds:" << keyIndex << valueIndex;
 }
 
 /*!
-  Goes through the data and updates the buffered minimum and maximum data values.
+  Updates the buffered minimum and maximum data values to the true minimum and maximum of all cells.
+  NaN cells are ignored. If all cells are NaN, the buffered values are left unchanged.
   
   Calling this method is only advised if you are about to call \ref QCPColorMap::rescaleDataRange
   and can not guarantee that the cells holding the maximum or minimum data haven't been overwritten
@@ -26134,26 +29563,32 @@ void QCPColorMapData::setAlpha(int keyIndex, int valueIndex, unsigned char alpha
   updated the last time. Why this is the case is explained in the class description (\ref
   QCPColorMapData).
   
+  The minimum and maximum of each row of cells are tracked as the cells are set, so this method
+  only goes through the cells of rows whose minimum or maximum cell was overwritten. Otherwise its
+  cost is proportional to the value size, not the cell count, and it may be called every frame.
+  
   Note that the method \ref QCPColorMap::rescaleDataRange provides a parameter \a
   recalculateDataBounds for convenience. Setting this to true will call this method for you, before
   doing the rescale.
 */
 void QCPColorMapData::recalculateDataBounds()
 {
-  if (mKeySize > 0 && mValueSize > 0)
+  if (!mIsEmpty && mData)
   {
-    double minHeight = mData[0];
-    double maxHeight = mData[0];
-    const int dataCount = mValueSize*mKeySize;
-    for (int i=0; i<dataCount; ++i)
+    double minHeight = std::numeric_limits<double>::infinity();
+    double maxHeight = -std::numeric_limits<double>::infinity();
+    for (int row=0; row<mValueSize; ++row)
+    {
+      if (mStaleRows.testBit(row))
+        recalculateRowBounds(row);
+      minHeight = qMin(minHeight, mRowLower.at(row));
+      maxHeight = qMax(maxHeight, mRowUpper.at(row));
+    }
+    if (minHeight <= maxHeight) // otherwise all cells are NaN
     {
-      if (mData[i] > maxHeight)
-        maxHeight = mData[i];
-      if (mData[i] < minHeight)
-        minHeight = mData[i];
+      mDataBounds.lower = minHeight;
+      mDataBounds.upper = maxHeight;
     }
-    mDataBounds.lower = minHeight;
-    mDataBounds.upper = maxHeight;
   }
 }
 
@@ -26177,6 +29612,7 @@ void QCPColorMapData::clearAlpha()
     delete[] mAlpha;
     mAlpha = nullptr;
     mDataModified = true;
+    mModifiedTiles.clear(); // the whole map is modified
   }
 }
 
@@ -26189,7 +29625,12 @@ void QCPColorMapData::fill(double z)
   for (int i=0; i<dataCount; ++i)
     mData[i] = z;
   mDataBounds = QCPRange(z, z);
+  // NaN cells don't count for the row bounds, so rows of NaN start out with an empty (inverted) range:
+  mRowLower.fill(std::isnan(z) ? std::numeric_limits<double>::infinity() : z, mValueSize);
+  mRowUpper.fill(std::isnan(z) ? -std::numeric_limits<double>::infinity() : z, mValueSize);
+  mStaleRows.fill(false, mValueSize);
   mDataModified = true;
+  mModifiedTiles.clear(); // the whole map is modified
 }
 
 /*!
@@ -26209,6 +29650,7 @@ void QCPColorMapData::fillAlpha(unsigned char alpha)
     for (int i=0; i<dataCount; ++i)
       mAlpha[i] = alpha;
     mDataModified = true;
+    mModifiedTiles.clear(); // the whole map is modified
   }
 }
 
@@ -26298,6 +29740,83 @@ bool QCPColorMapData::createAlpha(bool initializeOpaque)
   }
 }
 
+/*! \internal
+
+  Records that the cell with indices \a keyIndex and \a valueIndex was modified. For the first
+  modification after the color map updated its image, the tracking of modified tiles starts, so
+  \ref QCPColorMap::updateMapImage only needs to colorize the tiles that contain modified cells.
+  If the whole map is already marked as modified, nothing needs to be recorded.
+*/
+void QCPColorMapData::markCellModified(int keyIndex, int valueIndex)
+{
+  const int keyTileCount = (mKeySize+tileSize-1)/tileSize;
+  if (!mDataModified)
+  {
+    mModifiedTiles.fill(false, keyTileCount*((mValueSize+tileSize-1)/tileSize));
+    mDataModified = true;
+  }
+  if (!mModifiedTiles.isEmpty())
+    mModifiedTiles.setBit(valueIndex/tileSize*keyTileCount + keyIndex/tileSize);
+}
+
+/*! \internal
+
+  Sets the cell with the valid indices \a keyIndex and \a valueIndex to \a z and updates the
+  buffered bounds, see \ref setCell.
+
+  The bounds of the cell's row are expanded by \a z. If the overwritten value was the row's
+  minimum or maximum and \a z is less extreme, the true bounds of the row are unknown and the row
+  is marked stale until \ref recalculateDataBounds.
+*/
+void QCPColorMapData::writeCell(int keyIndex, int valueIndex, double z)
+{
+  double &cell = mData[valueIndex*mKeySize + keyIndex];
+  const double previous = cell;
+  cell = z;
+  if (z < mDataBounds.lower)
+    mDataBounds.lower = z;
+  if (z > mDataBounds.upper)
+    mDataBounds.upper = z;
+  
+  if (!mStaleRows.testBit(valueIndex))
+  {
+    double &rowLower = mRowLower[valueIndex];
+    double &rowUpper = mRowUpper[valueIndex];
+    if ((previous == rowLower && !(z <= previous)) || (previous == rowUpper && !(z >= previous))) // also true if z is NaN
+      mStaleRows.setBit(valueIndex);
+    else
+    {
+      if (z < rowLower)
+        rowLower = z;
+      if (z > rowUpper)
+        rowUpper = z;
+    }
+  }
+  markCellModified(keyIndex, valueIndex);
+}
+
+/*! \internal
+
+  Goes through the cells of the row with \a valueIndex to find its minimum and maximum, ignoring
+  NaN cells, and removes the row's stale mark.
+*/
+void QCPColorMapData::recalculateRowBounds(int valueIndex)
+{
+  const double *row = mData + valueIndex*mKeySize;
+  double lower = std::numeric_limits<double>::infinity();
+  double upper = -std::numeric_limits<double>::infinity();
+  for (int i=0; i<mKeySize; ++i)
+  {
+    if (row[i] < lower)
+      lower = row[i];
+    if (row[i] > upper)
+      upper = row[i];
+  }
+  mRowLower[valueIndex] = lower;
+  mRowUpper[valueIndex] = upper;
+  mStaleRows.clearBit(valueIndex);
+}
+
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //////////////////// QCPColorMap
@@ -26605,10 +30124,10 @@ void QCPColorMap::setColorScale(QCPColorScale *colorScale)
   the data that actually lower the maximum of the data set (by overwriting the cell holding the
   current maximum with a smaller value), aren't recognized and the buffered maximum overestimates
   the true maximum of the data set. The same happens for the buffered minimum. To recalculate the
-  true minimum and maximum by explicitly looking at each cell, the method
-  QCPColorMapData::recalculateDataBounds can be used. For convenience, setting the parameter \a
-  recalculateDataBounds calls this method before setting the data range to the buffered minimum and
-  maximum.
+  true minimum and maximum, the method QCPColorMapData::recalculateDataBounds can be used. For
+  convenience, setting the parameter \a recalculateDataBounds calls this method before setting the
+  data range to the buffered minimum and maximum. Since only rows with overwritten extremes are
+  looked at again, this is cheap enough to rescale a streaming color map every frame.
   
   \see setDataRange
 */
@@ -26727,6 +30246,11 @@ QCPRange QCPColorMap::getValueRange(bool &foundRange, QCP::SignDomain inSignDoma
   Updates the internal map image buffer by going through the internal \ref QCPColorMapData and
   turning the data values into color pixels with \ref QCPColorGradient::colorize.
   
+  Large maps are colorized concurrently in bands of scanlines. If only cells of the data were
+  modified since the last update (e.g. with \ref QCPColorMapData::setCell), only the tiles of \ref
+  QCPColorMapData::tileSize cells squared that contain modified cells are colorized again, the rest
+  of the image is kept.
+  
   This method is called by \ref QCPColorMap::draw if either the data has been modified or the map image
   has been invalidated for a different reason (e.g. a change of the data range with \ref
   setDataRange).
@@ -26748,11 +30272,17 @@ void QCPColorMap::updateMapImage()
   int keyOversamplingFactor = mInterpolate ? 1 : int(1.0+100.0/double(keySize)); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
   int valueOversamplingFactor = mInterpolate ? 1 : int(1.0+100.0/double(valueSize)); // make mMapImage have at least size 100, factor becomes 1 if size > 200 or interpolation is on
   
+  bool imageRecreated = false; // if so, all cells must be colorized, not only the modified ones
   // resize mMapImage to correct dimensions including possible oversampling factors, according to key/value axes orientation:
   if (keyAxis->orientation() == Qt::Horizontal && (mMapImage.width() != keySize*keyOversamplingFactor || mMapImage.height() != valueSize*valueOversamplingFactor))
+  {
     mMapImage = QImage(QSize(keySize*keyOversamplingFactor, valueSize*valueOversamplingFactor), format);
-  else if (keyAxis->orientation() == Qt::Vertical && (mMapImage.width() != valueSize*valueOversamplingFactor || mMapImage.height() != keySize*keyOversamplingFactor))
+    imageRecreated = true;
+  } else if (keyAxis->orientation() == Qt::Vertical && (mMapImage.width() != valueSize*valueOversamplingFactor || mMapImage.height() != keySize*keyOversamplingFactor))
+  {
     mMapImage = QImage(QSize(valueSize*valueOversamplingFactor, keySize*keyOversamplingFactor), format);
+    imageRecreated = true;
+  }
   
   if (mMapImage.isNull())
   {
@@ -26766,40 +30296,81 @@ void QCPColorMap::updateMapImage()
     {
       // resize undersampled map image to actual key/value cell sizes:
       if (keyAxis->orientation() == Qt::Horizontal && (mUndersampledMapImage.width() != keySize || mUndersampledMapImage.height() != valueSize))
+      {
         mUndersampledMapImage = QImage(QSize(keySize, valueSize), format);
-      else if (keyAxis->orientation() == Qt::Vertical && (mUndersampledMapImage.width() != valueSize || mUndersampledMapImage.height() != keySize))
+        imageRecreated = true;
+      } else if (keyAxis->orientation() == Qt::Vertical && (mUndersampledMapImage.width() != valueSize || mUndersampledMapImage.height() != keySize))
+      {
         mUndersampledMapImage = QImage(QSize(valueSize, keySize), format);
+        imageRecreated = true;
+      }
       localMapImage = &mUndersampledMapImage; // make the colorization run on the undersampled image
     } else if (!mUndersampledMapImage.isNull())
       mUndersampledMapImage = QImage(); // don't need oversampling mechanism anymore (map size has changed) but mUndersampledMapImage still has nonzero size, free it
     
-    const double *rawData = mMapData->mData;
-    const unsigned char *rawAlpha = mMapData->mAlpha;
-    if (keyAxis->orientation() == Qt::Horizontal)
-    {
-      const int lineCount = valueSize;
-      const int rowCount = keySize;
-      for (int line=0; line<lineCount; ++line)
+    // a line is a scanline of the image, i.e. a row of cells along the key axis if it's horizontal, a column otherwise:
+    struct ColorizeTile
+    {
+      int lineLower, lineUpper; // lines of the tile, upper is exclusive
+      int cellLower, cellUpper; // cells along each line, upper is exclusive
+    };
+    const bool keyHorizontal = keyAxis->orientation() == Qt::Horizontal;
+    const int lineCount = keyHorizontal ? valueSize : keySize;
+    const int rowCount = keyHorizontal ? keySize : valueSize;
+    QVector<ColorizeTile> tiles;
+    if (imageRecreated || mMapImageInvalidated || mMapData->mModifiedTiles.isEmpty())
+    {
+      // colorize the whole image in bands of lines:
+      const int minimumBandCells = 65536;
+      const int bandCount = qBound(1, int(qint64(lineCount)*rowCount/minimumBandCells), qMin(lineCount, 4*qMax(1, QThread::idealThreadCount())));
+      for (int i=0; i<bandCount; ++i)
       {
-        QRgb* pixels = reinterpret_cast<QRgb*>(localMapImage->scanLine(lineCount-1-line)); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
-        if (rawAlpha)
-          mGradient.colorize(rawData+line*rowCount, rawAlpha+line*rowCount, mDataRange, pixels, rowCount, 1, mDataScaleType==QCPAxis::stLogarithmic);
-        else
-          mGradient.colorize(rawData+line*rowCount, mDataRange, pixels, rowCount, 1, mDataScaleType==QCPAxis::stLogarithmic);
+        const ColorizeTile band = {int(qint64(lineCount)*i/bandCount), int(qint64(lineCount)*(i+1)/bandCount), 0, rowCount};
+        tiles.append(band);
       }
-    } else // keyAxis->orientation() == Qt::Vertical
+    } else
     {
-      const int lineCount = keySize;
-      const int rowCount = valueSize;
-      for (int line=0; line<lineCount; ++line)
+      // only the data changed since the last update, colorize the tiles that contain modified cells:
+      const int tileSize = QCPColorMapData::tileSize;
+      const int keyTileCount = (keySize+tileSize-1)/tileSize;
+      for (int i=0; i<mMapData->mModifiedTiles.size(); ++i)
       {
-        QRgb* pixels = reinterpret_cast<QRgb*>(localMapImage->scanLine(lineCount-1-line)); // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
+        if (!mMapData->mModifiedTiles.testBit(i))
+          continue;
+        const int keyLower = (i%keyTileCount)*tileSize;
+        const int valueLower = (i/keyTileCount)*tileSize;
+        const int keyUpper = qMin(keyLower+tileSize, keySize);
+        const int valueUpper = qMin(valueLower+tileSize, valueSize);
+        const ColorizeTile tile = keyHorizontal ? ColorizeTile{valueLower, valueUpper, keyLower, keyUpper} : ColorizeTile{keyLower, keyUpper, valueLower, valueUpper};
+        tiles.append(tile);
+      }
+    }
+    
+    if (mGradient.mColorBufferInvalidated) // update it here, so the concurrent colorize calls only read the gradient
+      mGradient.updateColorBuffer();
+    const double *rawData = mMapData->mData;
+    const unsigned char *rawAlpha = mMapData->mAlpha;
+    const bool logarithmic = mDataScaleType == QCPAxis::stLogarithmic;
+    uchar *imageBits = localMapImage->bits(); // detaches the image once, QImage::scanLine would check for that in every thread
+    const qint64 bytesPerLine = localMapImage->bytesPerLine();
+    auto colorizeTile = [&](const ColorizeTile &tile)
+    {
+      // the data is stored line by line for horizontal key axes, column by column for vertical ones:
+      const int dataIndexFactor = keyHorizontal ? 1 : lineCount;
+      for (int line=tile.lineLower; line<tile.lineUpper; ++line)
+      {
+        QRgb* pixels = reinterpret_cast<QRgb*>(imageBits+(lineCount-1-line)*bytesPerLine)+tile.cellLower; // invert scanline index because QImage counts scanlines from top, but our vertical index counts from bottom (mathematical coordinate system)
+        const int dataIndex = keyHorizontal ? line*rowCount+tile.cellLower : line+tile.cellLower*lineCount;
         if (rawAlpha)
-          mGradient.colorize(rawData+line, rawAlpha+line, mDataRange, pixels, rowCount, lineCount, mDataScaleType==QCPAxis::stLogarithmic);
+          mGradient.colorize(rawData+dataIndex, rawAlpha+dataIndex, mDataRange, pixels, tile.cellUpper-tile.cellLower, dataIndexFactor, logarithmic);
         else
-          mGradient.colorize(rawData+line, mDataRange, pixels, rowCount, lineCount, mDataScaleType==QCPAxis::stLogarithmic);
+          mGradient.colorize(rawData+dataIndex, mDataRange, pixels, tile.cellUpper-tile.cellLower, dataIndexFactor, logarithmic);
       }
-    }
+    };
+    if (tiles.size() > 1)
+      QtConcurrent::blockingMap(tiles, colorizeTile);
+    else if (!tiles.isEmpty())
+      colorizeTile(tiles.first());
     
     if (keyOversamplingFactor > 1 || valueOversamplingFactor > 1)
     {
@@ -26810,6 +30381,7 @@ void QCPColorMap::updateMapImage()
     }
   }
   mMapData->mDataModified = false;
+  mMapData->mModifiedTiles.clear();
   mMapImageInvalidated = false;
 }
 
@@ -26901,6 +30473,384 @@ void QCPColorMap::drawLegendIcon(QCPPainter *painter, const QRectF &rect) const
   painter->drawRect(rect.adjusted(1, 1, 0, 0));
   */
 }
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//////////////////// QCPAggregateMap
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+/*! \class QCPAggregateMap
+  \brief A color map that displays an aggregate of a large graph data set at screen resolution
+
+  QCPAggregateMap takes a \ref QCPGraphDataContainer as source data (\ref setSourceData) and bins
+  its data points onto a two-dimensional grid with one cell per pixel of the axis rect, covering
+  the current key and value axis ranges. The data points falling into one cell are combined
+  according to the \ref setAggregation "aggregation" (number of points, mean value or maximum
+  value), and the resulting grid is displayed like any other \ref QCPColorMap, i.e. with the color
+  gradient, data range and data scale type set on the color map. Cells without data points are
+  transparent.
+
+  Unlike line and scatter representations, the cost of displaying the aggregate doesn't depend on
+  the number of data points, and no point is dropped, so it gives a faithful overview of data sets
+  with many millions of points.
+
+  Whenever the axis ranges or the size of the axis rect change, the grid is recomputed in the
+  background, from the data within the visible key range only. Until it is finished, the previous
+  grid keeps being shown at its correct coordinates. Once finished, the new grid is shown, the data
+  range is set to the range of the aggregated cell values and a queued replot is issued. The \ref
+  aggregated signal is emitted at that point. The aggregation itself splits the visible data into
+  chunks which are processed concurrently.
+
+  The source data container must not be modified while an aggregation is in progress (\ref
+  isAggregating). After modifying it, call \ref reaggregate.
+
+  \note Like QCPColorMap, the grid cells have equal key/value intervals, also if the axes are
+  logarithmic.
+*/
+
+/* start documentation of inline functions */
+
+/*! \fn bool QCPAggregateMap::isAggregating() const
+
+  Returns whether an aggregation of the source data is currently running in the background, or
+  has finished but its result wasn't applied yet.
+*/
+
+/* end documentation of inline functions */
+
+/* start documentation of signals */
+
+/*! \fn void QCPAggregateMap::aggregated()
+
+  This signal is emitted when a background aggregation has finished and its result was applied to
+  the color map data.
+*/
+
+/* end documentation of signals */
+
+/*!
+  Constructs an aggregate map with the specified \a keyAxis and \a valueAxis.
+
+  The created QCPAggregateMap is automatically registered with the QCustomPlot instance inferred
+  from \a keyAxis. This QCustomPlot instance takes ownership of the QCPAggregateMap, so do not
+  delete it manually but use QCustomPlot::removePlottable() instead.
+*/
+QCPAggregateMap::QCPAggregateMap(QCPAxis *keyAxis, QCPAxis *valueAxis) :
+  QCPColorMap(keyAxis, valueAxis),
+  mAggregation(agCount),
+  mAggregating(false),
+  mReaggregatePending(false),
+  mGridKeySize(0),
+  mGridValueSize(0)
+{
+  mMapData->clear();
+  setInterpolate(false);
+  setGradient(QCPColorGradient::gpThermal);
+  connect(&mAggregationWatcher, SIGNAL(finished()), this, SLOT(aggregationFinished()));
+}
+
+QCPAggregateMap::~QCPAggregateMap()
+{
+  if (mAggregating) // result of the running aggregation wasn't passed to the color map yet
+  {
+    mAggregationWatcher.waitForFinished();
+    delete mAggregationWatcher.result();
+  }
+}
+
+/*!
+  Sets the data container whose data points shall be aggregated. Since a QSharedPointer is used,
+  the container may be shared with other plottables, e.g. a \ref QCPGraph displaying the same
+  data.
+
+  \see reaggregate
+*/
+void QCPAggregateMap::setSourceData(QSharedPointer<QCPGraphDataContainer> data)
+{
+  mSourceData = data;
+  reaggregate();
+}
+
+/*! \overload
+
+  Replaces the source data with the points of the given \a dataSet.
+*/
+void QCPAggregateMap::setSourceData(DataSet *dataSet)
+{
+  QVector<QCPGraphData> points(dataSet->Size());
+  for (int i=0; i<points.size(); ++i)
+  {
+    const double *point = dataSet->getPoint(i);
+    points[i] = QCPGraphData(point[0], point[1]);
+  }
+  QSharedPointer<QCPGraphDataContainer> data(new QCPGraphDataContainer);
+  data->set(points);
+  setSourceData(data);
+}
+
+/*!
+  Sets how the data points falling into one grid cell are combined, see \ref Aggregation.
+*/
+void QCPAggregateMap::setAggregation(Aggregation aggregation)
+{
+  if (mAggregation != aggregation)
+  {
+    mAggregation = aggregation;
+    reaggregate();
+  }
+}
+
+/*!
+  Starts recomputing the aggregate grid in the background, for the current axis ranges and axis
+  rect size. If an aggregation is already running, a new one is started as soon as it has
+  finished, so only the most recent state is computed.
+
+  This happens automatically when the axis ranges or the axis rect size change. Call it manually
+  after modifying the source data.
+*/
+void QCPAggregateMap::reaggregate()
+{
+  if (!mSourceData || !mKeyAxis || !mValueAxis)
+    return;
+  if (mAggregating)
+  {
+    mReaggregatePending = true;
+    return;
+  }
+  mAggregating = true;
+  mReaggregatePending = false;
+  
+  const QRect axisRect = mKeyAxis->axisRect()->rect();
+  mGridKeyRange = mKeyAxis->range();
+  mGridValueRange = mValueAxis->range();
+  mGridKeySize = mKeyAxis->orientation() == Qt::Horizontal ? axisRect.width() : axisRect.height();
+  mGridValueSize = mKeyAxis->orientation() == Qt::Horizontal ? axisRect.height() : axisRect.width();
+  
+  const QSharedPointer<QCPGraphDataContainer> data = mSourceData;
+  const Aggregation aggregation = mAggregation;
+  const QCPRange keyRange = mGridKeyRange, valueRange = mGridValueRange;
+  const int keySize = mGridKeySize, valueSize = mGridValueSize;
+  mAggregationWatcher.setFuture(QtConcurrent::run([=]() { return aggregate(data, aggregation, keyRange, valueRange, keySize, valueSize); }));
+}
+
+/* inherits documentation from base class */
+QCPRange QCPAggregateMap::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
+{
+  if (!mSourceData)
+  {
+    foundRange = false;
+    return QCPRange();
+  }
+  return mSourceData->keyRange(foundRange, inSignDomain);
+}
+
+/* inherits documentation from base class */
+QCPRange QCPAggregateMap::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
+{
+  if (!mSourceData)
+  {
+    foundRange = false;
+    return QCPRange();
+  }
+  return mSourceData->valueRange(foundRange, inSignDomain, inKeyRange);
+}
+
+/* inherits documentation from base class */
+void QCPAggregateMap::draw(QCPPainter *painter)
+{
+  if (!gridMatchesAxes())
+    reaggregate(); // the current grid is still drawn at its own key/value ranges until the new one is ready
+  QCPColorMap::draw(painter);
+}
+
+/*! \internal
+
+  Returns whether the most recently requested aggregate grid corresponds to the current axis ranges
+  and axis rect size.
+*/
+bool QCPAggregateMap::gridMatchesAxes() const
+{
+  if (!mKeyAxis || !mValueAxis)
+    return true;
+  const QRect axisRect = mKeyAxis->axisRect()->rect();
+  const int keySize = mKeyAxis->orientation() == Qt::Horizontal ? axisRect.width() : axisRect.height();
+  const int valueSize = mKeyAxis->orientation() == Qt::Horizontal ? axisRect.height() : axisRect.width();
+  return mGridKeyRange == mKeyAxis->range() && mGridValueRange == mValueAxis->range() &&
+         mGridKeySize == keySize && mGridValueSize == valueSize;
+}
+
+/*! \internal
+
+  Computes the aggregate grid of the data points in \a data, for a grid of \a keySize times \a
+  valueSize cells spanning \a keyRange and \a valueRange. This function runs in a worker thread and
+  doesn't touch any member of the aggregate map. It returns a new QCPColorMapData, ownership is
+  passed to the caller.
+
+  Only the data points within \a keyRange are visited. They are split into chunks that are binned
+  concurrently. Since the data is sorted by key, each chunk covers a narrow band of key cells, so it
+  accumulates into a private buffer for just that band, and the bands are then merged. Within a
+  chunk, cell indices are computed in fixed-size batches by a branch-free loop over the
+  contiguous data, which the compiler can vectorize, before the cells are accumulated.
+*/
+QCPColorMapData *QCPAggregateMap::aggregate(QSharedPointer<QCPGraphDataContainer> data, Aggregation aggregation, QCPRange keyRange, QCPRange valueRange, int keySize, int valueSize)
+{
+  if (keySize <= 0 || valueSize <= 0 || keyRange.size() <= 0 || valueRange.size() <= 0)
+    return new QCPColorMapData(0, 0, keyRange, valueRange);
+  
+  struct AggregateBand
+  {
+    QCPGraphDataContainer::const_iterator begin, end;
+    int keyLower, keyUpper;
+    QVector<quint32> counts;
+    QVector<double> values; // sum or maximum of data values, unused for agCount
+  };
+  
+  const double keyScale = keySize/keyRange.size();
+  const double valueScale = valueSize/valueRange.size();
+  QCPGraphDataContainer::const_iterator begin = data->findBegin(keyRange.lower, false);
+  QCPGraphDataContainer::const_iterator end = data->findEnd(keyRange.upper, false);
+  const int dataCount = int(end-begin);
+  const int minimumChunkSize = 65536;
+  const int chunkCount = qBound(1, dataCount/minimumChunkSize, 4*qMax(1, QThread::idealThreadCount()));
+  QVector<AggregateBand> bands(chunkCount);
+  for (int i=0; i<chunkCount; ++i)
+  {
+    bands[i].begin = begin + int(qint64(dataCount)*i/chunkCount);
+    bands[i].end = begin + int(qint64(dataCount)*(i+1)/chunkCount);
+  }
+  
+  auto keyCell = [=](double key) { return int(qBound(0.0, (key-keyRange.lower)*keyScale, keySize-1.0)); };
+  auto aggregateBand = [=](AggregateBand &band)
+  {
+    if (band.begin == band.end)
+    {
+      band.keyLower = 0;
+      band.keyUpper = -1;
+      return;
+    }
+    band.keyLower = keyCell(band.begin->key);
+    band.keyUpper = keyCell((band.end-1)->key);
+    const int bandKeyCells = band.keyUpper-band.keyLower+1;
+    const int bandCells = bandKeyCells*valueSize;
+    band.counts.fill(0, bandCells);
+    if (aggregation == agMeanValue)
+      band.values.fill(0, bandCells);
+    else if (aggregation == agMaxValue)
+      band.values.fill(-std::numeric_limits<double>::max(), bandCells);
+    quint32 *counts = band.counts.data();
+    double *values = band.values.data();
+    
+    const int batchSize = 1024;
+    int cells[batchSize];
+    const int bandCount = int(band.end-band.begin);
+    for (int batch=0; batch<bandCount; batch+=batchSize)
+    {
+      const int n = qMin(batchSize, bandCount-batch);
+      const QCPGraphData *points = &(*(band.begin+batch));
+      // branch-free cell computation, points outside the grid (or NaN) get cell index -1:
+      for (int i=0; i<n; ++i)
+      {
+        const double k = std::min(double(bandKeyCells), std::max(-1.0, (points[i].key-keyRange.lower)*keyScale-band.keyLower));
+        const double v = std::min(double(valueSize), std::max(-1.0, (points[i].value-valueRange.lower)*valueScale));
+        const bool inside = k >= 0 && k < bandKeyCells && v >= 0 && v < valueSize;
+        cells[i] = inside ? int(k)*valueSize + int(v) : -1;
+      }
+      for (int i=0; i<n; ++i)
+      {
+        const int cell = cells[i];
+        if (cell < 0)
+          continue;
+        ++counts[cell];
+        if (aggregation == agMeanValue)
+          values[cell] += points[i].value;
+        else if (aggregation == agMaxValue && points[i].value > values[cell])
+          values[cell] = points[i].value;
+      }
+    }
+  };
+  if (chunkCount > 1)
+    QtConcurrent::blockingMap(bands, aggregateBand);
+  else
+    aggregateBand(bands[0]);
+  
+  // merge bands into one key-major grid:
+  QVector<quint32> counts(keySize*valueSize, 0);
+  QVector<double> values(aggregation == agCount ? 0 : keySize*valueSize, aggregation == agMaxValue ? -std::numeric_limits<double>::max() : 0);
+  foreach (const AggregateBand &band, bands)
+  {
+    const int offset = band.keyLower*valueSize;
+    for (int i=0; i<band.counts.size(); ++i)
+    {
+      counts[offset+i] += band.counts.at(i);
+      if (aggregation == agMeanValue)
+        values[offset+i] += band.values.at(i);
+      else if (aggregation == agMaxValue)
+        values[offset+i] = qMax(values.at(offset+i), band.values.at(i));
+    }
+  }
+  
+  // cell centers lie half a cell inside the axis ranges:
+  const double keyCellHalf = 0.5/keyScale, valueCellHalf = 0.5/valueScale;
+  QCPColorMapData *result = new QCPColorMapData(keySize, valueSize, QCPRange(keyRange.lower+keyCellHalf, keyRange.upper-keyCellHalf), QCPRange(valueRange.lower+valueCellHalf, valueRange.upper-valueCellHalf));
+  result->fillAlpha(0);
+  for (int k=0; k<keySize; ++k)
+  {
+    for (int v=0; v<valueSize; ++v)
+    {
+      const int i = k*valueSize+v;
+      if (counts.at(i) == 0)
+        continue;
+      switch (aggregation)
+      {
+        case agCount: result->setCell(k, v, counts.at(i)); break;
+        case agMeanValue: result->setCell(k, v, values.at(i)/counts.at(i)); break;
+        case agMaxValue: result->setCell(k, v, values.at(i)); break;
+      }
+      result->setAlpha(k, v, 255);
+    }
+  }
+  return result;
+}
+
+/*! \internal
+
+  Called in the GUI thread when a background aggregation has finished. Replaces the color map data
+  with the new grid, adapts the data range to the aggregated values and triggers a queued replot.
+*/
+void QCPAggregateMap::aggregationFinished()
+{
+  QCPColorMapData *result = mAggregationWatcher.result();
+  mAggregating = false;
+  // data range from occupied cells only, empty cells are set to zero but transparent:
+  bool foundRange = false;
+  QCPRange valueBounds;
+  const int cellCount = result->keySize()*result->valueSize();
+  for (int i=0; i<cellCount; ++i)
+  {
+    if (result->alpha(i%result->keySize(), i/result->keySize()) == 0)
+      continue;
+    const double z = result->cell(i%result->keySize(), i/result->keySize());
+    if (!foundRange)
+    {
+      valueBounds.lower = valueBounds.upper = z;
+      foundRange = true;
+    } else
+      valueBounds.expand(z);
+  }
+  setData(result);
+  if (foundRange)
+  {
+    if (valueBounds.size() <= 0)
+      valueBounds.upper = valueBounds.lower+1;
+    setDataRange(valueBounds);
+  }
+  emit aggregated();
+  
+  if (mReaggregatePending)
+    reaggregate();
+  if (mParentPlot)
+    mParentPlot->replot(QCustomPlot::rpQueuedReplot);
+}
+
 /* end of 'src/plottables/plottable-colormap.cpp' */
 
 
@@ -27029,6 +30979,16 @@ QCPFinancialData::QCPFinancialData(double key, double open, double high, double
   setWidthType. A typical choice is to set the width type to \ref wtPlotCoords (the default) and
   the width to (or slightly less than) one time bin interval width.
 
+  \section qcpfinancial-sourcedata Binning raw data depending on the zoom level
+
+  Alternatively, raw samples like ticks can be passed with \ref setSourceData. The financial chart
+  then bins them itself into a pyramid of levels, each with buckets twice as long as the level
+  below. The finest level has about one bucket per four samples. When drawing, the level with the
+  finest buckets that are still at least a few pixels wide is shown, so the number of drawn
+  candles is bounded by the size of the axis rect and zooming over years of ticks stays
+  interactive. With the width type \ref wtPlotCoords, the width (\ref setWidth) is then given as
+  a fraction of the bucket size, so the candles follow the zoom level.
+
   \section qcpfinancial-appearance Changing the appearance
 
   Charts can be either single- or two-colored (\ref setTwoColored). If set to be single-colored,
@@ -27089,7 +31049,10 @@ QCPFinancial::QCPFinancial(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mBrushPositive(QBrush(QColor(50, 160, 0))),
   mBrushNegative(QBrush(QColor(180, 0, 15))),
   mPenPositive(QPen(QColor(40, 150, 0))),
-  mPenNegative(QPen(QColor(170, 5, 5)))
+  mPenNegative(QPen(QColor(170, 5, 5))),
+  mBaseBucketSize(0),
+  mBucketOffset(0),
+  mLevel(-1)
 {
   mSelectionDecorator->setBrush(QBrush(QColor(160, 160, 255)));
 }
@@ -27111,10 +31074,14 @@ QCPFinancial::~QCPFinancial()
   the \ref QCPDataContainer<DataType>::set method on the financial's data container directly:
   \snippet documentation/doc-code-snippets/mainwindow.cpp qcpfinancial-datasharing-2
   
+  If source data was set with \ref setSourceData, it is released.
+  
   \see addData, timeSeriesToOhlc
 */
 void QCPFinancial::setData(QSharedPointer<QCPFinancialDataContainer> data)
 {
+  mSourceData.clear();
+  mLevels.clear();
   mDataContainer = data;
 }
 
@@ -27127,10 +31094,18 @@ void QCPFinancial::setData(QSharedPointer<QCPFinancialDataContainer> data)
   If you can guarantee that the passed data points are sorted by \a keys in ascending order, you
   can set \a alreadySorted to true, to improve performance by saving a sorting run.
   
+  If source data was set with \ref setSourceData, it is released.
+  
   \see addData, timeSeriesToOhlc
 */
 void QCPFinancial::setData(const QVector<double> &keys, const QVector<double> &open, const QVector<double> &high, const QVector<double> &low, const QVector<double> &close, bool alreadySorted)
 {
+  if (!mLevels.isEmpty()) // the data container is a level of the source data
+  {
+    mSourceData.clear();
+    mLevels.clear();
+    mDataContainer = QSharedPointer<QCPFinancialDataContainer>(new QCPFinancialDataContainer);
+  }
   mDataContainer->clear();
   addData(keys, open, high, low, close, alreadySorted);
 }
@@ -27147,6 +31122,10 @@ void QCPFinancial::setChartStyle(QCPFinancial::ChartStyle style)
   Sets the width of the individual bars/candlesticks to \a width in plot key coordinates.
   
   A typical choice is to set it to (or slightly less than) one bin interval width.
+  
+  If the data is binned from source data (\ref setSourceData) and the width type is \ref
+  wtPlotCoords, \a width is a fraction of the bucket size instead, e.g. the default of 0.5 leaves a
+  gap as wide as a candle between neighbouring candles.
 */
 void QCPFinancial::setWidth(double width)
 {
@@ -27236,6 +31215,43 @@ void QCPFinancial::setPenNegative(const QPen &pen)
   mPenNegative = pen;
 }
 
+/*!
+  Sets the raw samples, e.g. ticks with their time as key and their price as value, from which the
+  financial chart bins its OHLC data itself (see \ref qcpfinancial-sourcedata "Binning raw data
+  depending on the zoom level"). Since a QSharedPointer is used, the container may be shared with
+  other plottables, e.g. a \ref QCPGraph displaying the same samples.
+  
+  The levels of binned data are built immediately, in a time linear to the number of samples, and
+  the data container (\ref data) is then always one of them. Selections refer to the buckets of the
+  level that is currently shown. When the zoom level makes another level be shown, the selection is
+  moved to the buckets of that level covering the same keys. The key and value ranges used for
+  rescaling the axes are those of the samples. After modifying the source data, call \ref
+  rebuildLevels, which clears the selection. Setting OHLC data with \ref setData releases the
+  source data.
+*/
+void QCPFinancial::setSourceData(QSharedPointer<QCPGraphDataContainer> data)
+{
+  mSourceData = data;
+  rebuildLevels();
+}
+
+/*! \overload
+
+  Replaces the source data with the points of the given \a dataSet.
+*/
+void QCPFinancial::setSourceData(DataSet *dataSet)
+{
+  QVector<QCPGraphData> points(dataSet->Size());
+  for (int i=0; i<points.size(); ++i)
+  {
+    const double *point = dataSet->getPoint(i);
+    points[i] = QCPGraphData(point[0], point[1]);
+  }
+  QSharedPointer<QCPGraphDataContainer> data(new QCPGraphDataContainer);
+  data->set(points);
+  setSourceData(data);
+}
+
 /*! \overload
   
   Adds the provided points in \a keys, \a open, \a high, \a low and \a close to the current data.
@@ -27287,6 +31303,95 @@ void QCPFinancial::addData(double key, double open, double high, double low, dou
   mDataContainer->add(QCPFinancialData(key, open, high, low, close));
 }
 
+/*!
+  Rebuilds the levels of binned OHLC data from the source data (\ref setSourceData). Call this
+  after modifying the source data container.
+  
+  The samples are binned into buckets that start at the smallest key. The finest level has
+  buckets of four times the average sample spacing, and each further level is built by merging
+  pairs of neighbouring buckets of the level below, until a single bucket is left. Samples with
+  NaN key or value are ignored.
+*/
+void QCPFinancial::rebuildLevels()
+{
+  mLevels.clear();
+  mLevel = -1;
+  if (!mSourceData)
+    return;
+  
+  // bin the samples into the buckets of the finest level:
+  bool foundRange;
+  const QCPRange keyRange = mSourceData->keyRange(foundRange);
+  mBucketOffset = foundRange ? keyRange.lower : 0;
+  mBaseBucketSize = foundRange && keyRange.size() > 0 ? 4*keyRange.size()/mSourceData->size() : 1.0;
+  QVector<QCPFinancialData> candles;
+  qint64 currentBucket = 0;
+  for (QCPGraphDataContainer::const_iterator it=mSourceData->constBegin(); it!=mSourceData->constEnd(); ++it)
+  {
+    if (qIsNaN(it->key) || qIsNaN(it->value))
+      continue;
+    const qint64 bucket = qint64(std::floor((it->key-mBucketOffset)/mBaseBucketSize));
+    if (candles.isEmpty() || bucket != currentBucket)
+    {
+      candles.append(QCPFinancialData(mBucketOffset+(bucket+0.5)*mBaseBucketSize, it->value, it->value, it->value, it->value));
+      currentBucket = bucket;
+    } else
+    {
+      QCPFinancialData &candle = candles.last();
+      candle.high = qMax(candle.high, it->value);
+      candle.low = qMin(candle.low, it->value);
+      candle.close = it->value;
+    }
+  }
+  QSharedPointer<QCPFinancialDataContainer> level(new QCPFinancialDataContainer);
+  level->set(candles, true);
+  mLevels.append(level);
+  
+  // merge pairs of neighbouring buckets into the buckets of the next coarser level:
+  double bucketSize = mBaseBucketSize;
+  while (candles.size() > 1)
+  {
+    QVector<QCPFinancialData> merged;
+    merged.reserve(candles.size()/2+1);
+    qint64 currentParent = 0;
+    for (int i=0; i<candles.size(); ++i)
+    {
+      const QCPFinancialData &candle = candles.at(i);
+      const qint64 parent = qint64(std::floor((candle.key-mBucketOffset)/bucketSize))/2; // bucket indices aren't negative, since the buckets start at the smallest key
+      if (merged.isEmpty() || parent != currentParent)
+      {
+        merged.append(QCPFinancialData(mBucketOffset+(parent+0.5)*2*bucketSize, candle.open, candle.high, candle.low, candle.close));
+        currentParent = parent;
+      } else
+      {
+        QCPFinancialData &mergedCandle = merged.last();
+        mergedCandle.high = qMax(mergedCandle.high, candle.high);
+        mergedCandle.low = qMin(mergedCandle.low, candle.low);
+        mergedCandle.close = candle.close;
+      }
+    }
+    candles = merged;
+    bucketSize *= 2;
+    level = QSharedPointer<QCPFinancialDataContainer>(new QCPFinancialDataContainer);
+    level->set(candles, true);
+    mLevels.append(level);
+  }
+  
+  // until the first replot chooses the level for the axis range, show the coarsest one:
+  mLevel = mLevels.size()-1;
+  mDataContainer = mLevels.last();
+  setSelection(QCPDataSelection()); // the selected buckets were those of the previous levels
+}
+
+/*!
+  Returns the length of the buckets in key coordinates which the currently shown OHLC data was
+  binned with, if the data is binned from source data (\ref setSourceData). Otherwise returns 0.
+*/
+double QCPFinancial::bucketSize() const
+{
+  return mLevels.isEmpty() ? 0 : std::ldexp(mBaseBucketSize, mLevel);
+}
+
 /*!
   \copydoc QCPPlottableInterface1D::selectTestRect
 */
@@ -27355,14 +31460,17 @@ double QCPFinancial::selectTest(const QPointF &pos, bool onlySelectable, QVarian
 /* inherits documentation from base class */
 QCPRange QCPFinancial::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain) const
 {
+  if (!mLevels.isEmpty()) // the shown level depends on the key range, so use the range of the samples
+    return mSourceData->keyRange(foundRange, inSignDomain);
   QCPRange range = mDataContainer->keyRange(foundRange, inSignDomain);
   // determine exact range by including width of bars/flags:
   if (foundRange)
   {
-    if (inSignDomain != QCP::sdPositive || range.lower-mWidth*0.5 > 0)
-      range.lower -= mWidth*0.5;
-    if (inSignDomain != QCP::sdNegative || range.upper+mWidth*0.5 < 0)
-      range.upper += mWidth*0.5;
+    const double halfWidth = keyWidth()*0.5;
+    if (inSignDomain != QCP::sdPositive || range.lower-halfWidth > 0)
+      range.lower -= halfWidth;
+    if (inSignDomain != QCP::sdNegative || range.upper+halfWidth < 0)
+      range.upper += halfWidth;
   }
   return range;
 }
@@ -27370,6 +31478,8 @@ QCPRange QCPFinancial::getKeyRange(bool &foundRange, QCP::SignDomain inSignDomai
 /* inherits documentation from base class */
 QCPRange QCPFinancial::getValueRange(bool &foundRange, QCP::SignDomain inSignDomain, const QCPRange &inKeyRange) const
 {
+  if (!mLevels.isEmpty())
+    return mSourceData->valueRange(foundRange, inSignDomain, inKeyRange);
   return mDataContainer->valueRange(foundRange, inSignDomain, inKeyRange);
 }
 
@@ -27429,6 +31539,8 @@ QCPFinancialDataContainer QCPFinancial::timeSeriesToOhlc(const QVector<double> &
 /* inherits documentation from base class */
 void QCPFinancial::draw(QCPPainter *painter)
 {
+  selectLevel();
+  
   // get visible data range:
   QCPFinancialDataContainer::const_iterator visibleBegin, visibleEnd;
   getVisibleDataBounds(visibleBegin, visibleEnd);
@@ -27686,7 +31798,7 @@ double QCPFinancial::getPixelWidth(double key, double keyPixel) const
     case wtPlotCoords:
     {
       if (mKeyAxis)
-        result = mKeyAxis.data()->coordToPixel(key+mWidth*0.5)-keyPixel;
+        result = mKeyAxis.data()->coordToPixel(key+keyWidth()*0.5)-keyPixel;
       else
         qDebug() << Q_FUNC_INFO << "No key axis defined";
       break;
@@ -27695,6 +31807,64 @@ double QCPFinancial::getPixelWidth(double key, double keyPixel) const
   return result;
 }
 
+/*! \internal
+
+  If the OHLC data is binned from source data (\ref setSourceData), makes the data container the
+  level with the finest buckets that are still at least four pixels wide at the current key axis
+  range, so the number of drawn candles is bounded by the size of the axis rect. On logarithmic key
+  axes, the average pixel width of the buckets is used.
+*/
+void QCPFinancial::selectLevel()
+{
+  if (mLevels.isEmpty() || !mKeyAxis)
+    return;
+  const double minBucketPixels = 4;
+  QCPAxis *keyAxis = mKeyAxis.data();
+  const int axisPixels = keyAxis->orientation() == Qt::Horizontal ? keyAxis->axisRect()->width() : keyAxis->axisRect()->height();
+  const double keysPerPixel = keyAxis->range().size()/qMax(1, axisPixels);
+  int level = 0;
+  while (level < mLevels.size()-1 && std::ldexp(mBaseBucketSize, level) < minBucketPixels*keysPerPixel)
+    ++level;
+  if (level != mLevel)
+  {
+    // the selection refers to the buckets of the previous level, select the buckets of the new level covering the same keys:
+    QCPDataSelection selection;
+    if (!mSelection.isEmpty() && mLevel >= 0)
+    {
+      const double oldBucketSize = bucketSize();
+      const double newBucketSize = std::ldexp(mBaseBucketSize, level);
+      // bucket borders of all levels lie on the grid of the finer one, so a quarter of it separates touching buckets from overlapping ones:
+      const double margin = newBucketSize*0.5-qMin(oldBucketSize, newBucketSize)*0.25;
+      const QSharedPointer<QCPFinancialDataContainer> newLevel = mLevels.at(level);
+      foreach (const QCPDataRange &range, mSelection.dataRanges())
+      {
+        const double lower = mDataContainer->at(range.begin())->key-oldBucketSize*0.5;
+        const double upper = mDataContainer->at(range.end()-1)->key+oldBucketSize*0.5;
+        const int begin = int(newLevel->findBegin(lower-margin, false)-newLevel->constBegin());
+        const int end = int(newLevel->findEnd(upper+margin, false)-newLevel->constBegin());
+        selection.addDataRange(QCPDataRange(begin, end), false);
+      }
+      selection.simplify();
+    }
+    mLevel = level;
+    mDataContainer = mLevels.at(level);
+    setSelection(selection);
+  }
+}
+
+/*! \internal
+
+  Returns the width of the bars/candlesticks in key coordinates. This is \ref setWidth, unless the
+  data is binned from source data (\ref setSourceData) and the width type is \ref wtPlotCoords. In
+  that case the width is a fraction of the bucket size, so the candles follow the zoom level.
+*/
+double QCPFinancial::keyWidth() const
+{
+  if (mWidthType == wtPlotCoords && !mLevels.isEmpty())
+    return mWidth*bucketSize();
+  return mWidth;
+}
+
 /*! \internal
 
   This method is a helper function for \ref selectTest. It is used to test for selection when the
@@ -27764,7 +31934,7 @@ double QCPFinancial::candlestickSelectTest(const QPointF &pos, const QCPFinancia
     {
       double currentDistSqr;
       // determine whether pos is in open-close-box:
-      QCPRange boxKeyRange(it->key-mWidth*0.5, it->key+mWidth*0.5);
+      QCPRange boxKeyRange(it->key-keyWidth()*0.5, it->key+keyWidth()*0.5);
       QCPRange boxValueRange(it->close, it->open);
       double posKey, posValue;
       pixelsToCoords(pos, posKey, posValue);
@@ -27791,7 +31961,7 @@ double QCPFinancial::candlestickSelectTest(const QPointF &pos, const QCPFinancia
     {
       double currentDistSqr;
       // determine whether pos is in open-close-box:
-      QCPRange boxKeyRange(it->key-mWidth*0.5, it->key+mWidth*0.5);
+      QCPRange boxKeyRange(it->key-keyWidth()*0.5, it->key+keyWidth()*0.5);
       QCPRange boxValueRange(it->close, it->open);
       double posKey, posValue;
       pixelsToCoords(pos, posKey, posValue);
@@ -27839,8 +32009,8 @@ void QCPFinancial::getVisibleDataBounds(QCPFinancialDataContainer::const_iterato
     end = mDataContainer->constEnd();
     return;
   }
-  begin = mDataContainer->findBegin(mKeyAxis.data()->range().lower-mWidth*0.5); // subtract half width of ohlc/candlestick to include partially visible data points
-  end = mDataContainer->findEnd(mKeyAxis.data()->range().upper+mWidth*0.5); // add half width of ohlc/candlestick to include partially visible data points
+  begin = mDataContainer->findBegin(mKeyAxis.data()->range().lower-keyWidth()*0.5); // subtract half width of ohlc/candlestick to include partially visible data points
+  end = mDataContainer->findEnd(mKeyAxis.data()->range().upper+keyWidth()*0.5); // add half width of ohlc/candlestick to include partially visible data points
 }
 
 /*!  \internal
@@ -27857,7 +32027,7 @@ QRectF QCPFinancial::selectionHitBox(QCPFinancialDataContainer::const_iterator i
   double keyPixel = keyAxis->coordToPixel(it->key);
   double highPixel = valueAxis->coordToPixel(it->high);
   double lowPixel = valueAxis->coordToPixel(it->low);
-  double keyWidthPixels = keyPixel-keyAxis->coordToPixel(it->key-mWidth*0.5);
+  double keyWidthPixels = keyPixel-keyAxis->coordToPixel(it->key-keyWidth()*0.5);
   if (keyAxis->orientation() == Qt::Horizontal)
     return QRectF(keyPixel-keyWidthPixels, highPixel, keyWidthPixels*2, lowPixel-highPixel).normalized();
   else
@@ -27979,7 +32149,8 @@ QCPErrorBars::QCPErrorBars(QCPAxis *keyAxis, QCPAxis *valueAxis) :
   mDataContainer(new QVector<QCPErrorBarsData>),
   mErrorType(etValueError),
   mWhiskerWidth(9),
-  mSymbolGap(10)
+  mSymbolGap(10),
+  mAdaptiveSampling(true)
 {
   setPen(QPen(Qt::black, 0));
   setBrush(Qt::NoBrush);
@@ -28103,6 +32274,24 @@ void QCPErrorBars::setSymbolGap(double pixels)
   mSymbolGap = pixels;
 }
 
+/*!
+  Sets whether adaptive sampling shall be used when drawing dense error bars, similar to \ref
+  QCPGraph::setAdaptiveSampling.
+
+  If enabled and there are at least two visible error bars per pixel column on average (the columns
+  run along the axis orthogonal to the error bars), the individual error bars would merely overlap.
+  Instead, a single line is drawn per pixel column, which spans from the lowest to the highest end
+  of all error bars in that column. The drawing cost is then bounded by the size of the axis rect
+  instead of the number of data points. When zooming in far enough, the individual error bars with
+  whiskers and symbol gaps are drawn again.
+
+  By default, adaptive sampling is enabled.
+*/
+void QCPErrorBars::setAdaptiveSampling(bool enabled)
+{
+  mAdaptiveSampling = enabled;
+}
+
 /*! \overload
 
   Adds symmetrical error values as specified in \a error. The errors will be associated one-to-one
@@ -28388,13 +32577,22 @@ void QCPErrorBars::draw(QCPPainter *painter)
     }
     backbones.clear();
     whiskers.clear();
-    for (QCPErrorBarsDataContainer::const_iterator it=begin; it!=end; ++it)
+    const QRect axisRectPixels = mKeyAxis.data()->axisRect()->rect();
+    const int columnCount = (mErrorType == etValueError) == (mKeyAxis.data()->orientation() == Qt::Horizontal) ? axisRectPixels.width() : axisRectPixels.height();
+    if (mAdaptiveSampling && end-begin >= 2*columnCount) // dense error bars only overlap, draw their envelope per pixel column
+      getErrorBarEnvelope(begin, end, checkPointVisibility, backbones);
+    else
     {
-      if (!checkPointVisibility || errorBarVisible(int(it-mDataContainer->constBegin())))
-        getErrorBarLines(it, backbones, whiskers);
+      for (QCPErrorBarsDataContainer::const_iterator it=begin; it!=end; ++it)
+      {
+        if (!checkPointVisibility || errorBarVisible(int(it-mDataContainer->constBegin())))
+          getErrorBarLines(it, backbones, whiskers);
+      }
     }
     painter->drawLines(backbones);
     painter->drawLines(whiskers);
+    if (QCPRenderProfiler *profiler = mParentPlot->renderProfiler())
+      profiler->addPointCounts(this, int(end-begin), 2*(backbones.size()+whiskers.size()));
   }
   
   // draw other selection decoration that isn't just line/scatter pens and brushes:
@@ -28643,6 +32841,62 @@ void QCPErrorBars::getErrorBarLines(QCPErrorBarsDataContainer::const_iterator it
   }
 }
 
+/*! \internal
+
+  Calculates the envelope of the error bars of the data points from \a begin to \a end, which is
+  drawn instead of the individual error bars when adaptive sampling is enabled and the error bars
+  are dense (see \ref setAdaptiveSampling).
+
+  The error bars are sorted into the pixel columns of the axis rect by the pixel position of their
+  data points on the axis orthogonal to the error bars, so the data points don't need to be sorted
+  along that axis. For each pixel column that contains error bars, one line from the lowest to the
+  highest error bar end is added to \a envelope. Whiskers and symbol gaps are omitted, since they
+  would be hidden by the neighbouring error bars anyway.
+
+  If \a checkPointVisibility is true, the visibility of each error bar is checked with \ref
+  errorBarVisible, see \ref draw.
+*/
+void QCPErrorBars::getErrorBarEnvelope(QCPErrorBarsDataContainer::const_iterator begin, QCPErrorBarsDataContainer::const_iterator end, bool checkPointVisibility, QVector<QLineF> &envelope) const
+{
+  if (!mDataPlottable) return;
+  
+  QCPAxis *errorAxis = mErrorType == etValueError ? mValueAxis.data() : mKeyAxis.data();
+  const bool errorIsVertical = errorAxis->orientation() == Qt::Vertical;
+  const QRect axisRectPixels = errorAxis->axisRect()->rect();
+  const int firstColumn = errorIsVertical ? axisRectPixels.left() : axisRectPixels.top();
+  const int columnCount = errorIsVertical ? axisRectPixels.width() : axisRectPixels.height();
+  QVector<double> lower(columnCount, (std::numeric_limits<double>::max)());
+  QVector<double> upper(columnCount, -(std::numeric_limits<double>::max)());
+  for (QCPErrorBarsDataContainer::const_iterator it=begin; it!=end; ++it)
+  {
+    const int index = int(it-mDataContainer->constBegin());
+    if (checkPointVisibility && !errorBarVisible(index))
+      continue;
+    const QPointF centerPixel = mDataPlottable->interface1D()->dataPixelPosition(index);
+    const double centerErrorAxisPixel = errorIsVertical ? centerPixel.y() : centerPixel.x();
+    const double centerOrthoAxisPixel = errorIsVertical ? centerPixel.x() : centerPixel.y();
+    if (qIsNaN(centerErrorAxisPixel) || !(centerOrthoAxisPixel >= firstColumn && centerOrthoAxisPixel < firstColumn+columnCount)) // also skips NaN
+      continue;
+    const int column = int(centerOrthoAxisPixel)-firstColumn;
+    const double centerErrorAxisCoord = errorAxis->pixelToCoord(centerErrorAxisPixel);
+    const double plusEnd = qIsNaN(it->errorPlus) ? centerErrorAxisPixel : errorAxis->coordToPixel(centerErrorAxisCoord+it->errorPlus);
+    const double minusEnd = qIsNaN(it->errorMinus) ? centerErrorAxisPixel : errorAxis->coordToPixel(centerErrorAxisCoord-it->errorMinus);
+    lower[column] = qMin(lower.at(column), qMin(plusEnd, minusEnd));
+    upper[column] = qMax(upper.at(column), qMax(plusEnd, minusEnd));
+  }
+  
+  for (int column=0; column<columnCount; ++column)
+  {
+    if (lower.at(column) > upper.at(column)) // no error bar in this column
+      continue;
+    const double center = firstColumn+column+0.5;
+    if (errorIsVertical)
+      envelope.append(QLineF(center, lower.at(column), center, upper.at(column)));
+    else
+      envelope.append(QLineF(lower.at(column), center, upper.at(column), center));
+  }
+}
+
 /*! \internal
 
   This method outputs the currently visible data range via \a begin and \a end. The returned range
@@ -32627,7 +36881,6 @@ QCPPolarAxisAngular::QCPPolarAxisAngular(QCustomPlot *parentPlot) :
   setTickLabelMode(lmUpright);
   mLabelPainter.setAnchorReferenceType(QCPLabelPainterPrivate::artNormal);
   mLabelPainter.setAbbreviateDecimalPowers(false);
-  mLabelPainter.setCacheSize(24); // so we can cache up to 15-degree intervals, polar angular axis uses a bit larger cache than normal axes
   
   setMinimumSize(50, 50);
   setMinimumMargins(QMargins(30, 30, 30, 30));
@@ -34449,7 +38702,8 @@ QCPPolarGraph::QCPPolarGraph(QCPPolarAxisAngular *keyAxis, QCPPolarAxisRadial *v
   mPeriodic(true),
   mKeyAxis(keyAxis),
   mValueAxis(valueAxis),
-  mSelectable(QCP::stWhole)
+  mSelectable(QCP::stWhole),
+  mAdaptiveSampling(true)
   //mSelectionDecorator(0) // TODO
 {
   if (keyAxis->parentPlot() != valueAxis->parentPlot())
@@ -34684,6 +38938,25 @@ void QCPPolarGraph::setScatterStyle(const QCPScatterStyle &style)
   mScatterStyle = style;
 }
 
+/*!
+  Sets whether adaptive sampling shall be used when plotting this graph, similar to \ref
+  QCPGraph::setAdaptiveSampling. This drastically improves the replot performance of long angular
+  sweeps, e.g. antenna patterns or vibration of rotating machines, without notably changing the
+  appearance of the graph.
+
+  The angular axis is divided into buckets that span one pixel on the outer circle. Consecutive
+  points inside the visible circle that fall into the same bucket are merged into the first, the
+  lowest, the highest and the last of them, so radial extremes and outliers are preserved. Of
+  consecutive scatters, only those are drawn which don't fall into the same bucket and pixel radius
+  as their predecessor.
+
+  By default, adaptive sampling is enabled.
+*/
+void QCPPolarGraph::setAdaptiveSampling(bool enabled)
+{
+  mAdaptiveSampling = enabled;
+}
+
 void QCPPolarGraph::addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted)
 {
   if (keys.size() != values.size())
@@ -35394,11 +39667,31 @@ void QCPPolarGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const
   double skipBegin = 0;
   bool belowRange = false;
   bool aboveRange = false;
+  
+  // with adaptive sampling, runs of visible points in the same angular bucket (one pixel on the outer circle) are
+  // merged into their first, lowest, highest and last point:
+  const double bucketKeySize = mAdaptiveSampling && mKeyAxis->radius() > 0 ? mKeyAxis->range().size()/(2*M_PI*mKeyAxis->radius()) : 0;
+  QCPGraphDataContainer::const_iterator runBegin = end, runMin = end, runMax = end;
+  double runBucket = 0;
+  auto flushRun = [&](const QCPGraphDataContainer::const_iterator &runEnd)
+  {
+    if (runBegin == end)
+      return;
+    const QCPGraphDataContainer::const_iterator candidates[4] = {runBegin, runMin < runMax ? runMin : runMax, runMin < runMax ? runMax : runMin, runEnd-1};
+    for (int k=0; k<4; ++k)
+    {
+      if (k == 0 || candidates[k] != candidates[k-1])
+        lineData->append(*candidates[k]);
+    }
+    runBegin = end;
+  };
+  
   QCPGraphDataContainer::const_iterator it = begin;
   while (it != end)
   {
     if (it->value < lowerClipValue)
     {
+      flushRun(it);
       if (aboveRange) // jumped directly from above to below visible range, draw previous point so entry angle is correct
       {
         aboveRange = false;
@@ -35418,6 +39711,7 @@ void QCPPolarGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const
       }
     } else if (it->value > upperClipValue)
     {
+      flushRun(it);
       if (belowRange) // jumped directly from below to above visible range, draw previous point so entry angle is correct (if lower means outer, so if reversed axis)
       {
         belowRange = false;
@@ -35449,10 +39743,28 @@ void QCPPolarGraph::getOptimizedLineData(QVector<QCPGraphData> *lineData, const
         if (reversed)
           lineData->append(*(it-1)); // just entered from below, draw previous point so entry angle is correct (if below means outer, so if reversed axis)
       }
-      lineData->append(*it); // inside visible circle, add point normally
+      if (bucketKeySize > 0 && !qIsNaN(it->value)) // NaN values aren't merged, so they keep creating gaps in the line
+      {
+        const double bucket = std::floor(it->key/bucketKeySize);
+        if (runBegin == end || bucket != runBucket)
+        {
+          flushRun(it);
+          runBegin = runMin = runMax = it;
+          runBucket = bucket;
+        } else
+        {
+          if (it->value < runMin->value) runMin = it;
+          if (it->value > runMax->value) runMax = it;
+        }
+      } else
+      {
+        flushRun(it);
+        lineData->append(*it); // inside visible circle, add point normally
+      }
     }
     ++it;
   }
+  flushRun(it);
   // to make fill not erratic, add last point normally if it was outside visible circle:
   if (aboveRange)
   {
@@ -35477,11 +39789,26 @@ void QCPPolarGraph::getOptimizedScatterData(QVector<QCPGraphData> *scatterData,
   const double clipMargin = range.size()*0.05;
   const double upperClipValue = range.upper + (reversed ? 0 : clipMargin); // clip slightly outside of actual range to avoid scatter size to peek into visible circle
   const double lowerClipValue = range.lower - (reversed ? clipMargin : 0); // clip slightly outside of actual range to avoid scatter size to peek into visible circle
+  // with adaptive sampling, a scatter is skipped if it falls into the same angular bucket (see getOptimizedLineData) and
+  // pixel radius as the previously added one:
+  const double bucketKeySize = mAdaptiveSampling && mKeyAxis->radius() > 0 ? mKeyAxis->range().size()/(2*M_PI*mKeyAxis->radius()) : 0;
+  double lastBucket = qQNaN(), lastRadius = qQNaN();
   QCPGraphDataContainer::const_iterator it = begin;
   while (it != end)
   {
     if (it->value > lowerClipValue && it->value < upperClipValue)
-      scatterData->append(*it);
+    {
+      if (bucketKeySize > 0)
+      {
+        const double bucket = std::floor(it->key/bucketKeySize);
+        const double radius = std::floor(mValueAxis->coordToRadius(it->value));
+        if (bucket != lastBucket || radius != lastRadius)
+          scatterData->append(*it);
+        lastBucket = bucket;
+        lastRadius = radius;
+      } else
+        scatterData->append(*it);
+    }
     ++it;
   }
 }
@@ -71,12 +71,17 @@
 #include <QtCore/QPointer>
 #include <QtCore/QSharedPointer>
 #include <QtCore/QTimer>
+#include <QtCore/QElapsedTimer>
+#include <QtCore/QFutureWatcher>
+#include <QtCore/QMutex>
+#include <QtCore/QBitArray>
 #include <QtGui/QPainter>
 #include <QtGui/QPainterPath>
 #include <QtGui/QPaintEvent>
 #include <QtGui/QMouseEvent>
 #include <QtGui/QWheelEvent>
 #include <QtGui/QPixmap>
+#include <QtGui/QImage>
 #include <QtCore/QVector>
 #include <QtCore/QString>
 #include <QtCore/QDateTime>
@@ -262,6 +267,13 @@ enum PlottingHint { phNone              = 0x000 ///< <tt>0x000</tt> No hints are
                     ,phImmediateRefresh = 0x002 ///< <tt>0x002</tt> causes an immediate repaint() instead of a soft update() when QCustomPlot::replot() is called with parameter \ref QCustomPlot::rpRefreshHint.
                                                 ///<                This is set by default to prevent the plot from freezing on fast consecutive replots (e.g. user drags ranges with mouse).
                     ,phCacheLabels      = 0x004 ///< <tt>0x004</tt> axis (tick) labels will be cached as pixmaps, increasing replot performance.
+                    ,phParallelPreparation = 0x008 ///< <tt>0x008</tt> the line and scatter pixel data of all visible graphs is prepared concurrently on the global thread pool
+                                                ///<                before painting. Painting itself stays serial. Most effective for figures with many large graphs.
+                    ,phFrameScheduling  = 0x010 ///< <tt>0x010</tt> replots requested with \ref QCustomPlot::rpQueuedReplot (and user interactions) are rendered at most once per frame
+                                                ///<                interval and not at all while the widget is hidden, see \ref QCustomPlot::setFrameInterval.
+                    ,phRasterLines      = 0x020 ///< <tt>0x020</tt> thin graph and curve lines (solid, opaque, 1 px and not antialiased) are written directly into the pixels of QImage
+                                                ///<                paint devices instead of going through the paint engine, see \ref QCPPainter::drawRasterPolyline. The paint
+                                                ///<                buffers become QImages (\ref QCPPaintBufferImage) so this applies to replots as well as \ref QCustomPlot::toImage.
                   };
 Q_DECLARE_FLAGS(PlottingHints, PlottingHint)
 
@@ -524,6 +536,10 @@ public:
   
   // non-virtual methods:
   void makeNonCosmetic();
+  bool drawRasterPolyline(const QVector<QPointF> &lineData);
+  
+  // static methods:
+  static QVector<QPointF> dashPolyline(const QVector<QPointF> &lineData, const QPen &pen, const QRectF &clipRect);
   
 protected:
   // property members:
@@ -532,6 +548,9 @@ protected:
   
   // non-property members:
   QStack<bool> mAntialiasingStack;
+  
+  // static methods:
+  static bool clipLineParameters(const QPointF &start, const QPointF &end, const QRectF &rect, double &t0, double &t1);
 };
 Q_DECLARE_OPERATORS_FOR_FLAGS(QCPPainter::PainterModes)
 Q_DECLARE_METATYPE(QCPPainter::PainterMode)
@@ -597,6 +616,26 @@ protected:
 };
 
 
+class QCP_LIB_DECL QCPPaintBufferImage : public QCPAbstractPaintBuffer
+{
+public:
+  explicit QCPPaintBufferImage(const QSize &size, double devicePixelRatio);
+  virtual ~QCPPaintBufferImage() Q_DECL_OVERRIDE;
+  
+  // reimplemented virtual methods:
+  virtual QCPPainter *startPainting() Q_DECL_OVERRIDE;
+  virtual void draw(QCPPainter *painter) const Q_DECL_OVERRIDE;
+  void clear(const QColor &color) Q_DECL_OVERRIDE;
+  
+protected:
+  // non-property members:
+  QImage mBuffer;
+  
+  // reimplemented virtual methods:
+  virtual void reallocateBuffer() Q_DECL_OVERRIDE;
+};
+
+
 #ifdef QCP_OPENGL_PBUFFER
 class QCP_LIB_DECL QCPPaintBufferGlPbuffer : public QCPAbstractPaintBuffer
 {
@@ -1557,6 +1596,51 @@ Q_DECLARE_METATYPE(QCPLineEnding::EndingStyle)
 /* end of 'src/lineending.h' */
 
 
+/* including file 'src/labelcache.h'       */
+
+class QCP_LIB_DECL QCPLabelCache
+{
+public:
+  /*!
+    Holds a rendered label and the offset from its anchor to the top left of the pixmap.
+  */
+  struct Label
+  {
+    QPointF offset;
+    QPixmap pixmap;
+  };
+  
+  static QCPLabelCache *instance();
+  
+  // getters:
+  qint64 memoryLimit() const;
+  qint64 memoryUsage() const;
+  int count() const;
+  qint64 hits() const;
+  qint64 misses() const;
+  double hitRate() const;
+  
+  // setters:
+  void setMemoryLimit(qint64 bytes);
+  
+  // non-virtual methods:
+  bool find(const QByteArray &key, Label *label);
+  void insert(const QByteArray &key, const Label &label);
+  void clear();
+  
+protected:
+  // non-property members:
+  mutable QMutex mMutex; // labels may be rendered by several plots in different threads, see QCustomPlot::toImage
+  QCache<QByteArray, Label> mLabels; // the cost of each label is the memory of its pixmap in bytes
+  qint64 mHits, mMisses;
+  
+  QCPLabelCache();
+  Q_DISABLE_COPY(QCPLabelCache)
+};
+
+/* end of 'src/labelcache.h' */
+
+
 /* including file 'src/axis/labelpainter.h' */
 /* modified 2021-03-29T02:30:44, size 7086  */
 
@@ -1610,7 +1694,6 @@ public:
   void setSubstituteExponent(bool enabled);
   void setMultiplicationSymbol(QChar symbol);
   void setAbbreviateDecimalPowers(bool enabled);
-  void setCacheSize(int labelCount);
   
   // getters:
   AnchorMode anchorMode() const { return mAnchorMode; }
@@ -1624,7 +1707,6 @@ public:
   bool substituteExponent() const { return mSubstituteExponent; }
   QChar multiplicationSymbol() const { return mMultiplicationSymbol; }
   bool abbreviateDecimalPowers() const { return mAbbreviateDecimalPowers; }
-  int cacheSize() const;
   
   //virtual int size() const;
   
@@ -1637,11 +1719,6 @@ public:
   static const QChar SymbolCross;
   
 protected:
-  struct CachedLabel
-  {
-    QPoint offset;
-    QPixmap pixmap;
-  };
   struct LabelData
   {
     AnchorSide side;
@@ -1669,8 +1746,6 @@ protected:
   bool mAbbreviateDecimalPowers;
   // non-property members:
   QCustomPlot *mParentPlot;
-  QByteArray mLabelParameterHash; // to determine whether mLabelCache needs to be cleared due to changed parameters
-  QCache<QString, CachedLabel> mLabelCache;
   QRect mAxisSelectionBox, mTickLabelsSelectionBox, mLabelSelectionBox;
   int mLetterCapHeight, mLetterDescent;
   
@@ -1684,7 +1759,7 @@ protected:
   LabelData getTickLabelData(const QFont &font, const QColor &color, double rotation, AnchorSide side, const QString &text) const;
   void applyAnchorTransform(LabelData &labelData) const;
   //void getMaxTickLabelSize(const QFont &font, const QString &text, QSize *tickLabelsSize) const;
-  CachedLabel *createCachedLabel(const LabelData &labelData) const;
+  QCPLabelCache::Label createCachedLabel(const LabelData &labelData) const;
   QByteArray cacheKey(const QString &text, const QColor &color, double rotation, AnchorSide side) const;
   AnchorSide skewedAnchorSide(const QPointF &tickPos, double sideExpandHorz, double sideExpandVert) const;
   AnchorSide rotationCorrectedSide(AnchorSide side, double rotation) const;
@@ -2286,6 +2361,8 @@ public:
   void rescale(bool onlyVisiblePlottables=false);
   double pixelToCoord(double value) const;
   double coordToPixel(double value) const;
+  void coordsToPixels(const double *coords, double *pixels, int count, int coordStride=1, int pixelStride=1) const;
+  void coordsToPixels(const double *coords, float *pixels, int count, int coordStride=1, int pixelStride=1) const;
   SelectablePart getPartAt(const QPointF &pos) const;
   QList<QCPAbstractPlottable*> plottables() const;
   QList<QCPGraph*> graphs() const;
@@ -2303,6 +2380,14 @@ signals:
   void selectableChanged(const QCPAxis::SelectableParts &parts);
 
 protected:
+  struct PixelTransform // pixel = (coord-origin)*scale+offset on linear, ln(coord/origin)*scale+offset on logarithmic axes
+  {
+    bool logarithmic;
+    double origin, scale, offset;
+    bool negativeRange; // logarithmic only: coords with the sign opposite to the range are drawn at invalidPixel
+    double invalidPixel;
+  };
+  
   // property members:
   // axis base:
   AxisType mAxisType;
@@ -2377,6 +2462,10 @@ protected:
   QFont getLabelFont() const;
   QColor getTickLabelColor() const;
   QColor getLabelColor() const;
+  PixelTransform pixelTransform() const;
+  template <typename PixelType>
+  static void transformCoords(const PixelTransform &transform, const double *coords, PixelType *pixels, int count, int coordStride, int pixelStride);
+  static int transformCoordsAvx2(const PixelTransform &transform, const double *coords, double *pixels, int count, int coordStride, int pixelStride);
   
 private:
   Q_DISABLE_COPY(QCPAxis)
@@ -2434,11 +2523,6 @@ public:
   QVector<QString> tickLabels;
   
 protected:
-  struct CachedLabel
-  {
-    QPointF offset;
-    QPixmap pixmap;
-  };
   struct TickLabelData
   {
     QString basePart, expPart, suffixPart;
@@ -2446,8 +2530,7 @@ protected:
     QFont baseFont, expFont;
   };
   QCustomPlot *mParentPlot;
-  QByteArray mLabelParameterHash; // to determine whether mLabelCache needs to be cleared due to changed parameters
-  QCache<QString, CachedLabel> mLabelCache;
+  QByteArray mLabelParameterHash; // the label parameters of the current draw/size call, prefix of the keys in QCPLabelCache
   QRect mAxisSelectionBox, mTickLabelsSelectionBox, mLabelSelectionBox;
   
   virtual QByteArray generateLabelParameterHash() const;
@@ -2580,6 +2663,30 @@ Q_DECLARE_METATYPE(QCPScatterStyle::ScatterShape)
 template <class DataType>
 inline bool qcpLessThanSortKey(const DataType &a, const DataType &b) { return a.sortKey() < b.sortKey(); }
 
+class QCP_LIB_DECL QCPRangeIndex
+{
+public:
+  QCPRangeIndex();
+  
+  // getters:
+  int blockCount() const { return mBlockCount; }
+  
+  // non-virtual methods:
+  void resize(int blockCount);
+  void clear();
+  void setBlock(int block, const double *lower, const double *upper);
+  void updateNodes(int firstBlock);
+  QCPRange query(int firstBlock, int endBlock, QCP::SignDomain signDomain, bool &haveLower, bool &haveUpper) const;
+  
+  static const int blockSize = 64;
+  
+protected:
+  // non-property members:
+  int mBlockCount;
+  int mLeafCount;
+  QVector<double> mLower[3], mUpper[3]; // one segment tree per QCP::SignDomain
+};
+
 template <class DataType>
 class QCPDataContainer // no QCP_LIB_DECL, template class ends up in header (cpp included below)
 {
@@ -2593,9 +2700,14 @@ public:
   int size() const { return mData.size()-mPreallocSize; }
   bool isEmpty() const { return size() == 0; }
   bool autoSqueeze() const { return mAutoSqueeze; }
+  bool rangeIndex() const { return mRangeIndexEnabled; }
+  int capacity() const { return mCapacity; }
+  quint64 revision() const { return mRevision; }
   
   // setters:
   void setAutoSqueeze(bool enabled);
+  void setRangeIndex(bool enabled);
+  void setCapacity(int capacity);
   
   // non-virtual methods:
   void set(const QCPDataContainer<DataType> &data);
@@ -2610,6 +2722,7 @@ public:
   void clear();
   void sort();
   void squeeze(bool preAllocation=true, bool postAllocation=true);
+  void invalidateRangeIndex() { markRangeIndexDirty(0); }
   
   const_iterator constBegin() const { return mData.constBegin()+mPreallocSize; }
   const_iterator constEnd() const { return mData.constEnd(); }
@@ -2626,15 +2739,24 @@ public:
 protected:
   // property members:
   bool mAutoSqueeze;
+  bool mRangeIndexEnabled;
+  int mCapacity;
   
   // non-property memebers:
   QVector<DataType> mData;
   int mPreallocSize;
   int mPreallocIteration;
+  QCPRangeIndex mRangeIndex;
+  int mRangeIndexDirtyFrom;
+  quint64 mRevision;
   
   // non-virtual methods:
   void preallocateGrow(int minimumPreallocSize);
   void performAutoSqueeze();
+  void enforceCapacity();
+  void markRangeIndexDirty(int position) { mRangeIndexDirtyFrom = qMin(mRangeIndexDirtyFrom, position); ++mRevision; }
+  void updateRangeIndex();
+  void expandValueRange(QCPRange &range, bool &haveLower, bool &haveUpper, QCP::SignDomain signDomain, const QCPRange &inKeyRange, const_iterator begin, const_iterator end) const;
 };
 
 
@@ -2761,6 +2883,26 @@ protected:
   dataselection-accessing "data selection page" for an example.
 */
 
+/*! \fn void QCPDataContainer<DataType>::invalidateRangeIndex()
+
+  Marks the whole range index as outdated, so it is rebuilt the next time it is needed. This is
+  only necessary if the range index is enabled (\ref setRangeIndex) and the values of data points
+  were changed in-place through the non-const iterators (\ref begin, \ref end). All other
+  modifications of the container keep the index up to date automatically.
+
+  This also advances the \ref revision of the container.
+*/
+
+/*! \fn quint64 QCPDataContainer<DataType>::revision() const
+
+  Returns a number that changes whenever the data in this container is modified through its
+  methods, including removals at the front (\ref removeBefore, or \ref setCapacity dropping the
+  oldest points) that only move \ref begin. Plottables use it to detect whether caches derived from
+  the data, like the hit test index of \ref QCPGraph, are outdated. In-place modifications through
+  the non-const iterators (\ref begin, \ref end) are only reflected after a call to \ref
+  invalidateRangeIndex.
+*/
+
 /*! \fn QCPDataRange QCPDataContainer::dataRange() const
 
   Returns a \ref QCPDataRange encompassing the entire data set of this container. This means the
@@ -2776,8 +2918,12 @@ protected:
 template <class DataType>
 QCPDataContainer<DataType>::QCPDataContainer() :
   mAutoSqueeze(true),
+  mRangeIndexEnabled(false),
+  mCapacity(0),
   mPreallocSize(0),
-  mPreallocIteration(0)
+  mPreallocIteration(0),
+  mRangeIndexDirtyFrom(0),
+  mRevision(0)
 {
 }
 
@@ -2800,6 +2946,59 @@ void QCPDataContainer<DataType>::setAutoSqueeze(bool enabled)
   }
 }
 
+/*!
+  Sets whether the container maintains an index of the value ranges spanned by blocks of
+  consecutive data points (see \ref QCPRangeIndex). With the index enabled, \ref valueRange
+  (and thus value axis rescaling via \ref QCPAxis::rescale or \ref
+  QCPAbstractPlottable::rescaleValueAxis) only needs to look at the data points at the borders of
+  the requested key range, and answers in logarithmic instead of linear time.
+
+  The index is built lazily on the first query, and afterwards updated incrementally when data is
+  appended, so it costs little for streaming data. It requires roughly 1/5 of additional memory
+  compared to the data of a QCPGraph. By default the range index is disabled.
+
+  \note If you modify the values of data points in-place through the non-const iterators, call
+  \ref invalidateRangeIndex afterwards.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::setRangeIndex(bool enabled)
+{
+  if (mRangeIndexEnabled != enabled)
+  {
+    mRangeIndexEnabled = enabled;
+    mRangeIndex.clear();
+    mRangeIndexDirtyFrom = 0;
+  }
+}
+
+/*!
+  Limits the number of data points held by this container to \a capacity. Whenever data is added
+  beyond the capacity, the data points with the lowest (sort-)keys are removed, so the container
+  keeps the most recent \a capacity points of streaming data, like a ring buffer. Set \a capacity
+  to 0 (the default) for an unlimited container.
+
+  Unlike a sequence of \ref add and \ref removeBefore calls, appending to a container with a
+  capacity neither shifts nor reallocates the data on every call: Memory for twice the capacity is
+  reserved once. Removed points only advance the start of the data, and when as many points were
+  removed as are retained, the retained points are moved to the front in one go. Appending and
+  removing thus costs constant time per data point on average, and the memory use stays constant.
+  The automatic squeezing (\ref setAutoSqueeze) doesn't apply to containers with a capacity.
+
+  Like with other containers, the data stays contiguous and sorted, so iterators obtained before
+  adding data become invalid.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::setCapacity(int capacity)
+{
+  mCapacity = qMax(0, capacity);
+  if (mCapacity > 0)
+  {
+    enforceCapacity();
+    mData.reserve(2*mCapacity+1);
+  } else if (mAutoSqueeze)
+    performAutoSqueeze();
+}
+
 /*! \overload
   
   Replaces the current data in this container with the provided \a data.
@@ -2828,8 +3027,10 @@ void QCPDataContainer<DataType>::set(const QVector<DataType> &data, bool already
   mData = data;
   mPreallocSize = 0;
   mPreallocIteration = 0;
+  markRangeIndexDirty(0);
   if (!alreadySorted)
     sort();
+  enforceCapacity();
 }
 
 /*! \overload
@@ -2853,13 +3054,19 @@ void QCPDataContainer<DataType>::add(const QCPDataContainer<DataType> &data)
       preallocateGrow(n);
     mPreallocSize -= n;
     std::copy(data.constBegin(), data.constEnd(), begin());
+    markRangeIndexDirty(mPreallocSize);
   } else // don't need to prepend, so append and merge if necessary
   {
+    markRangeIndexDirty(mData.size());
     mData.resize(mData.size()+n);
     std::copy(data.constBegin(), data.constEnd(), end()-n);
     if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
+    {
       std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
+      markRangeIndexDirty(mPreallocSize);
+    }
   }
+  enforceCapacity();
 }
 
 /*!
@@ -2890,15 +3097,21 @@ void QCPDataContainer<DataType>::add(const QVector<DataType> &data, bool already
       preallocateGrow(n);
     mPreallocSize -= n;
     std::copy(data.constBegin(), data.constEnd(), begin());
+    markRangeIndexDirty(mPreallocSize);
   } else // don't need to prepend, so append and then sort and merge if necessary
   {
+    markRangeIndexDirty(mData.size());
     mData.resize(mData.size()+n);
     std::copy(data.constBegin(), data.constEnd(), end()-n);
     if (!alreadySorted) // sort appended subrange if it wasn't already sorted
       std::sort(end()-n, end(), qcpLessThanSortKey<DataType>);
     if (oldSize > 0 && !qcpLessThanSortKey<DataType>(*(constEnd()-n-1), *(constEnd()-n))) // if appended range keys aren't all greater than existing ones, merge the two partitions
+    {
       std::inplace_merge(begin(), end()-n, end(), qcpLessThanSortKey<DataType>);
+      markRangeIndexDirty(mPreallocSize);
+    }
   }
+  enforceCapacity();
 }
 
 /*! \overload
@@ -2912,6 +3125,7 @@ void QCPDataContainer<DataType>::add(const DataType &data)
 {
   if (isEmpty() || !qcpLessThanSortKey<DataType>(data, *(constEnd()-1))) // quickly handle appends if new data key is greater or equal to existing ones
   {
+    markRangeIndexDirty(mData.size());
     mData.append(data);
   } else if (qcpLessThanSortKey<DataType>(data, *constBegin()))  // quickly handle prepends using preallocated space
   {
@@ -2919,11 +3133,14 @@ void QCPDataContainer<DataType>::add(const DataType &data)
       preallocateGrow(1);
     --mPreallocSize;
     *begin() = data;
+    markRangeIndexDirty(mPreallocSize);
   } else // handle inserts, maintaining sorted keys
   {
     QCPDataContainer<DataType>::iterator insertionPoint = std::lower_bound(begin(), end(), data, qcpLessThanSortKey<DataType>);
+    markRangeIndexDirty(int(insertionPoint-mData.begin()));
     mData.insert(insertionPoint, data);
   }
+  enforceCapacity();
 }
 
 /*!
@@ -2937,6 +3154,8 @@ void QCPDataContainer<DataType>::removeBefore(double sortKey)
   QCPDataContainer<DataType>::iterator it = begin();
   QCPDataContainer<DataType>::iterator itEnd = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
   mPreallocSize += int(itEnd-it); // don't actually delete, just add it to the preallocated block (if it gets too large, squeeze will take care of it)
+  if (itEnd != it)
+    ++mRevision; // the range index is still valid, but indices relative to begin() are not
   if (mAutoSqueeze)
     performAutoSqueeze();
 }
@@ -2951,6 +3170,7 @@ void QCPDataContainer<DataType>::removeAfter(double sortKey)
 {
   QCPDataContainer<DataType>::iterator it = std::upper_bound(begin(), end(), DataType::fromSortKey(sortKey), qcpLessThanSortKey<DataType>);
   QCPDataContainer<DataType>::iterator itEnd = end();
+  markRangeIndexDirty(int(it-mData.begin()));
   mData.erase(it, itEnd); // typically adds it to the postallocated block
   if (mAutoSqueeze)
     performAutoSqueeze();
@@ -2971,6 +3191,7 @@ void QCPDataContainer<DataType>::remove(double sortKeyFrom, double sortKeyTo)
   
   QCPDataContainer<DataType>::iterator it = std::lower_bound(begin(), end(), DataType::fromSortKey(sortKeyFrom), qcpLessThanSortKey<DataType>);
   QCPDataContainer<DataType>::iterator itEnd = std::upper_bound(it, end(), DataType::fromSortKey(sortKeyTo), qcpLessThanSortKey<DataType>);
+  markRangeIndexDirty(int(it-mData.begin()));
   mData.erase(it, itEnd);
   if (mAutoSqueeze)
     performAutoSqueeze();
@@ -2992,9 +3213,14 @@ void QCPDataContainer<DataType>::remove(double sortKey)
   if (it != end() && it->sortKey() == sortKey)
   {
     if (it == begin())
+    {
       ++mPreallocSize; // don't actually delete, just add it to the preallocated block (if it gets too large, squeeze will take care of it)
-    else
+      ++mRevision;
+    } else
+    {
+      markRangeIndexDirty(int(it-mData.begin()));
       mData.erase(it);
+    }
   }
   if (mAutoSqueeze)
     performAutoSqueeze();
@@ -3011,6 +3237,7 @@ void QCPDataContainer<DataType>::clear()
   mData.clear();
   mPreallocIteration = 0;
   mPreallocSize = 0;
+  markRangeIndexDirty(0);
 }
 
 /*!
@@ -3028,6 +3255,7 @@ template <class DataType>
 void QCPDataContainer<DataType>::sort()
 {
   std::sort(begin(), end(), qcpLessThanSortKey<DataType>);
+  markRangeIndexDirty(mPreallocSize);
 }
 
 /*!
@@ -3050,6 +3278,7 @@ void QCPDataContainer<DataType>::squeeze(bool preAllocation, bool postAllocation
       std::copy(begin(), end(), mData.begin());
       mData.resize(size());
       mPreallocSize = 0;
+      markRangeIndexDirty(0);
     }
     mPreallocIteration = 0;
   }
@@ -3261,7 +3490,6 @@ QCPRange QCPDataContainer<DataType>::valueRange(bool &foundRange, QCP::SignDomai
   const bool restrictKeyRange = inKeyRange != QCPRange();
   bool haveLower = false;
   bool haveUpper = false;
-  QCPRange current;
   QCPDataContainer<DataType>::const_iterator itBegin = constBegin();
   QCPDataContainer<DataType>::const_iterator itEnd = constEnd();
   if (DataType::sortKeyIsMainKey() && restrictKeyRange)
@@ -3269,9 +3497,59 @@ QCPRange QCPDataContainer<DataType>::valueRange(bool &foundRange, QCP::SignDomai
     itBegin = findBegin(inKeyRange.lower, false);
     itEnd = findEnd(inKeyRange.upper, false);
   }
+  if (mRangeIndexEnabled && (DataType::sortKeyIsMainKey() || !restrictKeyRange)) // iterators mark exactly the requested data points, so whole blocks can be taken from the range index
+  {
+    updateRangeIndex();
+    const int beginPosition = int(itBegin-mData.constBegin());
+    const int endPosition = int(itEnd-mData.constBegin());
+    const int firstBlock = (beginPosition+QCPRangeIndex::blockSize-1)/QCPRangeIndex::blockSize;
+    const int endBlock = endPosition/QCPRangeIndex::blockSize;
+    if (firstBlock < endBlock) // at least one full block in range, only the partial blocks at the borders need to be scanned
+    {
+      range = mRangeIndex.query(firstBlock, endBlock, signDomain, haveLower, haveUpper);
+      expandValueRange(range, haveLower, haveUpper, signDomain, inKeyRange, itBegin, mData.constBegin()+firstBlock*QCPRangeIndex::blockSize);
+      expandValueRange(range, haveLower, haveUpper, signDomain, inKeyRange, mData.constBegin()+endBlock*QCPRangeIndex::blockSize, itEnd);
+      foundRange = haveLower && haveUpper;
+      return range;
+    }
+  }
+  expandValueRange(range, haveLower, haveUpper, signDomain, inKeyRange, itBegin, itEnd);
+  
+  foundRange = haveLower && haveUpper;
+  return range;
+}
+
+/*!
+  Makes sure \a begin and \a end mark a data range that is both within the bounds of this data
+  container's data, as well as within the specified \a dataRange. The initial range described by
+  the passed iterators \a begin and \a end is never expanded, only contracted if necessary.
+  
+  This function doesn't require for \a dataRange to be within the bounds of this data container's
+  valid range.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::limitIteratorsToDataRange(const_iterator &begin, const_iterator &end, const QCPDataRange &dataRange) const
+{
+  QCPDataRange iteratorRange(int(begin-constBegin()), int(end-constBegin()));
+  iteratorRange = iteratorRange.bounded(dataRange.bounded(this->dataRange()));
+  begin = constBegin()+iteratorRange.begin();
+  end = constBegin()+iteratorRange.end();
+}
+
+/*! \internal
+
+  Expands \a range by the value ranges of the data points from \a begin up to (excluding) \a end,
+  in the same manner as documented for \ref valueRange. \a haveLower and \a haveUpper indicate
+  whether the respective bound of \a range is already valid, and are updated accordingly.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::expandValueRange(QCPRange &range, bool &haveLower, bool &haveUpper, QCP::SignDomain signDomain, const QCPRange &inKeyRange, const_iterator begin, const_iterator end) const
+{
+  const bool restrictKeyRange = inKeyRange != QCPRange();
+  QCPRange current;
   if (signDomain == QCP::sdBoth) // range may be anywhere
   {
-    for (QCPDataContainer<DataType>::const_iterator it = itBegin; it != itEnd; ++it)
+    for (QCPDataContainer<DataType>::const_iterator it = begin; it != end; ++it)
     {
       if (restrictKeyRange && (it->mainKey() < inKeyRange.lower || it->mainKey() > inKeyRange.upper))
         continue;
@@ -3289,7 +3567,7 @@ QCPRange QCPDataContainer<DataType>::valueRange(bool &foundRange, QCP::SignDomai
     }
   } else if (signDomain == QCP::sdNegative) // range may only be in the negative sign domain
   {
-    for (QCPDataContainer<DataType>::const_iterator it = itBegin; it != itEnd; ++it)
+    for (QCPDataContainer<DataType>::const_iterator it = begin; it != end; ++it)
     {
       if (restrictKeyRange && (it->mainKey() < inKeyRange.lower || it->mainKey() > inKeyRange.upper))
         continue;
@@ -3307,7 +3585,7 @@ QCPRange QCPDataContainer<DataType>::valueRange(bool &foundRange, QCP::SignDomai
     }
   } else if (signDomain == QCP::sdPositive) // range may only be in the positive sign domain
   {
-    for (QCPDataContainer<DataType>::const_iterator it = itBegin; it != itEnd; ++it)
+    for (QCPDataContainer<DataType>::const_iterator it = begin; it != end; ++it)
     {
       if (restrictKeyRange && (it->mainKey() < inKeyRange.lower || it->mainKey() > inKeyRange.upper))
         continue;
@@ -3324,26 +3602,58 @@ QCPRange QCPDataContainer<DataType>::valueRange(bool &foundRange, QCP::SignDomai
       }
     }
   }
-  
-  foundRange = haveLower && haveUpper;
-  return range;
 }
 
-/*!
-  Makes sure \a begin and \a end mark a data range that is both within the bounds of this data
-  container's data, as well as within the specified \a dataRange. The initial range described by
-  the passed iterators \a begin and \a end is never expanded, only contracted if necessary.
-  
-  This function doesn't require for \a dataRange to be within the bounds of this data container's
-  valid range.
+/*! \internal
+
+  Brings the range index (see \ref setRangeIndex) up to date, by recalculating the blocks that
+  were affected by modifications since the last update. Appending data only affects the last
+  blocks, so the cost of an update is proportional to the number of appended data points.
 */
 template <class DataType>
-void QCPDataContainer<DataType>::limitIteratorsToDataRange(const_iterator &begin, const_iterator &end, const QCPDataRange &dataRange) const
+void QCPDataContainer<DataType>::updateRangeIndex()
 {
-  QCPDataRange iteratorRange(int(begin-constBegin()), int(end-constBegin()));
-  iteratorRange = iteratorRange.bounded(dataRange.bounded(this->dataRange()));
-  begin = constBegin()+iteratorRange.begin();
-  end = constBegin()+iteratorRange.end();
+  const int dataSize = mData.size();
+  const int blockCount = (dataSize+QCPRangeIndex::blockSize-1)/QCPRangeIndex::blockSize;
+  if (mRangeIndexDirtyFrom >= dataSize && mRangeIndex.blockCount() == blockCount)
+    return;
+  
+  const int firstBlock = qMin(mRangeIndexDirtyFrom, dataSize)/QCPRangeIndex::blockSize;
+  mRangeIndex.resize(blockCount);
+  double lower[3], upper[3]; // indexed by QCP::SignDomain
+  for (int block=firstBlock; block<blockCount; ++block)
+  {
+    for (int i=0; i<3; ++i)
+    {
+      lower[i] = std::numeric_limits<double>::infinity();
+      upper[i] = -std::numeric_limits<double>::infinity();
+    }
+    QCPDataContainer<DataType>::const_iterator it = mData.constBegin()+block*QCPRangeIndex::blockSize;
+    const QCPDataContainer<DataType>::const_iterator itEnd = mData.constBegin()+qMin(dataSize, (block+1)*QCPRangeIndex::blockSize);
+    for (; it != itEnd; ++it)
+    {
+      const QCPRange current = it->valueRange();
+      if (!qIsNaN(current.lower))
+      {
+        lower[QCP::sdBoth] = qMin(lower[QCP::sdBoth], current.lower);
+        if (current.lower < 0)
+          lower[QCP::sdNegative] = qMin(lower[QCP::sdNegative], current.lower);
+        else if (current.lower > 0)
+          lower[QCP::sdPositive] = qMin(lower[QCP::sdPositive], current.lower);
+      }
+      if (!qIsNaN(current.upper))
+      {
+        upper[QCP::sdBoth] = qMax(upper[QCP::sdBoth], current.upper);
+        if (current.upper < 0)
+          upper[QCP::sdNegative] = qMax(upper[QCP::sdNegative], current.upper);
+        else if (current.upper > 0)
+          upper[QCP::sdPositive] = qMax(upper[QCP::sdPositive], current.upper);
+      }
+    }
+    mRangeIndex.setBlock(block, lower, upper);
+  }
+  mRangeIndex.updateNodes(firstBlock);
+  mRangeIndexDirtyFrom = (std::numeric_limits<int>::max)();
 }
 
 /*! \internal
@@ -3369,6 +3679,7 @@ void QCPDataContainer<DataType>::preallocateGrow(int minimumPreallocSize)
   mData.resize(mData.size()+sizeDifference);
   std::copy_backward(mData.begin()+mPreallocSize, mData.end()-sizeDifference, mData.end());
   mPreallocSize = newPreallocSize;
+  markRangeIndexDirty(0);
 }
 
 /*! \internal
@@ -3388,6 +3699,8 @@ void QCPDataContainer<DataType>::preallocateGrow(int minimumPreallocSize)
 template <class DataType>
 void QCPDataContainer<DataType>::performAutoSqueeze()
 {
+  if (mCapacity > 0) // memory of containers with a capacity is managed by enforceCapacity
+    return;
   const int totalAlloc = mData.capacity();
   const int postAllocSize = totalAlloc-mData.size();
   const int usedSize = size();
@@ -3407,6 +3720,34 @@ void QCPDataContainer<DataType>::performAutoSqueeze()
     squeeze(shrinkPreAllocation, shrinkPostAllocation);
 }
 
+/*! \internal
+
+  Removes the data points with the lowest (sort-)keys until the container holds no more than \ref
+  setCapacity "capacity" points. If no capacity is set, this method does nothing.
+
+  The removed points are only added to the preallocation pool, like in \ref removeBefore. Once the
+  pool is as large as the capacity, the remaining points are moved to the front of the internal
+  buffer. Since this happens only after as many points were removed as are moved, the cost per
+  removed point is constant on average.
+*/
+template <class DataType>
+void QCPDataContainer<DataType>::enforceCapacity()
+{
+  if (mCapacity <= 0 || size() <= mCapacity)
+    return;
+  
+  mPreallocSize += size()-mCapacity;
+  ++mRevision;
+  if (mPreallocSize >= mCapacity)
+  {
+    std::copy(begin(), end(), mData.begin());
+    mData.resize(mCapacity); // doesn't release the reserved memory
+    mPreallocSize = 0;
+    mPreallocIteration = 0;
+    markRangeIndexDirty(0);
+  }
+}
+
 
 /* end of 'src/datacontainer.h' */
 
@@ -3753,6 +4094,134 @@ private:
 /* end of 'src/item.h' */
 
 
+/* including file 'src/renderprofiler.h'   */
+
+class QCP_LIB_DECL QCPRenderProfiler
+{
+public:
+  /*!
+    Defines the stages of drawing a plottable whose durations are recorded separately, see \ref
+    addStageTime.
+  */
+  enum Stage { stVisibleRange ///< finding the data that lies inside the visible key range
+               ,stSampling    ///< adaptive sampling of the visible data, see e.g. \ref QCPGraph::getOptimizedLineData
+               ,stTransform   ///< converting the sampled data to pixel coordinates
+               ,stPainting    ///< painting the pixel coordinates with the QCPPainter
+             };
+  static const int stageCount = 4;
+  
+  /*!
+    Holds what was recorded for one plottable during a frame. Times are in milliseconds.
+  */
+  struct PlottableProfile
+  {
+    QString name;
+    double stageTime[stageCount];
+    qint64 inputPoints, emittedPoints;
+  };
+  
+  /*!
+    Holds the time in milliseconds it took to draw one layer during a frame.
+  */
+  struct LayerProfile
+  {
+    QString name;
+    double time;
+  };
+  
+  QCPRenderProfiler();
+  
+  // getters (results of the last completed frame):
+  qint64 frameCount() const;
+  double frameTime() const;
+  QVector<PlottableProfile> plottableProfiles() const;
+  QVector<LayerProfile> layerProfiles() const;
+  int labelCacheHits() const;
+  int labelCacheMisses() const;
+  
+  // non-virtual methods:
+  void beginFrame();
+  void endFrame(double frameTime);
+  void addStageTime(const QCPAbstractPlottable *plottable, Stage stage, QElapsedTimer &timer);
+  void addPointCounts(const QCPAbstractPlottable *plottable, int inputPoints, int emittedPoints);
+  void addLayerTime(const QCPLayer *layer, double time);
+  void addLabelCacheAccess(bool hit);
+  QString summary() const;
+  QString toJson() const;
+  
+protected:
+  struct Frame
+  {
+    double time;
+    QVector<PlottableProfile> plottables;
+    QVector<LayerProfile> layers;
+    int labelCacheHits, labelCacheMisses;
+  };
+  
+  // non-property members:
+  mutable QMutex mMutex; // stages may be recorded from worker threads, see QCustomPlot::prepareGraphs
+  qint64 mFrameCount;
+  Frame mCurrentFrame, mLastFrame;
+  QHash<const QCPAbstractPlottable*, int> mPlottableIndices; // index of each plottable in mCurrentFrame.plottables
+  
+  // non-virtual methods:
+  PlottableProfile &plottableProfile(const QCPAbstractPlottable *plottable);
+};
+
+/* end of 'src/renderprofiler.h' */
+
+
+/* including file 'src/pixelgrid.h'        */
+
+class QCP_LIB_DECL QCPPixelGrid
+{
+public:
+  QCPPixelGrid();
+  
+  // getters:
+  QRect rect() const { return mRect; }
+  int cellSize() const { return mCellSize; }
+  bool isEmpty() const { return mRect.isEmpty(); }
+  
+  // non-virtual methods:
+  void clear();
+  void reset(const QRect &rect, int cellSize);
+  void addPoints(const QPointF *pixels, int count, int firstIndex);
+  void addPolyline(const QPointF *vertices, int count, bool pairwise);
+  void finish();
+  int nearestPoint(const QPointF &pos, double maxDistance, double *distance=nullptr) const;
+  double polylineDistance(const QPointF &pos, double maxDistance) const;
+  void rangesInRect(const QRectF &rect, QCPDataSelection *inside, QVector<QCPDataRange> *border) const;
+  
+protected:
+  struct Point
+  {
+    QPointF pos;
+    int index;
+  };
+  
+  // non-property members:
+  QRect mRect;
+  int mCellSize, mColumns, mRows;
+  QVector<Point> mPoints; // at most one point per pixel, sorted by cell
+  QVector<QCPDataRange> mRuns; // runs of consecutive data indices inside the same cell, sorted by cell
+  QVector<QLineF> mSegments; // polyline segments, listed in every cell their bounding box touches
+  QVector<int> mPointStart, mRunStart, mSegmentStart; // offsets of each cell's entries, with one additional element for the end
+  // only used while building, between reset and finish:
+  QVector<quint8> mPixelTaken;
+  QVector<int> mPointCells, mRunCells, mSegmentCells;
+  int mRunCell, mRunEnd;
+  
+  // non-virtual methods:
+  int cellAt(const QPointF &pos) const;
+  bool cellSpan(const QRectF &rect, int &firstColumn, int &firstRow, int &lastColumn, int &lastRow) const;
+  template <class T>
+  void sortByCell(QVector<T> &items, QVector<int> &cells, QVector<int> &cellStart) const;
+};
+
+/* end of 'src/pixelgrid.h' */
+
+
 /* including file 'src/core.h'              */
 /* modified 2021-03-29T02:30:44, size 19304 */
 
@@ -3794,6 +4263,20 @@ public:
                        };
   Q_ENUMS(RefreshPriority)
   
+  /*!
+    Defines how far the drawing quality is currently reduced to keep interactive replots within the
+    frame time budget. Each level includes the reductions of the levels before it.
+
+    \see setFrameTimeBudget, qualityLevel
+  */
+  enum QualityLevel { qlFull              ///< Everything is drawn as configured
+                      ,qlNoAntialiasing   ///< Plottables, scatters, fills and error bars aren't antialiased
+                      ,qlNoFills          ///< Graph and curve fills aren't drawn
+                      ,qlNoScatterShapes  ///< Scatters of graphs and curves are drawn as single dots (\ref QCPScatterStyle::ssDot)
+                      ,qlThinned          ///< The lines and scatters of graphs and curves are sampled at half the pixel resolution
+                    };
+  Q_ENUMS(QualityLevel)
+  
   explicit QCustomPlot(QWidget *parent = nullptr);
   virtual ~QCustomPlot() Q_DECL_OVERRIDE;
   
@@ -3815,6 +4298,12 @@ public:
   QCP::SelectionRectMode selectionRectMode() const { return mSelectionRectMode; }
   QCPSelectionRect *selectionRect() const { return mSelectionRect; }
   bool openGl() const { return mOpenGl; }
+  int frameInterval() const { return mFrameInterval; }
+  double frameTimeBudget() const { return mFrameTimeBudget; }
+  QualityLevel qualityLevel() const { return mQualityLevel; }
+  int graphLayerLimit() const { return mGraphLayerLimit; }
+  int vectorExportResolution() const { return mVectorExportResolution; }
+  QCPRenderProfiler *renderProfiler() const { return mRenderProfiler; }
   
   // setters:
   void setViewport(const QRect &rect);
@@ -3839,6 +4328,11 @@ public:
   void setSelectionRectMode(QCP::SelectionRectMode mode);
   void setSelectionRect(QCPSelectionRect *selectionRect);
   void setOpenGl(bool enabled, int multisampling=16);
+  void setFrameInterval(int msec);
+  void setFrameTimeBudget(double msec);
+  void setRenderProfiling(bool enabled);
+  void setGraphLayerLimit(int limit);
+  void setVectorExportResolution(int dpi);
   
   // non-property methods:
   // plottable interface:
@@ -3906,9 +4400,14 @@ public:
   bool saveBmp(const QString &fileName, int width=0, int height=0, double scale=1.0, int resolution=96, QCP::ResolutionUnit resolutionUnit=QCP::ruDotsPerInch);
   bool saveRastered(const QString &fileName, int width, int height, double scale, const char *format, int quality=-1, int resolution=96, QCP::ResolutionUnit resolutionUnit=QCP::ruDotsPerInch);
   QPixmap toPixmap(int width=0, int height=0, double scale=1.0);
+  QImage toImage(int width=0, int height=0, double scale=1.0);
   void toPainter(QCPPainter *painter, int width=0, int height=0);
   Q_SLOT void replot(QCustomPlot::RefreshPriority refreshPriority=QCustomPlot::rpRefreshHint);
   double replotTime(bool average=false) const;
+  void replotGraph(QCPGraph *graph);
+  int mergedReplotCount() const { return mMergedReplotCount; }
+  int droppedReplotCount() const { return mDroppedReplotCount; }
+  void resetReplotCounters();
   
   QCPAxis *xAxis, *yAxis, *xAxis2, *yAxis2;
   QCPLegend *legend;
@@ -3933,6 +4432,7 @@ signals:
   void beforeReplot();
   void afterLayout();
   void afterReplot();
+  void frameProfiled();
   
 protected:
   // property members:
@@ -3959,6 +4459,10 @@ protected:
   QCP::SelectionRectMode mSelectionRectMode;
   QCPSelectionRect *mSelectionRect;
   bool mOpenGl;
+  int mFrameInterval;
+  double mFrameTimeBudget;
+  int mGraphLayerLimit;
+  int mVectorExportResolution;
   
   // non-property members:
   QList<QSharedPointer<QCPAbstractPaintBuffer> > mPaintBuffers;
@@ -3971,6 +4475,17 @@ protected:
   bool mReplotting;
   bool mReplotQueued;
   double mReplotTime, mReplotTimeAverage;
+  QTimer *mFrameTimer;
+  QElapsedTimer mLastFrame;
+  int mMergedReplotCount, mDroppedReplotCount;
+  bool mFrameDroppedWhileHidden;
+  QList<QCPLayer*> mGraphLayers;
+  QCPRenderProfiler *mRenderProfiler;
+  double mVectorSampling; // samples per viewport pixel while drawing a vector export, 0 otherwise
+  QualityLevel mQualityLevel;
+  QTimer *mQualityTimer; // runs while replots follow each other closely, restores the full quality when it times out
+  double mInteractiveSampling; // samples per viewport pixel while the quality is reduced to qlThinned, 0 otherwise
+  int mFastFrameCount; // consecutive interactive replots well within the frame time budget
   int mOpenGlMultisamples;
   QCP::AntialiasedElements mOpenGlAntialiasedElementsBackup;
   bool mOpenGlCacheLabelsBackup;
@@ -3985,6 +4500,7 @@ protected:
   virtual QSize sizeHint() const Q_DECL_OVERRIDE;
   virtual void paintEvent(QPaintEvent *event) Q_DECL_OVERRIDE;
   virtual void resizeEvent(QResizeEvent *event) Q_DECL_OVERRIDE;
+  virtual void showEvent(QShowEvent *event) Q_DECL_OVERRIDE;
   virtual void mouseDoubleClickEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
   virtual void mousePressEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
   virtual void mouseMoveEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
@@ -3997,6 +4513,8 @@ protected:
   virtual void axisRemoved(QCPAxis *axis);
   virtual void legendRemoved(QCPLegend *legend);
   Q_SLOT virtual void processRectSelection(QRect rect, QMouseEvent *event);
+  Q_SLOT void processScheduledFrame();
+  Q_SLOT void restoreQuality();
   Q_SLOT virtual void processRectZoom(QRect rect, QMouseEvent *event);
   Q_SLOT virtual void processPointSelection(QMouseEvent *event);
   
@@ -4008,9 +4526,14 @@ protected:
   QCPLayerable *layerableAt(const QPointF &pos, bool onlySelectable, QVariant *selectionDetails=nullptr) const;
   QList<QCPLayerable*> layerableListAt(const QPointF &pos, bool onlySelectable, QList<QVariant> *selectionDetails=nullptr) const;
   void drawBackground(QCPPainter *painter);
+  void prepareGraphs();
   void setupPaintBuffers();
+  void updateGraphLayers();
+  bool replotLayers(const QList<QCPLayer*> &layers);
+  void drawLayerToPaintBuffer(QCPLayer *layer);
   QCPAbstractPaintBuffer *createPaintBuffer();
   bool hasInvalidatedPaintBuffers();
+  void updateQualityLevel();
   bool setupOpenGl();
   void freeOpenGl();
   
@@ -4020,10 +4543,12 @@ protected:
   friend class QCPAxisRect;
   friend class QCPAbstractPlottable;
   friend class QCPGraph;
+  friend class QCPCurve;
   friend class QCPAbstractItem;
 };
 Q_DECLARE_METATYPE(QCustomPlot::LayerInsertMode)
 Q_DECLARE_METATYPE(QCustomPlot::RefreshPriority)
+Q_DECLARE_METATYPE(QCustomPlot::QualityLevel)
 
 
 // implementation of template functions:
@@ -4651,7 +5176,10 @@ void QCPAbstractPlottable1D<DataType>::getDataSegments(QList<QCPDataRange> &sele
 
   Further it uses a faster line drawing technique based on \ref QCPPainter::drawLine rather than \c
   QPainter::drawPolyline if the configured \ref QCustomPlot::setPlottingHints() and \a painter
-  style allows.
+  style allows. With \ref QCP::phRasterLines, thin lines on images are drawn by \ref
+  QCPPainter::drawRasterPolyline. Dashed pens are split into solid dashes by \ref
+  QCPPainter::dashPolyline (except for vector exports), which is much faster than QPainter's dasher
+  on long polylines.
 */
 template <class DataType>
 void QCPAbstractPlottable1D<DataType>::drawPolyline(QCPPainter *painter, const QVector<QPointF> &lineData) const
@@ -4668,6 +5196,39 @@ void QCPAbstractPlottable1D<DataType>::drawPolyline(QCPPainter *painter, const Q
     painter->setPen(newPen);
   }
 
+  // dashed lines are split into solid dashes on the already reduced pixel polyline, with the dash phase continuing across
+  // vertices, so they cost about as much as solid lines:
+  if (painter->pen().style() != Qt::SolidLine && painter->pen().style() != Qt::NoPen &&
+      !painter->modes().testFlag(QCPPainter::pmVectorized))
+  {
+    const QPen dashedPen = painter->pen();
+    const double margin = qMax(1.0, dashedPen.widthF());
+    const QVector<QPointF> dashes = QCPPainter::dashPolyline(lineData, dashedPen, QRectF(clipRect()).adjusted(-margin, -margin, margin, margin));
+    QPen solidPen = dashedPen;
+    solidPen.setStyle(Qt::SolidLine);
+    painter->setPen(solidPen);
+    if (!solidPen.isCosmetic() || solidPen.widthF() > 1.0)
+      drawPolyline(painter, dashes);
+    else if (!(mParentPlot->plottingHints().testFlag(QCP::phRasterLines) && painter->drawRasterPolyline(dashes)))
+    {
+      // joins don't matter for thin dashes, so all of them are drawn in a single call:
+      QVector<QLineF> segments;
+      segments.reserve(dashes.size());
+      for (int i=1; i<dashes.size(); ++i)
+      {
+        if (!qIsNaN(dashes.at(i-1).x()) && !qIsNaN(dashes.at(i).x()))
+          segments.append(QLineF(dashes.at(i-1), dashes.at(i)));
+      }
+      painter->drawLines(segments);
+    }
+    painter->setPen(dashedPen);
+    return;
+  }
+
+  // thin solid lines on images are rasterized directly into the pixels, the painter declines every other case:
+  if (mParentPlot->plottingHints().testFlag(QCP::phRasterLines) && painter->drawRasterPolyline(lineData))
+    return;
+
   // if drawing solid line and not in PDF, use much faster line drawing instead of polyline:
   if (mParentPlot->plottingHints().testFlag(QCP::phFastPolylines) &&
       painter->pen().style() == Qt::SolidLine &&
@@ -4810,6 +5371,10 @@ protected:
   // non-virtual methods:
   bool stopsUseAlpha() const;
   void updateColorBuffer();
+  QRgb nanColorRgb() const;
+  int colorizeAvx2(const double *data, const QCPRange &range, QRgb *scanLine, int n, int dataIndexFactor, bool logarithmic) const;
+  
+  friend class QCPColorMap;
 };
 Q_DECLARE_METATYPE(QCPColorGradient::ColorInterpolation)
 Q_DECLARE_METATYPE(QCPColorGradient::NanHandling)
@@ -4987,6 +5552,8 @@ protected:
   QCP::AntialiasedElements mAADragBackup, mNotAADragBackup;
   bool mDragging;
   QHash<QCPAxis::AxisType, QList<QCPAxis*> > mAxes;
+  double mPendingWheelSteps;
+  QPointF mPendingWheelPos;
   
   // reimplemented virtual methods:
   virtual void applyDefaultAntialiasingHint(QCPPainter *painter) const Q_DECL_OVERRIDE;
@@ -5002,6 +5569,8 @@ protected:
   // non-property methods:
   void drawBackground(QCPPainter *painter);
   void updateAxesOffset(QCPAxis::AxisType type);
+  void zoomByWheelSteps(double wheelSteps, const QPointF &pos);
+  void applyPendingWheelZoom();
   
 private:
   Q_DISABLE_COPY(QCPAxisRect)
@@ -5469,6 +6038,9 @@ class QCP_LIB_DECL QCPGraph : public QCPAbstractPlottable1D<QCPGraphData>
   Q_PROPERTY(int scatterSkip READ scatterSkip WRITE setScatterSkip)
   Q_PROPERTY(QCPGraph* channelFillGraph READ channelFillGraph WRITE setChannelFillGraph)
   Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
+  Q_PROPERTY(bool densityScatter READ densityScatter WRITE setDensityScatter)
+  Q_PROPERTY(QCPColorGradient densityGradient READ densityGradient WRITE setDensityGradient)
+  Q_PROPERTY(int densitySpriteLimit READ densitySpriteLimit WRITE setDensitySpriteLimit)
   /// \endcond
 public:
   /*!
@@ -5496,6 +6068,9 @@ public:
   int scatterSkip() const { return mScatterSkip; }
   QCPGraph *channelFillGraph() const { return mChannelFillGraph.data(); }
   bool adaptiveSampling() const { return mAdaptiveSampling; }
+  bool densityScatter() const { return mDensityScatter; }
+  QCPColorGradient densityGradient() const { return mDensityGradient; }
+  int densitySpriteLimit() const { return mDensitySpriteLimit; }
   
   // setters:
   void setData(QSharedPointer<QCPGraphDataContainer> data);
@@ -5506,6 +6081,9 @@ public:
   void setScatterSkip(int skip);
   void setChannelFillGraph(QCPGraph *targetGraph);
   void setAdaptiveSampling(bool enabled);
+  void setDensityScatter(bool enabled);
+  void setDensityGradient(const QCPColorGradient &gradient);
+  void setDensitySpriteLimit(int pixels);
   
   // non-property methods:
   void addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
@@ -5514,16 +6092,34 @@ public:
   
   // reimplemented virtual methods:
   virtual double selectTest(const QPointF &pos, bool onlySelectable, QVariant *details=nullptr) const Q_DECL_OVERRIDE;
+  virtual QCPDataSelection selectTestRect(const QRectF &rect, bool onlySelectable) const Q_DECL_OVERRIDE;
   virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
   virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
   
 protected:
+  enum LineVertexOutcode { ocLeft=0x01, ocRight=0x02, ocTop=0x04, ocBottom=0x08, ocNaN=0x10 }; // position of a line vertex relative to the clip rect, see simplifyLines
+  
   // property members:
   LineStyle mLineStyle;
   QCPScatterStyle mScatterStyle;
   int mScatterSkip;
   QPointer<QCPGraph> mChannelFillGraph;
   bool mAdaptiveSampling;
+  bool mDensityScatter;
+  QCPColorGradient mDensityGradient;
+  int mDensitySpriteLimit;
+  
+  // non-property members:
+  bool mPrepared;
+  bool mPrepareUnselectedScatters, mPrepareSelectedScatters;
+  int mLayerReplotCount;
+  QVector<QVector<QPointF> > mPreparedLines, mPreparedScatters;
+  mutable QCPPixelGrid mHitTestGrid;
+  mutable QVector<double> mHitTestSignature; // axis ranges, scale types, line style and data revision the hit test grid was built for
+  QPainterPath mWideLineOutline;
+  QVector<double> mWideLineSignature; // axis range sizes, axis rect size, line style, pen and data revision the outline was built for
+  QCPRange mWideLineKeyRange, mWideLineValueRange; // ranges covered by the outline
+  QPointF mWideLineOrigin; // pixel position of the lower corner of the covered ranges when the outline was built
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
@@ -5534,6 +6130,7 @@ protected:
   virtual void drawScatterPlot(QCPPainter *painter, const QVector<QPointF> &scatters, const QCPScatterStyle &style) const;
   virtual void drawLinePlot(QCPPainter *painter, const QVector<QPointF> &lines) const;
   virtual void drawImpulsePlot(QCPPainter *painter, const QVector<QPointF> &lines) const;
+  virtual void drawDensityScatterPlot(QCPPainter *painter, const QCPDataRange &dataRange, const QCPScatterStyle &style) const;
   
   virtual void getOptimizedLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end) const;
   virtual void getOptimizedScatterData(QVector<QCPGraphData> *scatterData, QCPGraphDataContainer::const_iterator begin, QCPGraphDataContainer::const_iterator end) const;
@@ -5542,11 +6139,18 @@ protected:
   void getVisibleDataBounds(QCPGraphDataContainer::const_iterator &begin, QCPGraphDataContainer::const_iterator &end, const QCPDataRange &rangeRestriction) const;
   void getLines(QVector<QPointF> *lines, const QCPDataRange &dataRange) const;
   void getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataRange) const;
+  void getDecimatedLineData(QVector<QCPGraphData> *lineData, const QCPGraphDataContainer::const_iterator &begin, const QCPGraphDataContainer::const_iterator &end, double samplesPerPixel) const;
+  void decimateScatters(QVector<QPointF> *scatters, double samplesPerPixel) const;
+  void getScatterDensity(QVector<quint32> *density, const QCPDataRange &dataRange, int keySize, int valueSize) const;
   QVector<QPointF> dataToLines(const QVector<QCPGraphData> &data) const;
   QVector<QPointF> dataToStepLeftLines(const QVector<QCPGraphData> &data) const;
   QVector<QPointF> dataToStepRightLines(const QVector<QCPGraphData> &data) const;
   QVector<QPointF> dataToStepCenterLines(const QVector<QCPGraphData> &data) const;
   QVector<QPointF> dataToImpulseLines(const QVector<QCPGraphData> &data) const;
+  void simplifyLines(QVector<QPointF> *lines, double penWidth, const QRectF &area=QRectF()) const;
+  bool drawCachedWideLine(QCPPainter *painter);
+  static void classifyLineVertices(const QPointF *points, int count, const QRectF &clipRect, bool keyIsX, int *columns, int *outcodes);
+  static int classifyLineVerticesAvx2(const QPointF *points, int count, const QRectF &clipRect, bool keyIsX, int *columns, int *outcodes);
   QVector<QCPDataRange> getNonNanSegments(const QVector<QPointF> *lineData, Qt::Orientation keyOrientation) const;
   QVector<QPair<QCPDataRange, QCPDataRange> > getOverlappingSegments(QVector<QCPDataRange> thisSegments, const QVector<QPointF> *thisData, QVector<QCPDataRange> otherSegments, const QVector<QPointF> *otherData) const;
   bool segmentsIntersect(double aLower, double aUpper, double bLower, double bUpper, int &bPrecedence) const;
@@ -5558,6 +6162,11 @@ protected:
   int findIndexBelowY(const QVector<QPointF> *data, double y) const;
   int findIndexAboveY(const QVector<QPointF> *data, double y) const;
   double pointDistance(const QPointF &pixelPoint, QCPGraphDataContainer::const_iterator &closestData) const;
+  QCPGraphDataContainer::const_iterator nearestKeyWindowPoint(const QPointF &pixelPoint, double &minDistSqr) const;
+  bool updateHitTestGrid() const;
+  bool initPreparedDraw();
+  void prepareDraw();
+  void discardPreparedDraw();
   
   friend class QCustomPlot;
   friend class QCPLegend;
@@ -5609,6 +6218,7 @@ class QCP_LIB_DECL QCPCurve : public QCPAbstractPlottable1D<QCPCurveData>
   Q_PROPERTY(QCPScatterStyle scatterStyle READ scatterStyle WRITE setScatterStyle)
   Q_PROPERTY(int scatterSkip READ scatterSkip WRITE setScatterSkip)
   Q_PROPERTY(LineStyle lineStyle READ lineStyle WRITE setLineStyle)
+  Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
   /// \endcond
 public:
   /*!
@@ -5629,6 +6239,7 @@ public:
   QCPScatterStyle scatterStyle() const { return mScatterStyle; }
   int scatterSkip() const { return mScatterSkip; }
   LineStyle lineStyle() const { return mLineStyle; }
+  bool adaptiveSampling() const { return mAdaptiveSampling; }
   
   // setters:
   void setData(QSharedPointer<QCPCurveDataContainer> data);
@@ -5637,6 +6248,7 @@ public:
   void setScatterStyle(const QCPScatterStyle &style);
   void setScatterSkip(int skip);
   void setLineStyle(LineStyle style);
+  void setAdaptiveSampling(bool enabled);
   
   // non-property methods:
   void addData(const QVector<double> &t, const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
@@ -5654,6 +6266,7 @@ protected:
   QCPScatterStyle mScatterStyle;
   int mScatterSkip;
   LineStyle mLineStyle;
+  bool mAdaptiveSampling;
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
@@ -5666,6 +6279,7 @@ protected:
   // non-virtual methods:
   void getCurveLines(QVector<QPointF> *lines, const QCPDataRange &dataRange, double penWidth) const;
   void getScatters(QVector<QPointF> *scatters, const QCPDataRange &dataRange, double scatterWidth) const;
+  void mergePixelRuns(QVector<QPointF> *points, bool keepLast) const;
   int getRegion(double key, double value, double keyMin, double valueMax, double keyMax, double valueMin) const;
   QPointF getOptimizedPoint(int otherRegion, double otherKey, double otherValue, double key, double value, double keyMin, double valueMax, double keyMax, double valueMin) const;
   QVector<QPointF> getOptimizedCornerPoints(int prevRegion, int currentRegion, double prevKey, double prevValue, double key, double value, double keyMin, double valueMax, double keyMax, double valueMin) const;
@@ -5923,6 +6537,7 @@ class QCP_LIB_DECL QCPStatisticalBox : public QCPAbstractPlottable1D<QCPStatisti
   Q_PROPERTY(bool whiskerAntialiased READ whiskerAntialiased WRITE setWhiskerAntialiased)
   Q_PROPERTY(QPen medianPen READ medianPen WRITE setMedianPen)
   Q_PROPERTY(QCPScatterStyle outlierStyle READ outlierStyle WRITE setOutlierStyle)
+  Q_PROPERTY(int binCount READ binCount WRITE setBinCount)
   /// \endcond
 public:
   explicit QCPStatisticalBox(QCPAxis *keyAxis, QCPAxis *valueAxis);
@@ -5936,6 +6551,8 @@ public:
   bool whiskerAntialiased() const { return mWhiskerAntialiased; }
   QPen medianPen() const { return mMedianPen; }
   QCPScatterStyle outlierStyle() const { return mOutlierStyle; }
+  QSharedPointer<QCPGraphDataContainer> sourceData() const { return mSourceData; }
+  int binCount() const { return mBinCount; }
 
   // setters:
   void setData(QSharedPointer<QCPStatisticalBoxDataContainer> data);
@@ -5947,10 +6564,15 @@ public:
   void setWhiskerAntialiased(bool enabled);
   void setMedianPen(const QPen &pen);
   void setOutlierStyle(const QCPScatterStyle &style);
+  void setSourceData(QSharedPointer<QCPGraphDataContainer> data);
+  void setSourceData(DataSet *dataSet);
+  void setBinCount(int count);
   
   // non-property methods:
   void addData(const QVector<double> &keys, const QVector<double> &minimum, const QVector<double> &lowerQuartile, const QVector<double> &median, const QVector<double> &upperQuartile, const QVector<double> &maximum, bool alreadySorted=false);
   void addData(double key, double minimum, double lowerQuartile, double median, double upperQuartile, double maximum, const QVector<double> &outliers=QVector<double>());
+  void addData(double key, DataSet *dataSet);
+  void rebin();
   
   // reimplemented virtual methods:
   virtual QCPDataSelection selectTestRect(const QRectF &rect, bool onlySelectable) const Q_DECL_OVERRIDE;
@@ -5958,6 +6580,9 @@ public:
   virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
   virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
   
+  // static methods:
+  static QCPStatisticalBoxData boxStatistics(double key, QVector<double> samples);
+  
 protected:
   // property members:
   double mWidth;
@@ -5966,6 +6591,12 @@ protected:
   bool mWhiskerAntialiased;
   QPen mMedianPen;
   QCPScatterStyle mOutlierStyle;
+  QSharedPointer<QCPGraphDataContainer> mSourceData;
+  int mBinCount;
+  
+  // non-property members:
+  QCPRange mBinnedKeyRange;
+  double mBinWidth;
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
@@ -5975,6 +6606,8 @@ protected:
   virtual void drawStatisticalBox(QCPPainter *painter, QCPStatisticalBoxDataContainer::const_iterator it, const QCPScatterStyle &outlierStyle) const;
   
   // non-virtual methods:
+  void updateBins();
+  double widthScale() const;
   void getVisibleDataBounds(QCPStatisticalBoxDataContainer::const_iterator &begin, QCPStatisticalBoxDataContainer::const_iterator &end) const;
   QRectF getQuartileBox(QCPStatisticalBoxDataContainer::const_iterator it) const;
   QVector<QLineF> getWhiskerBackboneLines(QCPStatisticalBoxDataContainer::const_iterator it) const;
@@ -6029,6 +6662,9 @@ public:
   void coordToCell(double key, double value, int *keyIndex, int *valueIndex) const;
   void cellToCoord(int keyIndex, int valueIndex, double *key, double *value) const;
   
+  // constants:
+  static const int tileSize = 256; ///< edge length in cells of the tiles in which modifications are tracked, see QCPColorMap::updateMapImage
+  
 protected:
   // property members:
   int mKeySize, mValueSize;
@@ -6040,8 +6676,14 @@ protected:
   unsigned char *mAlpha;
   QCPRange mDataBounds;
   bool mDataModified;
+  QBitArray mModifiedTiles; // tiles with cells modified since the map image was updated, row by row of tiles. Empty if the whole map is modified
+  QVector<double> mRowLower, mRowUpper; // minimum and maximum of each row of cells with equal value index, NaN cells are ignored
+  QBitArray mStaleRows; // rows whose minimum or maximum cell was overwritten, their bounds are recalculated by recalculateDataBounds
   
   bool createAlpha(bool initializeOpaque=true);
+  void markCellModified(int keyIndex, int valueIndex);
+  void writeCell(int keyIndex, int valueIndex, double z);
+  void recalculateRowBounds(int valueIndex);
   
   friend class QCPColorMap;
 };
@@ -6120,6 +6762,72 @@ protected:
   friend class QCPLegend;
 };
 
+
+class QCP_LIB_DECL QCPAggregateMap : public QCPColorMap
+{
+  Q_OBJECT
+  /// \cond INCLUDE_QPROPERTIES
+  Q_PROPERTY(Aggregation aggregation READ aggregation WRITE setAggregation)
+  /// \endcond
+public:
+  /*!
+    Defines how the data points falling into one cell of the aggregate grid are combined into the
+    cell's value.
+    
+    \see setAggregation
+  */
+  enum Aggregation { agCount      ///< the number of data points in the cell
+                     ,agMeanValue ///< the mean of the values of the data points in the cell
+                     ,agMaxValue  ///< the maximum of the values of the data points in the cell
+                   };
+  Q_ENUMS(Aggregation)
+  
+  explicit QCPAggregateMap(QCPAxis *keyAxis, QCPAxis *valueAxis);
+  virtual ~QCPAggregateMap() Q_DECL_OVERRIDE;
+  
+  // getters:
+  QSharedPointer<QCPGraphDataContainer> sourceData() const { return mSourceData; }
+  Aggregation aggregation() const { return mAggregation; }
+  bool isAggregating() const { return mAggregating; }
+  
+  // setters:
+  void setSourceData(QSharedPointer<QCPGraphDataContainer> data);
+  void setSourceData(DataSet *dataSet);
+  void setAggregation(Aggregation aggregation);
+  
+  // non-property methods:
+  Q_SLOT void reaggregate();
+  
+  // reimplemented virtual methods:
+  virtual QCPRange getKeyRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth) const Q_DECL_OVERRIDE;
+  virtual QCPRange getValueRange(bool &foundRange, QCP::SignDomain inSignDomain=QCP::sdBoth, const QCPRange &inKeyRange=QCPRange()) const Q_DECL_OVERRIDE;
+  
+signals:
+  void aggregated();
+  
+protected:
+  // property members:
+  QSharedPointer<QCPGraphDataContainer> mSourceData;
+  Aggregation mAggregation;
+  
+  // non-property members:
+  QFutureWatcher<QCPColorMapData*> mAggregationWatcher;
+  bool mAggregating, mReaggregatePending;
+  QCPRange mGridKeyRange, mGridValueRange;
+  int mGridKeySize, mGridValueSize;
+  
+  // reimplemented virtual methods:
+  virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
+  
+  // non-virtual methods:
+  bool gridMatchesAxes() const;
+  static QCPColorMapData *aggregate(QSharedPointer<QCPGraphDataContainer> data, Aggregation aggregation, QCPRange keyRange, QCPRange valueRange, int keySize, int valueSize);
+  
+protected slots:
+  void aggregationFinished();
+};
+Q_DECLARE_METATYPE(QCPAggregateMap::Aggregation)
+
 /* end of 'src/plottables/plottable-colormap.h' */
 
 
@@ -6206,6 +6914,8 @@ public:
   QBrush brushNegative() const { return mBrushNegative; }
   QPen penPositive() const { return mPenPositive; }
   QPen penNegative() const { return mPenNegative; }
+  QSharedPointer<QCPGraphDataContainer> sourceData() const { return mSourceData; }
+  double bucketSize() const;
   
   // setters:
   void setData(QSharedPointer<QCPFinancialDataContainer> data);
@@ -6218,10 +6928,13 @@ public:
   void setBrushNegative(const QBrush &brush);
   void setPenPositive(const QPen &pen);
   void setPenNegative(const QPen &pen);
+  void setSourceData(QSharedPointer<QCPGraphDataContainer> data);
+  void setSourceData(DataSet *dataSet);
   
   // non-property methods:
   void addData(const QVector<double> &keys, const QVector<double> &open, const QVector<double> &high, const QVector<double> &low, const QVector<double> &close, bool alreadySorted=false);
   void addData(double key, double open, double high, double low, double close);
+  void rebuildLevels();
   
   // reimplemented virtual methods:
   virtual QCPDataSelection selectTestRect(const QRectF &rect, bool onlySelectable) const Q_DECL_OVERRIDE;
@@ -6240,12 +6953,20 @@ protected:
   bool mTwoColored;
   QBrush mBrushPositive, mBrushNegative;
   QPen mPenPositive, mPenNegative;
+  QSharedPointer<QCPGraphDataContainer> mSourceData;
+  
+  // non-property members:
+  QVector<QSharedPointer<QCPFinancialDataContainer> > mLevels;
+  double mBaseBucketSize, mBucketOffset;
+  int mLevel;
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
   virtual void drawLegendIcon(QCPPainter *painter, const QRectF &rect) const Q_DECL_OVERRIDE;
   
   // non-virtual methods:
+  void selectLevel();
+  double keyWidth() const;
   void drawOhlcPlot(QCPPainter *painter, const QCPFinancialDataContainer::const_iterator &begin, const QCPFinancialDataContainer::const_iterator &end, bool isSelected);
   void drawCandlestickPlot(QCPPainter *painter, const QCPFinancialDataContainer::const_iterator &begin, const QCPFinancialDataContainer::const_iterator &end, bool isSelected);
   double getPixelWidth(double key, double keyPixel) const;
@@ -6303,6 +7024,7 @@ class QCP_LIB_DECL QCPErrorBars : public QCPAbstractPlottable, public QCPPlottab
   Q_PROPERTY(ErrorType errorType READ errorType WRITE setErrorType)
   Q_PROPERTY(double whiskerWidth READ whiskerWidth WRITE setWhiskerWidth)
   Q_PROPERTY(double symbolGap READ symbolGap WRITE setSymbolGap)
+  Q_PROPERTY(bool adaptiveSampling READ adaptiveSampling WRITE setAdaptiveSampling)
   /// \endcond
 public:
   
@@ -6325,6 +7047,7 @@ public:
   ErrorType errorType() const { return mErrorType; }
   double whiskerWidth() const { return mWhiskerWidth; }
   double symbolGap() const { return mSymbolGap; }
+  bool adaptiveSampling() const { return mAdaptiveSampling; }
   
   // setters:
   void setData(QSharedPointer<QCPErrorBarsDataContainer> data);
@@ -6334,6 +7057,7 @@ public:
   void setErrorType(ErrorType type);
   void setWhiskerWidth(double pixels);
   void setSymbolGap(double pixels);
+  void setAdaptiveSampling(bool enabled);
   
   // non-property methods:
   void addData(const QVector<double> &error);
@@ -6364,6 +7088,7 @@ protected:
   ErrorType mErrorType;
   double mWhiskerWidth;
   double mSymbolGap;
+  bool mAdaptiveSampling;
   
   // reimplemented virtual methods:
   virtual void draw(QCPPainter *painter) Q_DECL_OVERRIDE;
@@ -6373,6 +7098,7 @@ protected:
   
   // non-virtual methods:
   void getErrorBarLines(QCPErrorBarsDataContainer::const_iterator it, QVector<QLineF> &backbones, QVector<QLineF> &whiskers) const;
+  void getErrorBarEnvelope(QCPErrorBarsDataContainer::const_iterator begin, QCPErrorBarsDataContainer::const_iterator end, bool checkPointVisibility, QVector<QLineF> &envelope) const;
   void getVisibleDataBounds(QCPErrorBarsDataContainer::const_iterator &begin, QCPErrorBarsDataContainer::const_iterator &end, const QCPDataRange &rangeRestriction) const;
   double pointDistance(const QPointF &pixelPoint, QCPErrorBarsDataContainer::const_iterator &closestData) const;
   // helpers:
@@ -7641,6 +8367,7 @@ public:
   QSharedPointer<QCPGraphDataContainer> data() const { return mDataContainer; }
   LineStyle lineStyle() const { return mLineStyle; }
   QCPScatterStyle scatterStyle() const { return mScatterStyle; }
+  bool adaptiveSampling() const { return mAdaptiveSampling; }
   
   // setters:
   void setName(const QString &name);
@@ -7658,6 +8385,7 @@ public:
   void setData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
   void setLineStyle(LineStyle ls);
   void setScatterStyle(const QCPScatterStyle &style);
+  void setAdaptiveSampling(bool enabled);
 
   // non-property methods:
   void addData(const QVector<double> &keys, const QVector<double> &values, bool alreadySorted=false);
@@ -7699,6 +8427,7 @@ protected:
   QPointer<QCPPolarAxisRadial> mValueAxis;
   QCP::SelectionType mSelectable;
   QCPDataSelection mSelection;
+  bool mAdaptiveSampling;
   //QCPSelectionDecorator *mSelectionDecorator;
   
   // introduced virtual methods (later reimplemented TODO from QCPAbstractPolarPlottable):
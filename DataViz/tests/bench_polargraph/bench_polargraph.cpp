@@ -0,0 +1,68 @@
+#include <QtTest/QtTest>
+#include "qcustomplot.h"
+
+/********************************
+ *
+ *  Replot benchmark of QCPPolarGraph with and without adaptive sampling, i.e. the angular-bucket
+ *  min/max decimation against the previous path that converts and draws every visible point.
+ *
+ *  The graph is a dense angular sweep over one turn, like an antenna pattern or the vibration of a
+ *  rotating machine, drawn as a line into a 600 x 600 plot. Run with "-tickcounter" or
+ *  "-eventcounter" for other measures than the wall time per replot.
+ *
+ **********************************/
+
+class BenchPolarGraph : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void replot_data();
+  void replot();
+};
+
+void BenchPolarGraph::replot_data()
+{
+  QTest::addColumn<int>("pointCount");
+  QTest::addColumn<bool>("adaptiveSampling");
+  QTest::newRow("1M, previous path") << 1000000 << false;
+  QTest::newRow("1M, adaptive sampling") << 1000000 << true;
+  QTest::newRow("10M, previous path") << 10000000 << false;
+  QTest::newRow("10M, adaptive sampling") << 10000000 << true;
+}
+
+void BenchPolarGraph::replot()
+{
+  QFETCH(int, pointCount);
+  QFETCH(bool, adaptiveSampling);
+
+  QCustomPlot plot;
+  plot.resize(600, 600);
+  plot.plotLayout()->clear();
+  QCPPolarAxisAngular *angularAxis = new QCPPolarAxisAngular(&plot);
+  plot.plotLayout()->addElement(0, 0, angularAxis);
+  angularAxis->setRange(0, 360);
+  angularAxis->radialAxis()->setRange(0, 2);
+
+  // a lobed pattern with high frequency ripple and noise, so every angular bucket has a radial spread:
+  QVector<double> keys(pointCount), values(pointCount);
+  std::srand(1);
+  for (int i=0; i<pointCount; ++i)
+  {
+    keys[i] = 360.0*i/pointCount;
+    const double angle = qDegreesToRadians(keys[i]);
+    values[i] = 1+0.5*qAbs(qCos(3*angle))+0.1*qSin(2000*angle)+0.05*(std::rand()/double(RAND_MAX)-0.5);
+  }
+  QCPPolarGraph *graph = new QCPPolarGraph(angularAxis, angularAxis->radialAxis());
+  graph->setData(keys, values, true);
+  graph->setAdaptiveSampling(adaptiveSampling);
+  plot.replot(); // lays out the axes, so the benchmark only measures the drawing
+
+  QBENCHMARK
+  {
+    plot.replot();
+  }
+}
+
+QTEST_MAIN(BenchPolarGraph)
+#include "bench_polargraph.moc"
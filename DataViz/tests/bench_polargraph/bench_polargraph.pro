@@ -0,0 +1,20 @@
+QT       += core gui widgets printsupport concurrent testlib
+
+CONFIG += c++11 release # Timings of a debug build say little about the drawing code
+CONFIG += testcase # "make check" runs the benchmark, also on machines without a display via QT_QPA_PLATFORM=offscreen
+CONFIG -= app_bundle
+
+TARGET = bench_polargraph
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    bench_polargraph.cpp \
+    ../../qcustomplot.cpp \
+    ../../dataset.cpp
+
+HEADERS += \
+    ../../qcustomplot.h \
+    ../../dataset.h
+
+include(../../gsl.pri) # qcustomplot.h includes dataset.h, and the plottables read DataSets
@@ -0,0 +1,7 @@
+# Tests and benchmarks of the QCustomPlot changes, each built against ../qcustomplot.cpp.
+# Build and run all of them with: qmake tests.pro && make && make check
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    tst_qcustomplot \
+    bench_polargraph
@@ -0,0 +1,142 @@
+#include <QtTest/QtTest>
+#include "qcustomplot.h"
+
+/********************************
+ *
+ *  Regression tests for the QCustomPlot changes of DataViz: caches that plottables derive from
+ *  their data containers, and the results they are used for.
+ *
+ **********************************/
+
+class TestQCustomPlot : public QObject
+{
+  Q_OBJECT
+
+private slots:
+  void init();
+  void cleanup();
+
+  void graphSelectTestAfterRemoveBefore();
+  void graphSelectTestRectAfterRemoveBefore();
+  void graphSelectTestAfterCapacityDrop();
+  void graphSelectTestOnLineBetweenPoints();
+
+private:
+  void buildLargeGraph();
+  void checkClosestPoint(const QPointF &pixel);
+
+  QCustomPlot *mPlot;
+  QCPGraph *mGraph;
+};
+
+void TestQCustomPlot::init()
+{
+  mPlot = new QCustomPlot;
+  mPlot->resize(400, 300);
+  mGraph = mPlot->addGraph();
+}
+
+void TestQCustomPlot::cleanup()
+{
+  delete mPlot;
+}
+
+/* Fills the graph with enough points that hit tests use the pixel grid index, shows all of them and
+   builds the grid with a first hit test, so later tests see whether the grid is rebuilt. */
+void TestQCustomPlot::buildLargeGraph()
+{
+  QVector<double> keys, values;
+  for (int i=0; i<100000; ++i)
+  {
+    keys << i;
+    values << i%1000;
+  }
+  mGraph->setData(keys, values, true);
+  mGraph->setLineStyle(QCPGraph::lsNone);
+  mGraph->setScatterStyle(QCPScatterStyle(QCPScatterStyle::ssDisc, 3));
+  mPlot->xAxis->setRange(0, 100000);
+  mPlot->yAxis->setRange(0, 1000);
+  mPlot->replot(); // lays out the axis rect
+  mGraph->selectTest(QPointF(mPlot->xAxis->coordToPixel(10000), mPlot->yAxis->coordToPixel(0)), false);
+}
+
+/* Checks that the point reported by selectTest at \a pixel exists in the current data and lies
+   within the selection tolerance of \a pixel. */
+void TestQCustomPlot::checkClosestPoint(const QPointF &pixel)
+{
+  QVariant details;
+  const double distance = mGraph->selectTest(pixel, false, &details);
+  QVERIFY(distance >= 0);
+  QVERIFY(distance <= mPlot->selectionTolerance());
+  const QCPDataSelection selection = details.value<QCPDataSelection>();
+  QCOMPARE(selection.dataRangeCount(), 1);
+  const int index = selection.dataRange().begin();
+  QVERIFY(index >= 0);
+  QVERIFY(index < mGraph->data()->size());
+  const QPointF pointPixel = mGraph->coordsToPixels(mGraph->data()->at(index)->key, mGraph->data()->at(index)->value);
+  QVERIFY(QCPVector2D(pointPixel-pixel).length() <= mPlot->selectionTolerance());
+}
+
+void TestQCustomPlot::graphSelectTestAfterRemoveBefore()
+{
+  buildLargeGraph();
+  const quint64 revision = mGraph->data()->revision();
+  mGraph->data()->removeBefore(49999.5); // only moves begin() of the container
+  QVERIFY(mGraph->data()->revision() != revision);
+  QCOMPARE(mGraph->data()->size(), 50000);
+  checkClosestPoint(QPointF(mPlot->xAxis->coordToPixel(75000), mPlot->yAxis->coordToPixel(0)));
+  checkClosestPoint(QPointF(mPlot->xAxis->coordToPixel(99999), mPlot->yAxis->coordToPixel(999)));
+  // where the removed points were, nothing may be found:
+  QVERIFY(mGraph->selectTest(QPointF(mPlot->xAxis->coordToPixel(20000), mPlot->yAxis->coordToPixel(500)), false) > mPlot->selectionTolerance());
+}
+
+void TestQCustomPlot::graphSelectTestRectAfterRemoveBefore()
+{
+  buildLargeGraph();
+  mGraph->data()->removeBefore(49999.5);
+  const QRectF rect(QPointF(mPlot->xAxis->coordToPixel(40000), mPlot->yAxis->coordToPixel(1000)),
+                    QPointF(mPlot->xAxis->coordToPixel(60000), mPlot->yAxis->coordToPixel(0)));
+  const QCPDataSelection selection = mGraph->selectTestRect(rect, false);
+  QVERIFY(!selection.isEmpty());
+  QCOMPARE(selection.span().begin(), 0); // the first remaining point has key 50000
+  QVERIFY(selection.span().end() <= mGraph->data()->size());
+  const double lastKey = mGraph->data()->at(selection.span().end()-1)->key;
+  QVERIFY(qAbs(mPlot->xAxis->coordToPixel(lastKey)-mPlot->xAxis->coordToPixel(60000)) <= 2);
+}
+
+void TestQCustomPlot::graphSelectTestAfterCapacityDrop()
+{
+  buildLargeGraph();
+  const quint64 revision = mGraph->data()->revision();
+  mGraph->data()->setCapacity(60000); // drops the oldest points like removeBefore
+  QVERIFY(mGraph->data()->revision() != revision);
+  QCOMPARE(mGraph->data()->size(), 60000);
+  checkClosestPoint(QPointF(mPlot->xAxis->coordToPixel(90000), mPlot->yAxis->coordToPixel(0)));
+}
+
+void TestQCustomPlot::graphSelectTestOnLineBetweenPoints()
+{
+  buildLargeGraph();
+  mGraph->setLineStyle(QCPGraph::lsLine);
+  mGraph->setScatterStyle(QCPScatterStyle());
+  // zoom in so neighbouring points are much further apart than the selection tolerance:
+  mPlot->xAxis->setRange(1000, 1010);
+  mPlot->yAxis->setRange(0, 10);
+  mPlot->replot();
+  QVERIFY(mPlot->xAxis->coordToPixel(1001)-mPlot->xAxis->coordToPixel(1000) > 3*mPlot->selectionTolerance());
+  
+  // click on the line halfway between the points with keys 1004 and 1005:
+  QVariant details;
+  const double distance = mGraph->selectTest(QPointF(mPlot->xAxis->coordToPixel(1004.5), mPlot->yAxis->coordToPixel(4.5)), false, &details);
+  QVERIFY(distance >= 0);
+  QVERIFY(distance <= 1);
+  const QCPDataSelection selection = details.value<QCPDataSelection>();
+  QCOMPARE(selection.dataRangeCount(), 1);
+  const int index = selection.dataRange().begin();
+  QVERIFY(index >= 0);
+  QVERIFY(index < mGraph->data()->size());
+  QVERIFY(index == 1004 || index == 1005);
+}
+
+QTEST_MAIN(TestQCustomPlot)
+#include "tst_qcustomplot.moc"
@@ -0,0 +1,19 @@
+QT       += core gui widgets printsupport concurrent testlib
+
+CONFIG += c++11 testcase # "make check" runs the tests, also on machines without a display via QT_QPA_PLATFORM=offscreen
+CONFIG -= app_bundle
+
+TARGET = tst_qcustomplot
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_qcustomplot.cpp \
+    ../../qcustomplot.cpp \
+    ../../dataset.cpp
+
+HEADERS += \
+    ../../qcustomplot.h \
+    ../../dataset.h
+
+include(../../gsl.pri) # qcustomplot.h includes dataset.h, and the plottables read DataSets